@@ -0,0 +1,51 @@
+project "Bench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    staticruntime "off"
+
+    targetdir ("%{wks.location}/build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir    ("%{wks.location}/build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+    files {
+        "src/public/**.h",
+        "src/private/**.cpp",
+
+        -- TGPanel's model code, without the panel itself
+        "%{wks.location}/Runtime/src/public/Panels/TGModel.h",
+        "%{wks.location}/Runtime/src/private/Panels/TGModel.cpp",
+        "%{wks.location}/Runtime/src/public/Panels/AccountRegistry.h",
+        "%{wks.location}/Runtime/src/private/Panels/AccountRegistry.cpp"
+    }
+
+    includedirs {
+        "src/public/",
+        "src/private/",
+        "%{wks.location}/Core/src/public",
+        "%{wks.location}/Runtime/src/public"
+    }
+
+    links { "Core" }
+    dependson { "Core" }
+
+    IncludeDependencies()
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "system:linux"
+        -- Core's window and GL code still has to link, even though Bench never opens a window
+        links { "glfw", "GL", "pthread", "dl" }
+
+    filter "configurations:Debug"
+        defines { "_DEBUG" }
+        runtime "Debug"
+        symbols "On"
+        ProcessDependencies("Debug")
+
+    filter "configurations:Release"
+        defines { "_RELEASE" }
+        runtime "Release"
+        optimize "Full"
+        symbols "Off"
+        ProcessDependencies("Release")
@@ -0,0 +1,73 @@
+﻿#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "Debug/Profiler.h"
+
+namespace tg::bench
+{
+    namespace
+    {
+        // Calibration stops growing the loop once a run takes this share of the minimum time.
+        constexpr double kCalibratedShare = 0.2;
+        constexpr uint64_t kMaxIterations = uint64_t{1} << 40;
+
+        uint64_t TimeLoop(void (*loop)(void*, uint64_t), void* context, uint64_t iterations)
+        {
+            const uint64_t start = Profiler::NowNs();
+            loop(context, iterations);
+            return Profiler::NowNs() - start;
+        }
+    }
+
+    Context::Context(std::string name, size_t size, uint64_t minTimeNs, int samples)
+        : mSize(size), mMinTimeNs(minTimeNs), mSamples(std::max(samples, 1))
+    {
+        mResult.name = std::move(name);
+        mResult.size = size;
+    }
+
+    void Context::Measure(void (*loop)(void*, uint64_t), void* context, size_t items)
+    {
+        // Untimed first call: lazily built state (thread rings, glyph caches) is not the work.
+        loop(context, 1);
+
+        // Calibration doubles as the warm-up for caches and branch predictors.
+        const uint64_t maxIterations = std::min(kMaxIterations, mMaxIterations);
+        const uint64_t sampleTimeNs = std::max<uint64_t>(mMinTimeNs / static_cast<uint64_t>(mSamples), 1);
+        uint64_t iterations = 1;
+        uint64_t elapsed = TimeLoop(loop, context, iterations);
+        while (elapsed < static_cast<uint64_t>(kCalibratedShare * static_cast<double>(sampleTimeNs)) && iterations < maxIterations)
+        {
+            iterations = std::min(iterations * 10, maxIterations);
+            std::this_thread::sleep_for(mPause);
+            elapsed = TimeLoop(loop, context, iterations);
+        }
+        if (elapsed < sampleTimeNs)
+        {
+            const double scale = static_cast<double>(sampleTimeNs) / static_cast<double>(std::max<uint64_t>(elapsed, 1));
+            iterations = std::min(static_cast<uint64_t>(std::ceil(static_cast<double>(iterations) * scale)), maxIterations);
+        }
+
+        std::vector<double> perIteration(static_cast<size_t>(mSamples));
+        for (double& sample : perIteration)
+        {
+            std::this_thread::sleep_for(mPause);
+            sample = static_cast<double>(TimeLoop(loop, context, iterations)) / static_cast<double>(iterations);
+        }
+        std::ranges::sort(perIteration);
+
+        mResult.iterations = iterations;
+        mResult.medianNs = perIteration[perIteration.size() / 2];
+        mResult.minNs = perIteration.front();
+        mResult.items = std::max<size_t>(items, 1);
+    }
+
+    std::vector<Benchmark>& GetBenchmarks()
+    {
+        static std::vector<Benchmark> sBenchmarks;
+        return sBenchmarks;
+    }
+}
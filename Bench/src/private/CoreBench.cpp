@@ -0,0 +1,176 @@
+﻿#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Base/Event.h"
+#include "Base/Layer.h"
+#include "Base/Log.h"
+#include "Bench.h"
+#include "UI/Panel.h"
+#include "UI/PanelRegistry.h"
+
+// Core paths that run for every input event, tab lookup and log call.
+namespace
+{
+    constexpr size_t kLayerCount = 16;
+    // Calls per sample for Log/*: a few MB of records, well inside half of the ring Main
+    // sizes, so the writer's early sweep never falls behind into drops.
+    constexpr uint64_t kLogCallsPerSample = 256 * 1024;
+
+    class EmptyPanel : public tg::Panel
+    {
+    public:
+        using Panel::Panel;
+        void OnRender() override {}
+    };
+
+    // Handles one event type, consuming one in `consumeEvery` of them, like a layer that
+    // owns a region of the window.
+    template<typename T>
+    class HandlerLayer : public tg::Layer
+    {
+    public:
+        HandlerLayer(int priority, uint32_t consumeEvery)
+            : mConsumeEvery(consumeEvery)
+        {
+            SetEventPriority(priority);
+        }
+
+        bool OnEvent(tg::Event& event) override
+        {
+            tg::EventDispatcher dispatcher(event);
+            dispatcher.Dispatch<T>([this](const T&) { return ++mSeen % mConsumeEvery == 0; });
+            return event.handled;
+        }
+
+    private:
+        uint32_t mConsumeEvery;
+        uint32_t mSeen = 0;
+    };
+
+    std::vector<std::string> MakePanelNames(size_t count)
+    {
+        std::vector<std::string> names(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            names[i] = "Telegram +7 900 " + std::to_string(1'000'000 + i);
+        }
+        return names;
+    }
+
+    // Name lookups in random order, as TabManager::FindPanel does for commands and sessions.
+    void FindPanels(tg::bench::Context& context)
+    {
+        const std::vector<std::string> names = MakePanelNames(context.GetSize());
+        tg::PanelRegistry registry;
+        for (const std::string& name : names)
+        {
+            registry.Add(std::make_shared<EmptyPanel>(name));
+        }
+
+        std::vector<std::string_view> lookups(names.begin(), names.end());
+        std::shuffle(lookups.begin(), lookups.end(), std::mt19937(1));
+        context.Run([&]
+        {
+            for (const std::string_view name : lookups)
+            {
+                tg::bench::DoNotOptimize(registry.Find(name));
+            }
+        }, lookups.size());
+    }
+
+    // Handle lookups in tab order, as TabManager does every frame.
+    void GetPanels(tg::bench::Context& context)
+    {
+        const std::vector<std::string> names = MakePanelNames(context.GetSize());
+        tg::PanelRegistry registry;
+        for (const std::string& name : names)
+        {
+            registry.Add(std::make_shared<EmptyPanel>(name));
+        }
+
+        context.Run([&]
+        {
+            for (const tg::PanelHandle handle : registry.GetOrder())
+            {
+                tg::bench::DoNotOptimize(registry.Get(handle));
+            }
+        }, registry.Size());
+    }
+
+    // A frame's worth of input through a stack of kLayerCount layers, the way App::DispatchEvents
+    // walks it: the event list is fetched per event and the first layer to consume stops it.
+    void DispatchEvents(tg::bench::Context& context)
+    {
+        std::vector<std::unique_ptr<tg::Layer>> layers;
+        tg::LayerStack stack;
+        for (size_t i = 0; i < kLayerCount; ++i)
+        {
+            const int priority = static_cast<int>(i % 3);
+            switch (i % 4)
+            {
+            case 0: layers.push_back(std::make_unique<HandlerLayer<tg::MouseMovedEvent>>(priority, 64)); break;
+            case 1: layers.push_back(std::make_unique<HandlerLayer<tg::KeyPressedEvent>>(priority, 8)); break;
+            case 2: layers.push_back(std::make_unique<HandlerLayer<tg::MouseScrolledEvent>>(priority, 4)); break;
+            default: layers.push_back(std::make_unique<HandlerLayer<tg::UserEvent>>(priority, 2)); break;
+            }
+            stack.PushLayer(layers.back().get());
+        }
+
+        std::mt19937 random(5);
+        std::vector<tg::Event> events(context.GetSize());
+        for (tg::Event& event : events)
+        {
+            switch (random() % 4)
+            {
+            case 0: event.data = tg::MouseMovedEvent{ static_cast<float>(random() % 1920), static_cast<float>(random() % 1080) }; break;
+            case 1: event.data = tg::KeyPressedEvent{ static_cast<int>(random() % 128) }; break;
+            case 2: event.data = tg::MouseScrolledEvent{ 0.0f, 1.0f }; break;
+            default: event.data = tg::UserEvent{ static_cast<uint32_t>(random() % 16) }; break;
+            }
+        }
+
+        context.Run([&]
+        {
+            for (const tg::Event& queued : events)
+            {
+                tg::Event event = queued;
+                for (tg::Layer* layer : stack.GetEventLayers())
+                {
+                    if (layer->OnEvent(event) || event.handled)
+                    {
+                        event.handled = true;
+                        break;
+                    }
+                }
+                tg::bench::DoNotOptimize(event.handled);
+            }
+        }, events.size());
+        stack.Clear();
+    }
+
+    // A burst of Info calls with the arguments a typical call carries. Main starts the log
+    // in binary mode, so this is the cost on the logging thread only; the pause between
+    // samples lets the writer drain, since sustained logging at this rate would only drop.
+    void LogBurst(tg::bench::Context& context)
+    {
+        const std::string account = "+7 900 1234567";
+        const size_t count = context.GetSize();
+        context.LimitIterations(kLogCallsPerSample / count, std::chrono::milliseconds(50));
+        context.Run([&]
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                TG(CoreLog, Info, "Chat {} of {} updated, {} unread", i, account, 3)
+            }
+        }, count);
+    }
+}
+
+// Capped well above any real tab count; a million panels is only memory.
+TG_BENCHMARK("Tabs/FindByName", FindPanels, 100'000)
+TG_BENCHMARK("Tabs/GetByHandle", GetPanels, 100'000)
+TG_BENCHMARK("Layers/Dispatch", DispatchEvents)
+TG_BENCHMARK("Log/Info", LogBurst, 100'000)
@@ -0,0 +1,165 @@
+﻿#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "Base/BinaryLog.h"
+#include "Base/Log.h"
+#include "Bench.h"
+
+// Runs the registered microbenchmarks over data sizes 10 to 1M and prints a table; with
+// --json the results are also written out for comparing runs.
+//   Bench [--filter <text>] [--max-size <n>] [--min-time-ms <ms>] [--samples <n>]
+//         [--json <path>] [--list]
+namespace
+{
+    constexpr size_t kSizes[] = { 10, 100, 1'000, 10'000, 100'000, 1'000'000 };
+
+#ifdef _WIN32
+    constexpr const char* kNullDevice = "NUL";
+#else
+    constexpr const char* kNullDevice = "/dev/null";
+#endif
+
+    struct Options
+    {
+        std::string_view filter;
+        size_t maxSize = 1'000'000;
+        uint64_t minTimeMs = 200;
+        int samples = 5;
+        const char* jsonPath = nullptr;
+        bool list = false;
+    };
+
+    template<typename T>
+    bool ParseNumber(const char* text, T& value)
+    {
+        const char* end = text + std::strlen(text);
+        const auto [ptr, ec] = std::from_chars(text, end, value);
+        return ec == std::errc() && ptr == end;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (arg == "--list")
+            {
+                options.list = true;
+                continue;
+            }
+
+            const char* value = i + 1 < argc ? argv[++i] : nullptr;
+            bool valid = true;
+            if (!value) valid = false;
+            else if (arg == "--filter") options.filter = value;
+            else if (arg == "--json") options.jsonPath = value;
+            else if (arg == "--max-size") valid = ParseNumber(value, options.maxSize);
+            else if (arg == "--min-time-ms") valid = ParseNumber(value, options.minTimeMs);
+            else if (arg == "--samples") valid = ParseNumber(value, options.samples) && options.samples > 0;
+            else valid = false;
+
+            if (!valid)
+            {
+                std::fprintf(stderr, "Bad argument '%s'\n", arg.data());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string FormatTime(double ns)
+    {
+        char buffer[32];
+        if (ns < 1e3) std::snprintf(buffer, sizeof(buffer), "%.2f ns", ns);
+        else if (ns < 1e6) std::snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+        else std::snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+        return buffer;
+    }
+
+    void WriteJson(std::FILE* file, const std::vector<tg::bench::Result>& results, const Options& options)
+    {
+        std::fprintf(file, "{\n  \"minTimeMs\": %llu,\n  \"samples\": %d,\n  \"results\": [",
+                     static_cast<unsigned long long>(options.minTimeMs), options.samples);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            // Benchmark names are plain ASCII identifiers and slashes; nothing to escape.
+            const tg::bench::Result& result = results[i];
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %llu, \"items\": %zu, "
+                               "\"medianNs\": %.3f, \"minNs\": %.3f, \"nsPerItem\": %.4f}",
+                         i == 0 ? "" : ",", result.name.c_str(), result.size, static_cast<unsigned long long>(result.iterations),
+                         result.items, result.medianNs, result.minNs, result.medianNs / static_cast<double>(result.items));
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 1;
+
+    if (options.list)
+    {
+        for (const tg::bench::Benchmark& benchmark : tg::bench::GetBenchmarks())
+        {
+            std::printf("%s\n", benchmark.name);
+        }
+        return 0;
+    }
+
+    // Benchmarked code logs, and Log/* times the macros themselves, in the binary mode the
+    // app uses for long runs. Records go to the null device so a run leaves no files, and
+    // the rings have room for a whole Log/* sample.
+    tg::LogConfig logConfig;
+    logConfig.binary = true;
+    logConfig.binaryRingBytes = 64 * 1024 * 1024;
+    logConfig.viewerLines = 0;
+    tg::Log::Init(logConfig);
+    tg::BinaryLog::Open(kNullDevice);
+
+    std::printf("%-28s %10s %12s %12s %12s %12s\n", "Benchmark", "Size", "Iterations", "Median", "Min", "Per item");
+    std::vector<tg::bench::Result> results;
+    for (const tg::bench::Benchmark& benchmark : tg::bench::GetBenchmarks())
+    {
+        if (std::string_view(benchmark.name).find(options.filter) == std::string_view::npos) continue;
+
+        for (const size_t size : kSizes)
+        {
+            if (size > options.maxSize || size > benchmark.maxSize) break;
+
+            tg::bench::Context context(benchmark.name, size, options.minTimeMs * 1'000'000, options.samples);
+            benchmark.function(context);
+            if (!context.HasResult()) continue;
+
+            const tg::bench::Result& result = context.GetResult();
+            std::printf("%-28s %10zu %12llu %12s %12s %12s\n", result.name.c_str(), result.size,
+                        static_cast<unsigned long long>(result.iterations), FormatTime(result.medianNs).c_str(),
+                        FormatTime(result.minNs).c_str(), FormatTime(result.medianNs / static_cast<double>(result.items)).c_str());
+            std::fflush(stdout);
+            results.push_back(result);
+        }
+    }
+
+    const uint64_t dropped = tg::Log::GetDroppedCount();
+    tg::Log::Shutdown();
+    if (dropped > 0)
+    {
+        std::fprintf(stderr, "%llu log messages were dropped; Log/* timings are optimistic\n", static_cast<unsigned long long>(dropped));
+    }
+
+    if (options.jsonPath)
+    {
+        std::FILE* file = std::fopen(options.jsonPath, "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "Could not open '%s' for writing\n", options.jsonPath);
+            return 1;
+        }
+        WriteJson(file, results, options);
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+﻿#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <imgui.h>
+
+#include "Bench.h"
+#include "Memory/FixedString.h"
+#include "Panels/AccountRegistry.h"
+#include "Panels/TGModel.h"
+
+// The per-frame list work of TGPanel: ordering and searching the chat list, the account
+// selector, and sizing message bubbles.
+namespace
+{
+    constexpr const char* kWords[] = {
+        "John", "Alice", "Work", "Group", "Family", "Project", "Team", "Gaming", "Squad", "Book",
+        "Club", "Fitness", "News", "Channel", "Support", "Отдел", "Продаж", "Café", "Daily", "Updates"
+    };
+
+    std::string MakeText(std::mt19937& random, size_t words)
+    {
+        std::string text;
+        for (size_t i = 0; i < words; ++i)
+        {
+            if (i > 0) text += ' ';
+            text += kWords[random() % std::size(kWords)];
+        }
+        return text;
+    }
+
+    // Titles of one to three words, about one chat in twenty pinned, in random order.
+    std::vector<tg::ChatInfo> MakeChats(size_t count)
+    {
+        std::mt19937 random(42);
+        std::vector<tg::ChatInfo> chats(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            chats[i].chatId = static_cast<int64_t>(random());
+            chats[i].title = MakeText(random, 1 + random() % 3);
+            chats[i].isPinned = random() % 20 == 0;
+        }
+        return chats;
+    }
+
+    std::vector<tg::Message> MakeMessages(size_t count)
+    {
+        std::mt19937 random(7);
+        std::vector<tg::Message> messages(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            messages[i].text = MakeText(random, 1 + random() % 40);
+            messages[i].isOutgoing = random() % 2 == 0;
+        }
+        return messages;
+    }
+
+    std::vector<const tg::ChatInfo*> MakeView(const std::vector<tg::ChatInfo>& chats)
+    {
+        std::vector<const tg::ChatInfo*> view(chats.size());
+        std::ranges::transform(chats, view.begin(), [](const tg::ChatInfo& chat) { return &chat; });
+        return view;
+    }
+
+    // Accounts with the mock chats every new account gets; size is the account count.
+    tg::AccountRegistry MakeAccounts(size_t count, std::vector<std::string>& phones)
+    {
+        tg::AccountRegistry accounts;
+        for (size_t i = 0; i < count; ++i)
+        {
+            phones.push_back("+1555" + std::to_string(1'000'000 + i));
+            accounts.Add(std::make_unique<tg::TelegramAccount>(phones.back()));
+        }
+        return accounts;
+    }
+
+    // Text measurement needs a font, so the layout benchmarks run inside a frame of an
+    // ImGui context that never renders.
+    class HeadlessImGui
+    {
+    public:
+        HeadlessImGui()
+        {
+            ImGui::CreateContext();
+            ImGuiIO& io = ImGui::GetIO();
+            io.IniFilename = nullptr;
+            io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+            io.Fonts->AddFontDefault();
+            unsigned char* pixels = nullptr;
+            int width = 0, height = 0;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+            ImGui::NewFrame();
+        }
+
+        ~HeadlessImGui()
+        {
+            ImGui::EndFrame();
+            ImGui::DestroyContext();
+        }
+    };
+
+    void EnsureImGuiFrame()
+    {
+        static HeadlessImGui sImGui;
+    }
+
+    void SortChats(tg::bench::Context& context)
+    {
+        const std::vector<tg::ChatInfo> chats = MakeChats(context.GetSize());
+        const std::vector<const tg::ChatInfo*> unsorted = MakeView(chats);
+        std::vector<const tg::ChatInfo*> view(unsorted.size());
+        // Includes copying the unsorted view back, as TGPanel rebuilds it every frame.
+        context.Run([&]
+        {
+            std::ranges::copy(unsorted, view.begin());
+            tg::SortChatList(view);
+            tg::bench::DoNotOptimize(view.front());
+        }, chats.size());
+    }
+
+    void FilterChats(tg::bench::Context& context)
+    {
+        const std::vector<tg::ChatInfo> chats = MakeChats(context.GetSize());
+        const std::vector<const tg::ChatInfo*> all = MakeView(chats);
+        std::vector<const tg::ChatInfo*> view(all.size());
+        tg::FixedString<64> query;
+        tg::FoldSearchQuery("GrOuP", query);
+        context.Run([&]
+        {
+            std::ranges::copy(all, view.begin());
+            tg::bench::DoNotOptimize(tg::FilterChatList(view, query));
+        }, chats.size());
+    }
+
+    // Folding what was typed, once per keystroke: size is the number of queries.
+    void FoldQueries(tg::bench::Context& context)
+    {
+        std::mt19937 random(3);
+        std::vector<std::string> queries(context.GetSize());
+        for (std::string& query : queries)
+        {
+            query = MakeText(random, 1 + random() % 3);
+        }
+
+        tg::FixedString<256> folded;
+        context.Run([&]
+        {
+            for (const std::string& query : queries)
+            {
+                tg::FoldSearchQuery(query, folded);
+                tg::bench::DoNotOptimize(folded.GetSize());
+            }
+        }, queries.size());
+    }
+
+    // Searching message bodies rather than titles.
+    void SearchMessages(tg::bench::Context& context)
+    {
+        const std::vector<tg::Message> messages = MakeMessages(context.GetSize());
+        tg::FixedString<64> needle;
+        tg::FoldSearchQuery("Продаж café", needle);
+        context.Run([&]
+        {
+            size_t found = 0;
+            for (const tg::Message& message : messages)
+            {
+                found += tg::ContainsIgnoreCase(message.text, needle) ? 1 : 0;
+            }
+            tg::bench::DoNotOptimize(found);
+        }, messages.size());
+    }
+
+    // Deduplication and restoring chat windows look every account up by phone.
+    void FindAccounts(tg::bench::Context& context)
+    {
+        std::vector<std::string> phones;
+        const tg::AccountRegistry accounts = MakeAccounts(context.GetSize(), phones);
+        context.Run([&]
+        {
+            for (const std::string& phone : phones)
+            {
+                tg::bench::DoNotOptimize(accounts.Find(phone));
+            }
+        }, phones.size());
+    }
+
+    // One frame of the open account selector: the search, plus the unread badge on the combo.
+    void FilterAccounts(tg::bench::Context& context)
+    {
+        std::vector<std::string> phones;
+        const tg::AccountRegistry accounts = MakeAccounts(context.GetSize(), phones);
+        std::vector<tg::AccountId> matches(accounts.Size());
+        tg::FixedString<64> query;
+        tg::FoldSearchQuery("555100", query);
+        context.Run([&]
+        {
+            tg::bench::DoNotOptimize(accounts.Filter(query, matches));
+            tg::bench::DoNotOptimize(accounts.GetTotalUnread());
+        }, accounts.Size());
+    }
+
+    void MeasureBubbles(tg::bench::Context& context)
+    {
+        EnsureImGuiFrame();
+        const std::vector<tg::Message> messages = MakeMessages(context.GetSize());
+        context.Run([&]
+        {
+            float total = 0.0f;
+            for (const tg::Message& message : messages)
+            {
+                total += tg::MeasureMessageWidth(message, 420.0f);
+            }
+            tg::bench::DoNotOptimize(total);
+        }, messages.size());
+    }
+
+    // Height of each bubble with its text wrapped, what a message list needs to place rows.
+    void WrapBubbles(tg::bench::Context& context)
+    {
+        EnsureImGuiFrame();
+        const std::vector<tg::Message> messages = MakeMessages(context.GetSize());
+        context.Run([&]
+        {
+            float total = 0.0f;
+            for (const tg::Message& message : messages)
+            {
+                const char* text = message.text.c_str();
+                total += ImGui::CalcTextSize(text, text + message.text.size(), false, 420.0f - 16.0f).y;
+            }
+            tg::bench::DoNotOptimize(total);
+        }, messages.size());
+    }
+}
+
+TG_BENCHMARK("ChatList/Sort", SortChats)
+TG_BENCHMARK("ChatList/Filter", FilterChats)
+TG_BENCHMARK("Accounts/Find", FindAccounts, 100'000)
+TG_BENCHMARK("Accounts/Filter", FilterAccounts, 100'000)
+TG_BENCHMARK("Search/Fold", FoldQueries)
+TG_BENCHMARK("Search/Messages", SearchMessages)
+TG_BENCHMARK("Message/Width", MeasureBubbles)
+TG_BENCHMARK("Message/WrapHeight", WrapBubbles)
@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tg::bench
+{
+    // Keeps the compiler from discarding a result the benchmark never uses.
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sSink;
+        sSink = &value;
+#endif
+    }
+
+    struct Result
+    {
+        std::string name;
+        size_t size = 0;
+        uint64_t iterations = 0; // per sample
+        double medianNs = 0.0;   // per iteration
+        double minNs = 0.0;
+        size_t items = 0;        // processed per iteration
+    };
+
+    // Handed to a benchmark once per data size. The benchmark builds its input for
+    // GetSize() and then calls Run() once with the work to time.
+    class Context
+    {
+    public:
+        Context(std::string name, size_t size, uint64_t minTimeNs, int samples);
+
+        [[nodiscard]] size_t GetSize() const { return mSize; }
+
+        // For work that queues up behind a background thread (the log writer): at most this
+        // many calls per sample, with a pause before each sample for the thread to catch up.
+        void LimitIterations(uint64_t maxIterations, std::chrono::milliseconds pause)
+        {
+            mMaxIterations = maxIterations > 0 ? maxIterations : 1;
+            mPause = pause;
+        }
+
+        // Calls `work` in a loop, enough times per sample to last the minimum time, and
+        // records the median and fastest sample. `items` is how much one call processes.
+        template<typename F>
+        void Run(F&& work, size_t items)
+        {
+            Measure([](void* context, uint64_t iterations)
+            {
+                auto& function = *static_cast<std::remove_reference_t<F>*>(context);
+                for (uint64_t i = 0; i < iterations; ++i) function();
+            }, &work, items);
+        }
+
+        [[nodiscard]] bool HasResult() const { return mResult.iterations > 0; }
+        [[nodiscard]] const Result& GetResult() const { return mResult; }
+
+    private:
+        void Measure(void (*loop)(void*, uint64_t), void* context, size_t items);
+
+    private:
+        size_t mSize;
+        uint64_t mMinTimeNs;
+        int mSamples;
+        uint64_t mMaxIterations = UINT64_MAX;
+        std::chrono::milliseconds mPause{0};
+        Result mResult;
+    };
+
+    using BenchmarkFunction = void (*)(Context&);
+
+    struct Benchmark
+    {
+        const char* name;
+        BenchmarkFunction function;
+        size_t maxSize; // larger sizes are skipped
+    };
+
+    // Every benchmark registered with TG_BENCHMARK, in registration order.
+    std::vector<Benchmark>& GetBenchmarks();
+
+    struct Registrar
+    {
+        Registrar(const char* name, BenchmarkFunction function, size_t maxSize = SIZE_MAX)
+        {
+            GetBenchmarks().push_back({ name, function, maxSize });
+        }
+    };
+}
+
+#define TG_BENCH_CONCAT_IMPL(a, b) a##b
+#define TG_BENCH_CONCAT(a, b) TG_BENCH_CONCAT_IMPL(a, b)
+
+// TG_BENCHMARK("Group/Name", Function) or TG_BENCHMARK("Group/Name", Function, maxSize)
+#define TG_BENCHMARK(name, ...) \
+    static ::tg::bench::Registrar TG_BENCH_CONCAT(tgBenchRegistrar, __LINE__)(name, __VA_ARGS__);
@@ -1,12 +1,51 @@
 #include "Base/App.h"
 
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+
+#include "Base/EventQueue.h"
 #include "Base/Log.h"
+#include "Base/Startup.h"
+#include "Base/TimerService.h"
 #include "Base/Window.h"
+#include "Debug/Profiler.h"
+#include "ImGui/FontLibrary.h"
 #include "ImGui/ImGuiLayer.h"
+#include "Jobs/JobSystem.h"
+#include "Jobs/MainThreadDispatcher.h"
+#include "Memory/AllocationTracker.h"
+#include "Memory/FrameArena.h"
 
 namespace tg
 {
     App* App::sInstance = nullptr;
+    CommandLineArgs App::sCommandLineArgs;
+
+    bool CommandLineArgs::HasFlag(std::string_view flag) const
+    {
+        for (int i = 1; i < count; ++i)
+        {
+            std::string_view arg(args[i]);
+            if (arg == flag || (arg.starts_with(flag) && arg.size() > flag.size() && arg[flag.size()] == '='))
+                return true;
+        }
+        return false;
+    }
+
+    const char* CommandLineArgs::GetValue(std::string_view flag) const
+    {
+        for (int i = 1; i < count; ++i)
+        {
+            std::string_view arg(args[i]);
+            if (arg == flag)
+                return (i + 1 < count) ? args[i + 1] : nullptr;
+            if (arg.starts_with(flag) && arg.size() > flag.size() && arg[flag.size()] == '=')
+                return args[i] + flag.size() + 1;
+        }
+        return nullptr;
+    }
     
     App::App()
     {
@@ -28,12 +67,95 @@ namespace tg
         winCfg.transparent = false;
         winCfg.vsync = VSync::On;
 
-        mWindow = std::unique_ptr<Window>(Window::Create(winCfg));
-        mWindow->Init();
+        if (sCommandLineArgs.HasFlag("--headless"))
+        {
+            winCfg.mode = Mode::Headless;
+            winCfg.vsync = VSync::Off;
+        }
 
-        mImGuiLayer = ImGuiLayer::Create();
-        PushOverlay(mImGuiLayer);
-        
+        if (const char* frames = sCommandLineArgs.GetValue("--frames"))
+        {
+            const char* end = frames + std::strlen(frames);
+            uint64_t maxFrames = 0;
+            const auto [ptr, ec] = std::from_chars(frames, end, maxFrames);
+            if (ec == std::errc() && ptr == end)
+            {
+                mMaxFrames = maxFrames;
+                mFrameSamples.reserve(mMaxFrames);
+            }
+            else
+            {
+                TG(CoreLog, Error, "--frames '{}' is not a frame count; running until the window closes", frames)
+            }
+        }
+
+        if (const char* budget = sCommandLineArgs.GetValue("--dispatch-budget-us"))
+        {
+            const char* end = budget + std::strlen(budget);
+            int64_t microseconds = 0;
+            const auto [ptr, ec] = std::from_chars(budget, end, microseconds);
+            if (ec == std::errc() && ptr == end && microseconds > 0)
+            {
+                MainThreadDispatcher::Get().SetBudget(std::chrono::microseconds(microseconds));
+            }
+            else
+            {
+                TG(CoreLog, Warn, "Ignoring --dispatch-budget-us '{}': expected a positive number of microseconds", budget)
+            }
+        }
+
+        // Only redraw for input, timers and posted work once the UI has settled.
+        mIdleWait = sCommandLineArgs.HasFlag("--idle-wait");
+        MainThreadDispatcher::Get().SetWakeHandler(&Window::Wake);
+
+        if (const char* path = sCommandLineArgs.GetValue("--replay-input"))
+        {
+            mInputReplay = std::make_unique<InputScript>();
+            mStartup.Add("Input Script", StartupThread::Worker, [this, path = std::string(path)]
+            {
+                if (!mInputReplay->Load(path))
+                {
+                    mInputReplay.reset();
+                }
+            });
+        }
+        if (const char* path = sCommandLineArgs.GetValue("--record-input"))
+        {
+            mInputRecording = std::make_unique<InputScript>();
+            mInputRecordingPath = path;
+        }
+
+        mStrictAllocations = sCommandLineArgs.HasFlag("--strict-allocations");
+        if (mStrictAllocations && !AllocationTracker::IsEnabled())
+        {
+            TG(CoreLog, Warn, "--strict-allocations needs a build with TG_TRACK_ALLOCATIONS; ignored")
+        }
+
+        // Fonts bake against the primary monitor's scale while the GL context comes up;
+        // the layers (and whatever derived apps add) wait for ImGui.
+        mStartup.Add("Log Files", StartupThread::Worker, [] { Log::OpenFiles(); });
+        mStartup.Add("Platform", StartupThread::Main, [this, mode = winCfg.mode]
+        {
+            Window::InitPlatform(mode);
+            mContentScale = Window::GetPrimaryContentScale();
+        });
+        mStartup.Add("Fonts", StartupThread::Worker, [this]
+        {
+            FontLibrary& fonts = FontLibrary::Get();
+            fonts.SetConfig(FontLibraryConfig::FromCommandLine());
+            fonts.Prepare(mContentScale);
+        }, {"Platform"});
+        mStartup.Add("Window", StartupThread::Main, [this, winCfg]
+        {
+            mWindow = std::unique_ptr<Window>(Window::Create(winCfg));
+            mWindow->Init();
+        }, {"Platform"});
+        mStartup.Add("ImGui", StartupThread::Main, [this]
+        {
+            mImGuiLayer = ImGuiLayer::Create();
+            PushOverlay(mImGuiLayer);
+        }, {"Window", "Fonts"});
+        mStartup.Add("Layers", StartupThread::Main, [this] { OnInit(); }, {"ImGui"});
     }
 
     App::~App()
@@ -60,6 +182,11 @@ namespace tg
     {
     }
 
+    void App::Close()
+    {
+        mWindow->RequestClose();
+    }
+
     void App::PushLayer(Layer* layer)
     {
         mLayerStack.PushLayer(layer);
@@ -82,44 +209,197 @@ namespace tg
 
     void App::RenderImGui()
     {
+        TG_PROFILE_FUNCTION()
         mImGuiLayer->Begin();
 
-        for (auto& layer : mLayerStack)
+        for (Layer* layer : mLayerStack.GetVisibleLayers())
+        {
+            layer->OnImGuiRender();
+        }
+    }
+
+    size_t App::DispatchEvents()
+    {
+        TG_PROFILE_FUNCTION()
+        const size_t count = EventQueue::Get().Drain([this](Event& event)
         {
-            if (layer && layer->IsActive())
+            // Re-fetched per event: a handler may have changed which layers take events.
+            for (Layer* layer : mLayerStack.GetEventLayers())
             {
-                layer->OnImGuiRender();
+                if (layer->OnEvent(event) || event.handled)
+                {
+                    event.handled = true;
+                    break;
+                }
             }
-        }
+        });
+        Profiler::SetCounter("Events/Per Frame", static_cast<double>(count));
+        Profiler::SetCounter("Events/Dropped", static_cast<double>(EventQueue::Get().GetDroppedCount()));
+        return count;
     }
 
 
     void App::Run()
     {
-        OnInit();
+        mStartup.Run();
+        if (mInputReplay)
+        {
+            // Recorded at whatever rate the live run had; replayed at a steady 60 Hz.
+            mImGuiLayer->SetFixedDeltaTime(InputScript::kFrameSeconds);
+        }
         mFrameTimer.Reset();
         while (mWindow->isOpen())
         {
-            float currentFrameTime = mFrameTimer.Reset();
-            mTimeStep = TimeStep(currentFrameTime);
-            
-            mWindow->ProcessEvents();
+            float frameCpuMs = 0.0f;
+            const uint64_t allocationsBefore = AllocationTracker::GetThreadAllocationCount();
+            {
+                TG_PROFILE_SCOPE("Frame")
+                FrameArena::Get().Reset();
+                float currentFrameTime = mFrameTimer.Reset();
+                mTimeStep = TimeStep(currentFrameTime);
+
+                {
+                    TG_PROFILE_SCOPE("ProcessEvents")
+                    mWindow->ProcessEvents();
+                }
+                const size_t events = DispatchEvents();
+                const uint32_t timersFired = TimerService::Get().Advance(Profiler::NowNs());
+                mQuietFrames = (events > 0 || timersFired > 0) ? 0 : mQuietFrames + 1;
+
+                mLastFrameTime = mTimeStep;
+                {
+                    TG_PROFILE_SCOPE("OnUpdate")
+                    for (Layer* layer : mLayerStack.GetActiveLayers())
+                    {
+                        layer->OnUpdate(mTimeStep);
+                    }
+                }
+
+                if (MainThreadDispatcher::Get().Drain() > 0)
+                {
+                    mQuietFrames = 0;
+                }
+
+                if (mInputReplay)
+                {
+                    mInputReplay->ReplayFrame(mFrameIndex, mInputCommandHandler);
+                }
+
+                App* app = this;
+                app->RenderImGui();
+                if (mInputRecording)
+                {
+                    mInputRecording->CaptureFrame(mFrameIndex);
+                }
+                {
+                    TG_PROFILE_SCOPE("ImGuiLayer::End")
+                    app->mImGuiLayer->End();
+                }
+
+                // CPU work for the frame, excluding the (possibly vsync-blocked) swap.
+                frameCpuMs = mFrameTimer.GetElapsedMilliseconds();
+                Profiler::SetCounter("CPU/Frame (ms)", frameCpuMs);
+                Profiler::SetCounter("CPU/Frame Interval (ms)", mTimeStep.GetMilliseconds());
+
+                if (!mImGuiLayer->PresentsOnRenderThread())
+                {
+                    TG_PROFILE_SCOPE("SwapBuffers")
+                    mWindow->SwapBuffers();
+                }
+            }
+            JobSystem::Get().PublishStats();
+            Profiler::OnFrameEnd();
+
+            if (mFrameIndex == 0)
+            {
+                mStartup.LogReport(Profiler::NowNs());
+            }
+
+            const uint64_t frameAllocations = AllocationTracker::GetThreadAllocationCount() - allocationsBefore;
+            if constexpr (AllocationTracker::IsEnabled())
+            {
+                CheckFrameAllocations(frameAllocations);
+            }
 
-            mLastFrameTime = mTimeStep;
-            for (auto& layer : mLayerStack)
+            ++mFrameIndex;
+            if (mMaxFrames > 0)
             {
-                if (layer && layer->IsActive())
+                const ImGuiFrameStats& stats = mImGuiLayer->GetFrameStats();
+                mFrameSamples.push_back({ frameCpuMs, frameAllocations, stats.drawCalls, stats.vertices });
+                if (mFrameIndex >= mMaxFrames)
                 {
-                    layer->OnUpdate(mTimeStep);
+                    Close();
                 }
             }
+            else if (!mWindow->IsHeadless())
+            {
+                // A few quiet frames first, so ImGui can settle hover and layout state.
+                constexpr uint32_t kIdleFrames = 3;
+                const bool idle = mWindow->IsIconified() || (mIdleWait && mQuietFrames >= kIdleFrames);
+                if (idle && MainThreadDispatcher::Get().GetBacklog() == 0)
+                {
+                    WaitForWork();
+                }
+            }
+        }
 
-            App* app = this;
-            app->RenderImGui();
-            app->mImGuiLayer->End();
-            
-            mWindow->SwapBuffers();
+        if (mMaxFrames > 0)
+        {
+            LogBenchmarkSummary();
+        }
+        if (mInputRecording)
+        {
+            mInputRecording->Save(mInputRecordingPath);
         }
         OnShutdown();
     }
+
+    void App::WaitForWork()
+    {
+        TG_PROFILE_FUNCTION()
+        // Capped so layers that poll in OnUpdate (session saves, tab hibernation) still run.
+        constexpr uint64_t kMaxWaitNs = 500'000'000;
+
+        const uint64_t now = Profiler::NowNs();
+        const uint64_t deadline = std::min(TimerService::Get().GetNextDeadlineNs(), now + kMaxWaitNs);
+        if (deadline > now)
+        {
+            mWindow->WaitEvents(static_cast<double>(deadline - now) / 1e9);
+        }
+    }
+
+    void App::CheckFrameAllocations(uint64_t allocations)
+    {
+        Profiler::SetCounter("Memory/Frame Allocations", static_cast<double>(allocations));
+
+        // Fonts, atlas pages and arena growth settle during the first frames.
+        constexpr uint64_t kWarmupFrames = 300;
+        if (!mStrictAllocations || mFrameIndex < kWarmupFrames || allocations == 0) return;
+
+        TG(CoreLog, Error, "Frame {} made {} heap allocations on the main thread", mFrameIndex, allocations)
+        assert(allocations == 0 && "Steady-state frame allocated from the global heap");
+    }
+
+    void App::LogBenchmarkSummary() const
+    {
+        if (mFrameSamples.empty()) return;
+
+        std::vector<float> sorted;
+        sorted.reserve(mFrameSamples.size());
+        for (const FrameSample& sample : mFrameSamples) sorted.push_back(sample.cpuMs);
+        std::ranges::sort(sorted);
+        double total = 0.0;
+        for (float ms : sorted) total += ms;
+
+        const auto percentile = [&sorted](float p)
+        {
+            return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<float>(sorted.size())))];
+        };
+
+        const ImGuiFrameStats& stats = mImGuiLayer->GetFrameStats();
+        TG(CoreLog, Info, "Frame benchmark: {} frames, CPU ms avg {:.3f} p50 {:.3f} p95 {:.3f} max {:.3f}",
+           sorted.size(), total / static_cast<double>(sorted.size()), percentile(0.5f), percentile(0.95f), sorted.back())
+        TG(CoreLog, Info, "Last frame: {} viewports, {} draw lists, {} draw calls, {} vertices, {} indices",
+           stats.viewports, stats.drawLists, stats.drawCalls, stats.vertices, stats.indices)
+    }
 }
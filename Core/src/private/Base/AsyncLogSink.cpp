@@ -0,0 +1,255 @@
+﻿#include "Base/AsyncLogSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    AsyncLogWriter::AsyncLogWriter(const LogConfig& config)
+        : mConfig(config)
+        , mQueue(config.queueCapacity)
+    {
+        mThread = std::thread(&AsyncLogWriter::WriterMain, this);
+    }
+
+    AsyncLogWriter::~AsyncLogWriter()
+    {
+        Stop();
+    }
+
+    void AsyncLogWriter::Push(AsyncLogSink* sink, const spdlog::details::log_msg& msg)
+    {
+        Record record;
+        record.sink = sink;
+        record.time = msg.time;
+        record.source = msg.source;
+        record.loggerName = msg.logger_name;
+        record.threadId = msg.thread_id;
+        record.level = msg.level;
+
+        size_t size = msg.payload.size();
+        if (size > Record::kMaxPayload)
+        {
+            // Cut on a code point boundary, so the marker follows valid text.
+            const std::string_view marker = Record::kTruncatedMarker;
+            size = Record::kMaxPayload - marker.size();
+            while (size > 0 && (static_cast<unsigned char>(msg.payload.data()[size]) & 0xC0) == 0x80) --size;
+            std::memcpy(record.payload + size, marker.data(), marker.size());
+            record.size = static_cast<uint16_t>(size + marker.size());
+        }
+        else
+        {
+            record.size = static_cast<uint16_t>(size);
+        }
+        std::memcpy(record.payload, msg.payload.data(), size);
+
+        if (!mQueue.TryPush(record))
+        {
+            const bool important = record.level >= spdlog::level::err;
+            if (important || mConfig.overflow == LogOverflowPolicy::Block)
+            {
+                PushBlocking(record);
+            }
+            else if (mConfig.overflow == LogOverflowPolicy::DropNewest)
+            {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                bool pushed = false;
+                while (!pushed)
+                {
+                    Record oldest;
+                    if (mQueue.TryPop(oldest))
+                    {
+                        if (oldest.level >= spdlog::level::err)
+                        {
+                            // Errors are never evicted: it goes back in, a little out of order
+                            // (its time stamp is kept), and the new message is the one dropped.
+                            PushBlocking(oldest);
+                            mDropped.fetch_add(1, std::memory_order_relaxed);
+                            return;
+                        }
+                        mDropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    pushed = mQueue.TryPush(record);
+                }
+            }
+        }
+
+        // Pairs with the writer's fence before it checks the queue, so either it sees this
+        // message or this sees it asleep. Only the first message after it went idle pays
+        // for the wake-up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mSleeping.load(std::memory_order_relaxed))
+        {
+            Wake();
+        }
+    }
+
+    void AsyncLogWriter::PushBlocking(const Record& record)
+    {
+        for (uint32_t attempt = 0; !mQueue.TryPush(record); ++attempt)
+        {
+            if (mStopRequested.load(std::memory_order_relaxed))
+            {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Wake();
+            if (attempt < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void AsyncLogWriter::Flush()
+    {
+        const uint64_t ticket = mFlushRequested.fetch_add(1) + 1;
+        Wake();
+        std::unique_lock lock(mMutex);
+        mFlushed.wait(lock, [&] { return mFlushCompleted >= ticket; });
+    }
+
+    void AsyncLogWriter::Stop()
+    {
+        if (!mThread.joinable()) return;
+
+        mStopRequested.store(true);
+        Wake();
+        mThread.join();
+    }
+
+    void AsyncLogWriter::Register(AsyncLogSink* sink)
+    {
+        std::lock_guard lock(mMutex);
+        mSinks.push_back(sink);
+    }
+
+    void AsyncLogWriter::Unregister(AsyncLogSink* sink)
+    {
+        std::lock_guard lock(mMutex);
+        std::erase(mSinks, sink);
+    }
+
+    void AsyncLogWriter::Wake()
+    {
+        std::lock_guard lock(mMutex);
+        mWake.notify_one();
+    }
+
+    void AsyncLogWriter::WriterMain()
+    {
+        Profiler::SetThreadName("Log Writer");
+        using Clock = std::chrono::steady_clock;
+        const auto flushInterval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(std::max(mConfig.flushIntervalSeconds, 0.001f)));
+
+        auto lastFlush = Clock::now();
+        bool dirty = false;
+        uint64_t written = 0;
+        Record record;
+        for (;;)
+        {
+            // Read before draining: everything pushed before the request is in the queue by now.
+            const uint64_t flushRequest = mFlushRequested.load();
+            const bool stopping = mStopRequested.load();
+
+            bool urgent = false;
+            while (mQueue.TryPop(record))
+            {
+                Write(record);
+                urgent |= record.level >= spdlog::level::err;
+                dirty = true;
+                ++written;
+            }
+
+            const auto now = Clock::now();
+            const bool flushRequested = flushRequest != mFlushCompleted;
+            if (dirty && (urgent || stopping || flushRequested || now - lastFlush >= flushInterval))
+            {
+                FlushTargets();
+                dirty = false;
+                lastFlush = now;
+                Profiler::SetCounter("Log/Written", static_cast<double>(written));
+                Profiler::SetCounter("Log/Dropped", static_cast<double>(GetDroppedCount()));
+            }
+
+            std::unique_lock lock(mMutex);
+            if (flushRequested || stopping)
+            {
+                // Once stopped, nothing is left to wait for.
+                mFlushCompleted = stopping ? UINT64_MAX : flushRequest;
+                mFlushed.notify_all();
+            }
+            if (stopping) break;
+
+            mSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (mQueue.GetSize() == 0 && !mStopRequested.load() && mFlushRequested.load() == mFlushCompleted)
+            {
+                mWake.wait_for(lock, dirty ? flushInterval - (Clock::now() - lastFlush) : flushInterval);
+            }
+            mSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void AsyncLogWriter::Write(const Record& record) const
+    {
+        spdlog::details::log_msg msg(record.time, record.source, record.loggerName, record.level,
+                                     spdlog::string_view_t(record.payload, record.size));
+        msg.thread_id = record.threadId;
+        for (const spdlog::sink_ptr& target : record.sink->mTargets)
+        {
+            if (target->should_log(msg.level))
+            {
+                target->log(msg);
+            }
+        }
+    }
+
+    void AsyncLogWriter::FlushTargets()
+    {
+        std::lock_guard lock(mMutex);
+        for (AsyncLogSink* sink : mSinks)
+        {
+            for (const spdlog::sink_ptr& target : sink->mTargets)
+            {
+                target->flush();
+            }
+        }
+    }
+
+    AsyncLogSink::AsyncLogSink(std::shared_ptr<AsyncLogWriter> writer, std::vector<spdlog::sink_ptr> targets)
+        : mWriter(std::move(writer))
+        , mTargets(std::move(targets))
+    {
+        mWriter->Register(this);
+    }
+
+    AsyncLogSink::~AsyncLogSink()
+    {
+        mWriter->Unregister(this);
+    }
+
+    void AsyncLogSink::set_pattern(const std::string& pattern)
+    {
+        for (const spdlog::sink_ptr& target : mTargets)
+        {
+            target->set_pattern(pattern);
+        }
+    }
+
+    void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter)
+    {
+        for (const spdlog::sink_ptr& target : mTargets)
+        {
+            target->set_formatter(formatter->clone());
+        }
+    }
+}
@@ -0,0 +1,354 @@
+﻿#include "Base/BinaryLog.h"
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "spdlog/details/os.h"
+
+#include "Base/BinaryStream.h"
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+#include "Memory/AllocationTracker.h"
+
+namespace tg
+{
+    namespace detail
+    {
+        LogThreadRing::LogThreadRing(size_t capacity, uint64_t threadId)
+            : data(std::make_unique<uint8_t[]>(capacity))
+            , mask(capacity - 1)
+            , threadId(threadId)
+        {
+        }
+    }
+
+    namespace
+    {
+        using detail::LogThreadRing;
+
+        // Marks the calling thread's ring as retired when the thread exits; the writer frees
+        // it once drained.
+        struct ThreadRingOwner
+        {
+            LogThreadRing* ring = nullptr;
+            ~ThreadRingOwner()
+            {
+                if (ring) ring->retired.store(true, std::memory_order_release);
+            }
+        };
+
+        struct BinaryLogState
+        {
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::vector<std::unique_ptr<LogThreadRing>> rings; // guarded by mutex
+            size_t ringBytes = 0;
+            float flushIntervalSeconds = 1.0f;
+            bool stopRequested = false; // guarded by mutex
+            std::string openPath;       // guarded by mutex; set by Open() for the writer to pick up
+            std::atomic<uint64_t> droppedTotal{0};
+            std::thread thread;
+        };
+
+        BinaryLogState sState;
+
+        // How often the writer sweeps the rings. Producers never signal it, so this bounds
+        // how stale the file can be and how much a ring has to absorb between sweeps.
+        constexpr std::chrono::milliseconds kSweepInterval(5);
+
+        class BinaryLogWriter
+        {
+        public:
+            BinaryLogWriter()
+            {
+                mOut.Write(BinaryLog::kMagic);
+                mOut.Write(BinaryLog::kVersion);
+                // One steady/system pair so the decoder can turn record times into wall time.
+                mOut.Write(static_cast<uint64_t>(Profiler::NowNs()));
+                mOut.Write(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count()));
+            }
+
+            ~BinaryLogWriter()
+            {
+                if (mFile) std::fclose(mFile);
+            }
+
+            void Open(const std::string& path)
+            {
+                mFile = std::fopen(path.c_str(), "wb");
+                if (!mFile)
+                {
+                    TG(CoreLog, Error, "Could not open binary log '{}'", path)
+                }
+            }
+
+            // Moves every committed record into the output buffer, merged across rings by
+            // timestamp so the file reads in order. Returns true when a ring was more than half
+            // full, i.e. the writer should not wait before the next sweep.
+            bool Drain(std::span<LogThreadRing* const> rings)
+            {
+                bool busy = false;
+                mCursors.clear();
+                for (LogThreadRing* ring : rings)
+                {
+                    Cursor cursor{ ring, ring->tail.load(std::memory_order_relaxed), ring->head.load(std::memory_order_acquire) };
+                    busy |= (cursor.end - cursor.pos) * 2 > ring->mask + 1;
+                    if (SkipPadding(cursor)) mCursors.push_back(cursor);
+                }
+
+                while (!mCursors.empty())
+                {
+                    size_t next = 0;
+                    for (size_t i = 1; i < mCursors.size(); ++i)
+                    {
+                        if (PeekHeader(mCursors[i]).timeNs < PeekHeader(mCursors[next]).timeNs) next = i;
+                    }
+
+                    Cursor& cursor = mCursors[next];
+                    const LogThreadRing::RecordHeader header = PeekHeader(cursor);
+                    const uint8_t* args = cursor.ring->data.get() + (cursor.pos & cursor.ring->mask) + sizeof(header);
+                    const uint32_t siteId = GetSiteId(*header.site);
+                    mOut.Write(BinaryLog::RecordKind::Message);
+                    mOut.Write(siteId);
+                    mOut.Write(header.timeNs);
+                    mOut.Write(cursor.ring->threadId);
+                    mOut.WriteBytes({ args, header.argBytes });
+                    mUrgent |= header.site->level >= spdlog::level::err;
+                    ++mWritten;
+
+                    cursor.pos += header.size;
+                    if (!SkipPadding(cursor))
+                    {
+                        cursor.ring->tail.store(cursor.pos, std::memory_order_release);
+                        mCursors.erase(mCursors.begin() + static_cast<ptrdiff_t>(next));
+                    }
+                }
+                return busy;
+            }
+
+            void NoteDropped(uint64_t dropped)
+            {
+                if (dropped == mDroppedWritten) return;
+                mOut.Write(BinaryLog::RecordKind::Dropped);
+                mOut.Write(dropped);
+                mDroppedWritten = dropped;
+            }
+
+            // Until the file is open everything stays in memory, so records from early startup
+            // are kept.
+            void WriteOut(bool flush)
+            {
+                if (!mFile) return;
+
+                const std::vector<uint8_t> bytes = mOut.TakeBuffer();
+                if (!bytes.empty())
+                {
+                    std::fwrite(bytes.data(), 1, bytes.size(), mFile);
+                }
+                if (flush || mUrgent)
+                {
+                    std::fflush(mFile);
+                    mUrgent = false;
+                }
+            }
+
+            [[nodiscard]] uint64_t GetWrittenCount() const { return mWritten; }
+
+        private:
+            struct Cursor
+            {
+                LogThreadRing* ring;
+                size_t pos;
+                size_t end;
+            };
+
+            static LogThreadRing::RecordHeader PeekHeader(const Cursor& cursor)
+            {
+                LogThreadRing::RecordHeader header;
+                std::memcpy(&header, cursor.ring->data.get() + (cursor.pos & cursor.ring->mask), sizeof(header));
+                return header;
+            }
+
+            // False once the cursor has nothing left to read.
+            static bool SkipPadding(Cursor& cursor)
+            {
+                if (cursor.pos == cursor.end) return false;
+
+                uint32_t size = 0;
+                std::memcpy(&size, cursor.ring->data.get() + (cursor.pos & cursor.ring->mask), sizeof(size));
+                if (size & LogThreadRing::kPaddingBit)
+                {
+                    cursor.pos += size & ~LogThreadRing::kPaddingBit;
+                }
+                if (cursor.pos != cursor.end) return true;
+
+                cursor.ring->tail.store(cursor.pos, std::memory_order_release);
+                return false;
+            }
+
+            uint32_t GetSiteId(const LogSite& site)
+            {
+                const auto [it, inserted] = mSiteIds.try_emplace(&site, static_cast<uint32_t>(mSiteIds.size()));
+                if (inserted)
+                {
+                    mOut.Write(BinaryLog::RecordKind::Site);
+                    mOut.Write(it->second);
+                    mOut.Write(static_cast<uint8_t>(site.level));
+                    mOut.WriteString(site.logger);
+                    mOut.WriteString(site.file);
+                    mOut.Write(site.line);
+                    mOut.WriteString(site.format);
+                }
+                return it->second;
+            }
+
+        private:
+            std::FILE* mFile = nullptr;
+            BinaryWriter mOut;
+            std::unordered_map<const LogSite*, uint32_t> mSiteIds;
+            std::vector<Cursor> mCursors;
+            uint64_t mWritten = 0;
+            uint64_t mDroppedWritten = 0;
+            bool mUrgent = false;
+        };
+
+        void WriterMain()
+        {
+            Profiler::SetThreadName("Binary Log Writer");
+            using Clock = std::chrono::steady_clock;
+            const auto flushInterval = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<float>(std::max(sState.flushIntervalSeconds, 0.001f)));
+
+            BinaryLogWriter writer;
+            std::vector<LogThreadRing*> rings;
+            auto lastFlush = Clock::now();
+            bool busy = false;
+            for (;;)
+            {
+                bool stopping;
+                std::string openPath;
+                {
+                    std::unique_lock lock(sState.mutex);
+                    if (!busy)
+                    {
+                        sState.wake.wait_for(lock, kSweepInterval, [] { return sState.stopRequested || !sState.openPath.empty(); });
+                    }
+                    stopping = sState.stopRequested;
+                    openPath = std::move(sState.openPath);
+                    sState.openPath.clear();
+
+                    // A retired ring is read once more below, after its thread's last commit.
+                    rings.clear();
+                    for (const std::unique_ptr<LogThreadRing>& ring : sState.rings)
+                    {
+                        rings.push_back(ring.get());
+                    }
+                }
+
+                // Outside the lock: a failure is logged, which may need a ring for this thread.
+                if (!openPath.empty())
+                {
+                    writer.Open(openPath);
+                }
+
+                busy = writer.Drain(rings);
+                uint64_t dropped = 0;
+                for (LogThreadRing* ring : rings)
+                {
+                    dropped += ring->dropped.load(std::memory_order_relaxed);
+                }
+                dropped += sState.droppedTotal.load(std::memory_order_relaxed);
+                writer.NoteDropped(dropped);
+
+                const auto now = Clock::now();
+                const bool flush = stopping || now - lastFlush >= flushInterval;
+                writer.WriteOut(flush);
+                if (flush)
+                {
+                    lastFlush = now;
+                    Profiler::SetCounter("Log/Binary Written", static_cast<double>(writer.GetWrittenCount()));
+                    Profiler::SetCounter("Log/Binary Dropped", static_cast<double>(dropped));
+                }
+
+                {
+                    std::lock_guard lock(sState.mutex);
+                    std::erase_if(sState.rings, [](const std::unique_ptr<LogThreadRing>& ring)
+                    {
+                        // Retired first: its last commit happens before it, so head is final after it.
+                        if (!ring->retired.load(std::memory_order_acquire)) return false;
+                        if (ring->tail.load(std::memory_order_relaxed) != ring->head.load(std::memory_order_acquire)) return false;
+                        sState.droppedTotal.fetch_add(ring->dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        return true;
+                    });
+                }
+                if (stopping) break;
+            }
+        }
+    }
+
+    void BinaryLog::Start(size_t ringBytes, float flushIntervalSeconds)
+    {
+        if (sState.thread.joinable()) return;
+
+        sState.ringBytes = std::bit_ceil(std::max<size_t>(ringBytes, 4096));
+        sState.flushIntervalSeconds = flushIntervalSeconds;
+        sState.stopRequested = false;
+        sState.thread = std::thread(WriterMain);
+        sEnabled.store(true);
+    }
+
+    void BinaryLog::Open(const std::string& path)
+    {
+        if (!sState.thread.joinable()) return;
+
+        std::lock_guard lock(sState.mutex);
+        sState.openPath = path;
+        sState.wake.notify_one();
+    }
+
+    void BinaryLog::Stop()
+    {
+        if (!sState.thread.joinable()) return;
+
+        // Calls from here on take the text path. One racing with this can still land in its
+        // ring after the last sweep and is lost, which is acceptable at exit.
+        sEnabled.store(false);
+        {
+            std::lock_guard lock(sState.mutex);
+            sState.stopRequested = true;
+            sState.wake.notify_one();
+        }
+        sState.thread.join();
+    }
+
+    uint64_t BinaryLog::GetDroppedCount()
+    {
+        std::lock_guard lock(sState.mutex);
+        uint64_t dropped = sState.droppedTotal.load(std::memory_order_relaxed);
+        for (const std::unique_ptr<LogThreadRing>& ring : sState.rings)
+        {
+            dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    detail::LogThreadRing* BinaryLog::AcquireThreadRing()
+    {
+        TG_MEMORY_TAG(Logs)
+        thread_local ThreadRingOwner owner;
+        auto ring = std::make_unique<LogThreadRing>(sState.ringBytes, static_cast<uint64_t>(spdlog::details::os::thread_id()));
+        owner.ring = ring.get();
+        tRing = ring.get();
+
+        std::lock_guard lock(sState.mutex);
+        sState.rings.push_back(std::move(ring));
+        return tRing;
+    }
+}
@@ -0,0 +1,130 @@
+﻿#include "Base/BinaryLogReader.h"
+
+#include <ctime>
+#include "spdlog/details/os.h"
+#include "spdlog/fmt/fmt.h"
+#ifdef SPDLOG_FMT_EXTERNAL
+#include <fmt/args.h>
+#else
+#include "spdlog/fmt/bundled/args.h"
+#endif
+
+#include "Base/BinaryLog.h"
+
+namespace tg
+{
+    bool BinaryLogReader::Open(const std::string& path)
+    {
+        mReader.reset();
+        mSites.clear();
+        mDropped = 0;
+        mTruncated = false;
+        if (!mFile.Open(path)) return false;
+
+        BinaryReader reader({ mFile.GetData(), mFile.GetSize() });
+        const uint32_t magic = reader.Read<uint32_t>();
+        const uint32_t version = reader.Read<uint32_t>();
+        mSteadyOriginNs = reader.Read<uint64_t>();
+        mWallOriginNs = reader.Read<int64_t>();
+        if (!reader.IsValid() || magic != BinaryLog::kMagic || version != BinaryLog::kVersion) return false;
+
+        mReader.emplace(reader);
+        return true;
+    }
+
+    bool BinaryLogReader::Next(BinaryLogEntry& entry)
+    {
+        if (!mReader) return false;
+
+        BinaryReader& reader = *mReader;
+        while (!reader.IsAtEnd())
+        {
+            switch (reader.Read<BinaryLog::RecordKind>())
+            {
+            case BinaryLog::RecordKind::Site:
+            {
+                const uint32_t id = reader.Read<uint32_t>();
+                BinaryLogSite site;
+                site.level = static_cast<spdlog::level::level_enum>(reader.Read<uint8_t>());
+                site.logger = reader.ReadString();
+                site.file = reader.ReadString();
+                site.line = reader.Read<uint32_t>();
+                site.format = reader.ReadString();
+                if (!reader.IsValid() || id != mSites.size()) break;
+
+                mSites.push_back(std::move(site));
+                continue;
+            }
+            case BinaryLog::RecordKind::Message:
+            {
+                const uint32_t siteId = reader.Read<uint32_t>();
+                const uint64_t timeNs = reader.Read<uint64_t>();
+                entry.threadId = reader.Read<uint64_t>();
+                const std::span<const uint8_t> args = reader.ReadBytes();
+                if (!reader.IsValid() || siteId >= mSites.size()) break;
+
+                entry.site = &mSites[siteId];
+                entry.wallTimeNs = mWallOriginNs + static_cast<int64_t>(timeNs - mSteadyOriginNs);
+                entry.message = Render(entry.site->format, args);
+                return true;
+            }
+            case BinaryLog::RecordKind::Dropped:
+                mDropped = reader.Read<uint64_t>();
+                if (!reader.IsValid()) break;
+                continue;
+            }
+
+            // Unknown kind or a short record: nothing after it can be trusted.
+            mTruncated = true;
+            mReader.reset();
+            return false;
+        }
+        return false;
+    }
+
+    std::string BinaryLogReader::FormatLine(const BinaryLogEntry& entry)
+    {
+        const std::time_t seconds = static_cast<std::time_t>(entry.wallTimeNs / 1'000'000'000);
+        const int64_t milliseconds = entry.wallTimeNs / 1'000'000 % 1000;
+        const std::tm time = spdlog::details::os::localtime(seconds);
+
+        const std::string& file = entry.site->file;
+        const size_t slash = file.find_last_of("/\\");
+        const std::string_view fileName = slash == std::string::npos ? std::string_view(file) : std::string_view(file).substr(slash + 1);
+
+        const spdlog::string_view_t level = spdlog::level::to_string_view(entry.site->level);
+        return fmt::format("[{:02}:{:02}:{:02}.{:03}] [{}] [{}] [{}:{}] {}",
+                           time.tm_hour, time.tm_min, time.tm_sec, milliseconds,
+                           entry.site->logger, std::string_view(level.data(), level.size()), fileName, entry.site->line,
+                           entry.message);
+    }
+
+    std::string BinaryLogReader::Render(const std::string& format, std::span<const uint8_t> args)
+    {
+        fmt::dynamic_format_arg_store<fmt::format_context> store;
+        BinaryReader reader(args);
+        while (reader.IsValid() && !reader.IsAtEnd())
+        {
+            switch (reader.Read<LogArgType>())
+            {
+            case LogArgType::Int:     store.push_back(reader.Read<int64_t>()); break;
+            case LogArgType::UInt:    store.push_back(reader.Read<uint64_t>()); break;
+            case LogArgType::Float:   store.push_back(reader.Read<double>()); break;
+            case LogArgType::Bool:    store.push_back(reader.Read<uint8_t>() != 0); break;
+            case LogArgType::Char:    store.push_back(reader.Read<char>()); break;
+            case LogArgType::String:  store.push_back(reader.ReadString()); break;
+            case LogArgType::Pointer: store.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(reader.Read<uint64_t>()))); break;
+            default:                  return fmt::format("{} <unknown argument type>", format);
+            }
+        }
+
+        try
+        {
+            return fmt::vformat(format, store);
+        }
+        catch (const fmt::format_error& error)
+        {
+            return fmt::format("{} <{}>", format, error.what());
+        }
+    }
+}
@@ -0,0 +1,10 @@
+﻿#include "Base/EventQueue.h"
+
+namespace tg
+{
+    EventQueue& EventQueue::Get()
+    {
+        static EventQueue instance;
+        return instance;
+    }
+}
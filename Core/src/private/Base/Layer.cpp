@@ -1,4 +1,5 @@
 ﻿#include "Base/Layer.h"
+#include <algorithm>
 #include <ranges>
 #include <utility>
 
@@ -18,11 +19,13 @@ namespace tg
     void LayerStack::PushLayer(Layer *layer) {
         mLayers.emplace(mLayers.begin() + mLayerInsertIndex, layer);
         mLayerInsertIndex++;
+        mCacheValid = false;
         layer->OnAttach();
     }
 
     void LayerStack::PushOverlay(Layer *overlay) {
         mLayers.emplace_back(overlay);
+        mCacheValid = false;
         overlay->OnAttach();
     }
 
@@ -34,6 +37,7 @@ namespace tg
             layer->OnDetach();
             mLayers.erase(it);
             mLayerInsertIndex--;
+            mCacheValid = false;
         }
     }
 
@@ -44,6 +48,44 @@ namespace tg
         {
             overlay->OnDetach();
             mLayers.erase(it);
+            mCacheValid = false;
         }
     }
+
+    const std::vector<Layer*>& LayerStack::GetActiveLayers() {
+        RefreshCache();
+        return mActiveLayers;
+    }
+
+    const std::vector<Layer*>& LayerStack::GetVisibleLayers() {
+        RefreshCache();
+        return mVisibleLayers;
+    }
+
+    const std::vector<Layer*>& LayerStack::GetEventLayers() {
+        RefreshCache();
+        return mEventLayers;
+    }
+
+    void LayerStack::RefreshCache() {
+        if (mCacheValid && mCacheGeneration == Layer::GetStateGeneration()) return;
+
+        mActiveLayers.clear();
+        mVisibleLayers.clear();
+        for (Layer* layer : mLayers)
+        {
+            if (!layer || !layer->IsActive()) continue;
+            mActiveLayers.push_back(layer);
+            if (layer->IsVisible())
+            {
+                mVisibleLayers.push_back(layer);
+            }
+        }
+
+        mEventLayers.assign(mVisibleLayers.rbegin(), mVisibleLayers.rend());
+        std::ranges::stable_sort(mEventLayers, std::ranges::greater{}, &Layer::GetEventPriority);
+
+        mCacheGeneration = Layer::GetStateGeneration();
+        mCacheValid = true;
+    }
 }
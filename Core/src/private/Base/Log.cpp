@@ -1,52 +1,219 @@
 ﻿#include "Base/Log.h"
 
 
+#include <charconv>
+#include <cstring>
 #include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "spdlog/details/file_helper.h"
+#include "spdlog/sinks/base_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
-#include "spdlog/sinks/basic_file_sink.h"
+
+#include "Base/App.h"
+#include "Base/AsyncLogSink.h"
+#include "Base/LogRing.h"
+#include "Memory/AllocationTracker.h"
 
 
 namespace tg {
 
+    namespace
+    {
+        // File sink that exists before its file is opened: messages logged until Open() are
+        // formatted into memory and written first, so none are lost while startup opens it.
+        class DeferredFileSink final : public spdlog::sinks::base_sink<std::mutex>
+        {
+        public:
+            void Open(const spdlog::filename_t& path)
+            {
+                std::lock_guard lock(mutex_);
+                mFile.open(path, true);
+                mFile.write(mPending);
+                mPending.clear();
+                mOpen = true;
+            }
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg& msg) override
+            {
+                if (!mOpen)
+                {
+                    formatter_->format(msg, mPending);
+                    return;
+                }
+                spdlog::memory_buf_t formatted;
+                formatter_->format(msg, formatted);
+                mFile.write(formatted);
+            }
+
+            void flush_() override
+            {
+                if (mOpen) mFile.flush();
+            }
+
+        private:
+            spdlog::details::file_helper mFile;
+            spdlog::memory_buf_t mPending;
+            bool mOpen = false;
+        };
+
+        std::shared_ptr<DeferredFileSink> sCoreFileSink;
+        std::shared_ptr<DeferredFileSink> sLayerFileSink;
+        std::shared_ptr<AsyncLogWriter> sWriter;
+        std::shared_ptr<LogRing> sRing;
+
+        // LogConfig is read before the loggers exist; Init() logs these once they do.
+        std::vector<std::string> sConfigWarnings;
+
+        // Leaves value as it is unless the whole argument is a number of at least minimum.
+        template<typename T>
+        void ReadNumberArg(const CommandLineArgs& args, const char* flag, T& value, T minimum)
+        {
+            const char* text = args.GetValue(flag);
+            if (!text) return;
+
+            const char* end = text + std::strlen(text);
+            T parsed{};
+            const auto [ptr, ec] = std::from_chars(text, end, parsed);
+            if (ec == std::errc() && ptr == end && parsed >= minimum)
+            {
+                value = parsed;
+            }
+            else
+            {
+                sConfigWarnings.push_back(fmt::format("Ignoring {} '{}': expected a number of at least {}, keeping {}",
+                                                      flag, text, minimum, value));
+            }
+        }
+
+        std::shared_ptr<spdlog::logger> MakeLogger(const char* name, const char* displayName, std::vector<spdlog::sink_ptr> sinks)
+        {
+            if (sRing)
+            {
+                sinks.push_back(std::make_shared<LogRingSink>(sRing, sRing->AddLogger(displayName)));
+            }
+
+            std::shared_ptr<spdlog::logger> logger;
+            if (sWriter)
+            {
+                // Flushing is the writer's job: on its timer and after errors.
+                logger = std::make_shared<spdlog::logger>(name, std::make_shared<AsyncLogSink>(sWriter, std::move(sinks)));
+            }
+            else
+            {
+                logger = std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+                logger->flush_on(spdlog::level::trace);
+            }
+            logger->set_level(spdlog::level::trace);
+            return logger;
+        }
+    }
+
+    LogConfig LogConfig::FromCommandLine()
+    {
+        const CommandLineArgs& args = App::GetCommandLineArgs();
+        LogConfig config;
+        config.async = !args.HasFlag("--sync-log");
+
+        ReadNumberArg(args, "--log-queue", config.queueCapacity, size_t{1});
+        if (const char* overflow = args.GetValue("--log-overflow"))
+        {
+            const std::string_view policy(overflow);
+            if (policy == "block")
+                config.overflow = LogOverflowPolicy::Block;
+            else if (policy == "drop-oldest")
+                config.overflow = LogOverflowPolicy::DropOldest;
+            else if (policy == "drop-newest")
+                config.overflow = LogOverflowPolicy::DropNewest;
+            else
+                sConfigWarnings.push_back(fmt::format("Ignoring --log-overflow '{}': expected block, drop-oldest or drop-newest", policy));
+        }
+        int flushMs = static_cast<int>(config.flushIntervalSeconds * 1000.0f);
+        ReadNumberArg(args, "--log-flush-ms", flushMs, 1);
+        config.flushIntervalSeconds = static_cast<float>(flushMs) / 1000.0f;
+        ReadNumberArg(args, "--log-view-lines", config.viewerLines, size_t{0});
+        config.binary = args.HasFlag("--binary-log");
+        ReadNumberArg(args, "--binary-log-ring", config.binaryRingBytes, size_t{4096});
+        return config;
+    }
+
     std::shared_ptr<spdlog::logger> Log::sCoreLogger;
     std::shared_ptr<spdlog::logger> Log::sLayerLogger;
 
 
-    void Log::Init() {
-        //TODO: Проверь если папка уже создана , незачем вызывать эту команду снова
-        //TODO: FIX На данный момент логи создаются в sandbox папке для Core и Layer
-        std::filesystem::create_directories("logs");
+    void Log::Init(const LogConfig& config) {
+        TG_MEMORY_TAG(Logs)
+        if (config.async)
+        {
+            sWriter = std::make_shared<AsyncLogWriter>(config);
+        }
+        if (config.viewerLines > 0)
+        {
+            sRing = std::make_shared<LogRing>(config.viewerLines);
+        }
+        if (config.binary)
+        {
+            BinaryLog::Start(config.binaryRingBytes, config.flushIntervalSeconds);
+        }
 
         // ----- Core Logger (Core) -----
         auto coreConsoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
         // Pattern: time, logger name, source file and line, then the message.
         coreConsoleSink->set_pattern("%^[%T] [Core] [%s:%#] %v%$");
 
-        auto coreFileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/Core.log", true);
+        auto coreFileSink = sCoreFileSink = std::make_shared<DeferredFileSink>();
         coreFileSink->set_pattern("[%T] [Core] [%s:%#] %v");
 
-        std::vector<spdlog::sink_ptr> coreSinks { coreConsoleSink, coreFileSink };
-        sCoreLogger = std::make_shared<spdlog::logger>("Engine", coreSinks.begin(), coreSinks.end());
-        sCoreLogger->set_level(spdlog::level::trace);
-        sCoreLogger->flush_on(spdlog::level::trace);
+        sCoreLogger = MakeLogger("Engine", "Core", { coreConsoleSink, coreFileSink });
 
         // ----- Layer Logger -----
         auto layerConsoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
         layerConsoleSink->set_pattern("%^[%T] [Layer] [%s:%#] %v%$");
 
-        auto layerFileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/Layer.log", true);
+        auto layerFileSink = sLayerFileSink = std::make_shared<DeferredFileSink>();
         layerFileSink->set_pattern("[%T] [Layer] [%s:%#] %v");
 
-        std::vector<spdlog::sink_ptr> layerSinks { layerConsoleSink, layerFileSink };
-        sLayerLogger = std::make_shared<spdlog::logger>("Layer", layerSinks.begin(), layerSinks.end());
-        sLayerLogger->set_level(spdlog::level::trace);
-        sLayerLogger->flush_on(spdlog::level::trace);
-        
+        sLayerLogger = MakeLogger("Layer", "Layer", { layerConsoleSink, layerFileSink });
+
+        for (const std::string& warning : sConfigWarnings)
+        {
+            TG(CoreLog, Warn, "{}", warning)
+        }
+        sConfigWarnings.clear();
+    }
+
+    void Log::OpenFiles() {
+        //TODO: Проверь если папка уже создана , незачем вызывать эту команду снова
+        //TODO: FIX На данный момент логи создаются в sandbox папке для Core и Layer
+        std::filesystem::create_directories("logs");
+        sCoreFileSink->Open("logs/Core.log");
+        sLayerFileSink->Open("logs/Layer.log");
+        BinaryLog::Open("logs/Log.tgbl");
     }
 
     void Log::Shutdown() {
+        BinaryLog::Stop();
+        if (sWriter)
+        {
+            sWriter->Stop();
+        }
+        sCoreFileSink.reset();
+        sLayerFileSink.reset();
         sCoreLogger.reset();
         sLayerLogger.reset();
         spdlog::drop_all();
+        sWriter.reset();
+        sRing.reset();
+    }
+
+    LogRing* Log::GetRing() {
+        return sRing.get();
+    }
+
+    uint64_t Log::GetDroppedCount() {
+        return (sWriter ? sWriter->GetDroppedCount() : 0) + BinaryLog::GetDroppedCount();
     }
 }
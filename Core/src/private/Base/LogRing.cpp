@@ -0,0 +1,106 @@
+﻿#include "Base/LogRing.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Memory/AllocationTracker.h"
+
+namespace tg
+{
+    namespace
+    {
+        uint64_t Load(const uint64_t& word, std::memory_order order = std::memory_order_relaxed)
+        {
+            return std::atomic_ref(const_cast<uint64_t&>(word)).load(order);
+        }
+
+        void Store(uint64_t& word, uint64_t value, std::memory_order order = std::memory_order_relaxed)
+        {
+            std::atomic_ref(word).store(value, order);
+        }
+    }
+
+    LogRing::LogRing(size_t capacity)
+    {
+        capacity = std::bit_ceil(std::max<size_t>(capacity, 2));
+        const size_t bytes = capacity * sizeof(Slot);
+        mSlots = { static_cast<Slot*>(std::calloc(capacity, sizeof(Slot))), FreeDeleter{ bytes } };
+        if (!mSlots) throw std::bad_alloc();
+        AllocationTracker::RecordExternal(MemoryTag::Logs, static_cast<int64_t>(bytes));
+        mMask = capacity - 1;
+    }
+
+    void LogRing::FreeDeleter::operator()(Slot* slots) const
+    {
+        std::free(slots);
+        AllocationTracker::RecordExternal(MemoryTag::Logs, -static_cast<int64_t>(bytes));
+    }
+
+    uint8_t LogRing::AddLogger(std::string name)
+    {
+        mLoggerNames.push_back(std::move(name));
+        return static_cast<uint8_t>(mLoggerNames.size() - 1);
+    }
+
+    void LogRing::Push(uint8_t logger, const spdlog::details::log_msg& msg)
+    {
+        const uint64_t index = mHead.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = mSlots[index & mMask];
+
+        uint64_t text[kTextWords];
+        size_t size = std::min(msg.payload.size(), LogLine::kMaxText);
+        if (size > 0) text[(size - 1) / 8] = 0;
+        std::memcpy(text, msg.payload.data(), size);
+        if (size < msg.payload.size())
+        {
+            // Cut at a UTF-8 boundary so the viewer never draws half a character.
+            const auto* bytes = reinterpret_cast<const unsigned char*>(msg.payload.data());
+            while (size > 0 && (bytes[size] & 0xC0) == 0x80) --size;
+        }
+
+        Store(slot.sequence, 2 * index + 1);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const int64_t timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+        const uint64_t line = msg.source.line > 0 ? static_cast<uint64_t>(msg.source.line) : 0;
+        Store(slot.timeNs, static_cast<uint64_t>(timeNs));
+        Store(slot.file, reinterpret_cast<uintptr_t>(msg.source.filename));
+        Store(slot.meta, static_cast<uint64_t>(msg.level) | uint64_t{logger} << 8 | uint64_t{size} << 16 | line << 32);
+        for (size_t i = 0, words = (size + 7) / 8; i < words; ++i)
+        {
+            Store(slot.text[i], text[i]);
+        }
+
+        Store(slot.sequence, 2 * index + 2, std::memory_order_release);
+    }
+
+    bool LogRing::Read(uint64_t index, LogLine& out) const
+    {
+        const Slot& slot = mSlots[index & mMask];
+        const uint64_t sequence = Load(slot.sequence, std::memory_order_acquire);
+        if (sequence != 2 * index + 2) return false;
+
+        const uint64_t meta = Load(slot.meta);
+        out.index = index;
+        out.timeNs = static_cast<int64_t>(Load(slot.timeNs));
+        out.file = reinterpret_cast<const char*>(static_cast<uintptr_t>(Load(slot.file)));
+        out.level = static_cast<spdlog::level::level_enum>(meta & 0xFF);
+        out.logger = static_cast<uint8_t>(meta >> 8);
+        out.size = static_cast<uint16_t>(std::min<uint64_t>((meta >> 16) & 0xFFFF, LogLine::kMaxText));
+        out.line = static_cast<uint32_t>(meta >> 32);
+
+        uint64_t text[kTextWords];
+        for (size_t i = 0, words = (out.size + 7) / 8; i < words; ++i)
+        {
+            text[i] = Load(slot.text[i]);
+        }
+        std::memcpy(out.text, text, out.size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return Load(slot.sequence) == sequence;
+    }
+}
@@ -0,0 +1,102 @@
+﻿#include "Base/MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tg
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& path)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        mFile = file;
+        mMapping = mapping;
+        mData = data;
+        mSize = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (mData) UnmapViewOfFile(mData);
+        if (mMapping) CloseHandle(mMapping);
+        if (mFile) CloseHandle(mFile);
+        mData = nullptr;
+        mMapping = nullptr;
+        mFile = nullptr;
+        mSize = 0;
+    }
+#else
+    bool MappedFile::Open(const std::string& path)
+    {
+        Close();
+
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file.
+        close(fd);
+        if (data == MAP_FAILED) return false;
+
+        mData = data;
+        mSize = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (mData) munmap(mData, mSize);
+        mData = nullptr;
+        mSize = 0;
+    }
+#endif
+}
@@ -0,0 +1,191 @@
+﻿#include "Base/Startup.h"
+
+#include <algorithm>
+
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    namespace
+    {
+        const uint64_t sProcessStartNs = Profiler::NowNs();
+
+        double ToMilliseconds(uint64_t ns)
+        {
+            return static_cast<double>(ns) / 1'000'000.0;
+        }
+    }
+
+    uint64_t StartupSequence::GetProcessStartNs()
+    {
+        return sProcessStartNs;
+    }
+
+    void StartupSequence::Add(std::string name, StartupThread thread, std::function<void()> fn,
+                              std::initializer_list<std::string_view> dependsOn)
+    {
+        Phase& phase = mPhases.emplace_back();
+        phase.name = std::move(name);
+        phase.thread = thread;
+        phase.fn = std::move(fn);
+        for (std::string_view dependency : dependsOn)
+        {
+            phase.dependencyNames.emplace_back(dependency);
+        }
+    }
+
+    void StartupSequence::AddDependency(std::string_view phase, std::string_view dependsOn)
+    {
+        const size_t index = Find(phase);
+        if (index == mPhases.size())
+        {
+            TG(CoreLog, Warn, "Startup phase '{}' does not exist; dependency on '{}' ignored", phase, dependsOn)
+            return;
+        }
+        mPhases[index].dependencyNames.emplace_back(dependsOn);
+    }
+
+    void StartupSequence::Run()
+    {
+        TG_PROFILE_FUNCTION()
+        mRunStartNs = Profiler::NowNs();
+
+        for (size_t i = 0; i < mPhases.size(); ++i)
+        {
+            Phase& phase = mPhases[i];
+            for (const std::string& name : phase.dependencyNames)
+            {
+                const size_t dependency = Find(name);
+                if (dependency == mPhases.size() || dependency == i)
+                {
+                    TG(CoreLog, Warn, "Startup phase '{}' depends on unknown phase '{}'; ignored", phase.name, name)
+                    continue;
+                }
+                if (phase.thread == StartupThread::Main && mPhases[dependency].thread == StartupThread::Main && dependency > i)
+                {
+                    TG(CoreLog, Error, "Startup phase '{}' depends on '{}', which runs after it on the main thread; ignored",
+                       phase.name, name)
+                    continue;
+                }
+                phase.dependencies.push_back(dependency);
+            }
+        }
+
+        ScheduleReadyWorkers();
+        for (Phase& phase : mPhases)
+        {
+            if (phase.thread != StartupThread::Main) continue;
+
+            const uint64_t waitStart = Profiler::NowNs();
+            for (size_t dependency : phase.dependencies)
+            {
+                Phase& other = mPhases[dependency];
+                if (other.thread == StartupThread::Worker && !other.scheduled)
+                {
+                    // Only reachable through a cycle of worker phases; run it here rather than hang.
+                    TG(CoreLog, Warn, "Startup phase '{}' has unresolved dependencies; running it inline", other.name)
+                    RunPhase(other);
+                    other.scheduled = true;
+                }
+                JobSystem::Get().Wait(other.job);
+            }
+            phase.waitNs = Profiler::NowNs() - waitStart;
+
+            RunPhase(phase);
+            phase.scheduled = true;
+            ScheduleReadyWorkers();
+        }
+
+        for (Phase& phase : mPhases)
+        {
+            if (!phase.scheduled)
+            {
+                TG(CoreLog, Warn, "Startup phase '{}' has unresolved dependencies; running it inline", phase.name)
+                RunPhase(phase);
+                phase.scheduled = true;
+            }
+            JobSystem::Get().Wait(phase.job);
+        }
+        mRunEndNs = Profiler::NowNs();
+    }
+
+    void StartupSequence::LogReport(uint64_t firstFrameNs) const
+    {
+        const uint64_t origin = sProcessStartNs;
+        uint64_t mainWaitNs = 0;
+        for (const Phase& phase : mPhases)
+        {
+            mainWaitNs += phase.waitNs;
+        }
+
+        TG(CoreLog, Info, "Startup: first frame at {:.1f} ms; phases {:.1f} .. {:.1f} ms, main thread waited {:.1f} ms on workers",
+           ToMilliseconds(firstFrameNs - origin), ToMilliseconds(mRunStartNs - origin), ToMilliseconds(mRunEndNs - origin),
+           ToMilliseconds(mainWaitNs))
+
+        std::vector<const Phase*> byStart;
+        byStart.reserve(mPhases.size());
+        for (const Phase& phase : mPhases)
+        {
+            byStart.push_back(&phase);
+        }
+        std::ranges::stable_sort(byStart, {}, &Phase::startNs);
+
+        for (const Phase* phase : byStart)
+        {
+            TG(CoreLog, Info, "  {:<12} {:<6} {:8.1f} .. {:8.1f} ms  {:7.1f} ms{}",
+               phase->name, phase->thread == StartupThread::Main ? "main" : "worker",
+               ToMilliseconds(phase->startNs - origin), ToMilliseconds(phase->endNs - origin),
+               ToMilliseconds(phase->endNs - phase->startNs),
+               phase->waitNs >= 100'000 ? fmt::format(" (waited {:.1f} ms)", ToMilliseconds(phase->waitNs)) : std::string())
+        }
+
+        Profiler::SetCounter("Startup/First Frame (ms)", ToMilliseconds(firstFrameNs - origin));
+    }
+
+    size_t StartupSequence::Find(std::string_view name) const
+    {
+        for (size_t i = 0; i < mPhases.size(); ++i)
+        {
+            if (mPhases[i].name == name) return i;
+        }
+        return mPhases.size();
+    }
+
+    void StartupSequence::ScheduleReadyWorkers()
+    {
+        // Worker phases may depend on each other in any order, so sweep until nothing changes.
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+            for (Phase& phase : mPhases)
+            {
+                if (phase.thread != StartupThread::Worker || phase.scheduled) continue;
+
+                std::vector<JobHandle> dependencies;
+                const bool ready = std::ranges::all_of(phase.dependencies, [&](size_t dependency)
+                {
+                    const Phase& other = mPhases[dependency];
+                    if (!other.scheduled) return false;
+                    if (other.job.IsValid()) dependencies.push_back(other.job);
+                    return true;
+                });
+                if (!ready) continue;
+
+                Phase* target = &phase;
+                phase.job = JobSystem::Get().Schedule([this, target] { RunPhase(*target); }, JobPriority::High, dependencies);
+                phase.scheduled = true;
+                progress = true;
+            }
+        }
+    }
+
+    void StartupSequence::RunPhase(Phase& phase)
+    {
+        TG_PROFILE_SCOPE("StartupPhase")
+        phase.startNs = Profiler::NowNs();
+        phase.fn();
+        phase.endNs = Profiler::NowNs();
+    }
+}
@@ -0,0 +1,292 @@
+﻿#include "Base/TimerService.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    namespace
+    {
+        // Rounded up, so a timer never fires before its deadline.
+        uint64_t ToTick(uint64_t ns)
+        {
+            return (ns + TimerService::kTickNs - 1) / TimerService::kTickNs;
+        }
+
+        uint64_t ToTicks(std::chrono::nanoseconds duration)
+        {
+            return ToTick(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+        }
+    }
+
+    TimerService& TimerService::Get()
+    {
+        static TimerService instance;
+        return instance;
+    }
+
+    TimerService::TimerService()
+        : mCurrentTick(Profiler::NowNs() / kTickNs), mTargetTick(mCurrentTick)
+    {
+        std::fill(std::begin(mHeads), std::end(mHeads), kNil);
+    }
+
+    TimerHandle TimerService::Schedule(std::chrono::nanoseconds delay, std::function<void()> fn)
+    {
+        return Add(ToTick(Profiler::NowNs()) + ToTicks(delay), 0, std::move(fn));
+    }
+
+    TimerHandle TimerService::ScheduleAt(uint64_t deadlineNs, std::function<void()> fn)
+    {
+        return Add(ToTick(deadlineNs), 0, std::move(fn));
+    }
+
+    TimerHandle TimerService::ScheduleRepeating(std::chrono::nanoseconds interval, std::function<void()> fn)
+    {
+        const uint64_t intervalTicks = std::max<uint64_t>(ToTicks(interval), 1);
+        return Add(ToTick(Profiler::NowNs()) + intervalTicks, intervalTicks, std::move(fn));
+    }
+
+    bool TimerService::Reschedule(TimerHandle handle, std::chrono::nanoseconds delay)
+    {
+        if (!Resolve(handle)) return false;
+
+        // A repeating timer rescheduled from its own callback keeps the new deadline.
+        Unlink(handle.index);
+        mNodes[handle.index].deadlineTick = std::max(ToTick(Profiler::NowNs()) + ToTicks(delay), mCurrentTick + 1);
+        Link(handle.index);
+        return true;
+    }
+
+    bool TimerService::Cancel(TimerHandle handle)
+    {
+        if (!Resolve(handle)) return false;
+
+        Unlink(handle.index);
+        Release(handle.index);
+        return true;
+    }
+
+    bool TimerService::IsActive(TimerHandle handle) const
+    {
+        return Resolve(handle) != nullptr;
+    }
+
+    uint32_t TimerService::Advance(uint64_t nowNs)
+    {
+        TG_PROFILE_FUNCTION()
+        mFiredThisAdvance = 0;
+
+        const uint64_t targetTick = nowNs / kTickNs;
+        mTargetTick = std::max(targetTick, mCurrentTick);
+        while (mCurrentTick < targetTick)
+        {
+            // Empty stretches of the wheel are skipped rather than walked tick by tick.
+            const uint64_t nextTick = mActiveCount > 0 ? FindNextTick() : UINT64_MAX;
+            if (nextTick > targetTick)
+            {
+                mCurrentTick = targetTick;
+                break;
+            }
+            mCurrentTick = nextTick;
+            ProcessTick(nextTick);
+        }
+
+        Profiler::SetCounter("Timers/Active", static_cast<double>(mActiveCount));
+        Profiler::SetCounter("Timers/Fired", mFiredThisAdvance);
+        return mFiredThisAdvance;
+    }
+
+    uint64_t TimerService::GetNextDeadlineNs() const
+    {
+        if (mActiveCount == 0) return UINT64_MAX;
+
+        const uint64_t tick = FindNextTick();
+        return tick == UINT64_MAX ? UINT64_MAX : tick * kTickNs;
+    }
+
+    TimerHandle TimerService::Add(uint64_t deadlineTick, uint64_t intervalTicks, std::function<void()> fn)
+    {
+        uint32_t index;
+        if (mFreeHead != kNil)
+        {
+            index = mFreeHead;
+            mFreeHead = mNodes[index].next;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(mNodes.size());
+            mNodes.emplace_back();
+        }
+
+        Node& node = mNodes[index];
+        node.fn = std::move(fn);
+        node.deadlineTick = std::max(deadlineTick, mCurrentTick + 1);
+        node.intervalTicks = intervalTicks;
+        Link(index);
+        ++mActiveCount;
+        return {index, node.generation};
+    }
+
+    void TimerService::Release(uint32_t index)
+    {
+        Node& node = mNodes[index];
+        node.fn = nullptr;
+        node.list = kNoList;
+        node.prev = kNil;
+        node.next = mFreeHead;
+        ++node.generation;
+        mFreeHead = index;
+        --mActiveCount;
+    }
+
+    void TimerService::Link(uint32_t index)
+    {
+        Node& node = mNodes[index];
+
+        // The level is picked by distance from now; beyond the top level the timer parks in
+        // the farthest slot and is re-filed when that slot cascades.
+        const uint64_t delta = node.deadlineTick > mCurrentTick ? node.deadlineTick - mCurrentTick : 0;
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (uint64_t{1} << (kSlotBits * (level + 1))))
+        {
+            ++level;
+        }
+        constexpr uint64_t kHorizon = (uint64_t{1} << (kSlotBits * kLevels)) - 1;
+        const uint64_t placement = mCurrentTick + std::min(delta, kHorizon);
+        const uint32_t slot = static_cast<uint32_t>(placement >> (kSlotBits * level)) & kSlotMask;
+
+        const uint32_t list = level * kSlots + slot;
+        node.list = static_cast<uint16_t>(list);
+        node.prev = kNil;
+        node.next = mHeads[list];
+        if (node.next != kNil)
+        {
+            mNodes[node.next].prev = index;
+        }
+        mHeads[list] = index;
+        mOccupied[level][slot / 64] |= uint64_t{1} << (slot % 64);
+    }
+
+    void TimerService::Unlink(uint32_t index)
+    {
+        Node& node = mNodes[index];
+        if (node.list == kNoList || node.list == kFiring) return;
+
+        if (node.prev != kNil)
+            mNodes[node.prev].next = node.next;
+        else
+            mHeads[node.list] = node.next;
+        if (node.next != kNil)
+            mNodes[node.next].prev = node.prev;
+
+        if (mHeads[node.list] == kNil)
+        {
+            const uint32_t level = node.list / kSlots;
+            const uint32_t slot = node.list % kSlots;
+            mOccupied[level][slot / 64] &= ~(uint64_t{1} << (slot % 64));
+        }
+        node.list = kNoList;
+        node.prev = kNil;
+        node.next = kNil;
+    }
+
+    const TimerService::Node* TimerService::Resolve(TimerHandle handle) const
+    {
+        if (handle.index >= mNodes.size()) return nullptr;
+
+        const Node& node = mNodes[handle.index];
+        return (node.generation == handle.generation && node.list != kNoList) ? &node : nullptr;
+    }
+
+    void TimerService::ProcessTick(uint64_t tick)
+    {
+        // At each wrap of a level, the next level's slot for the new block moves down.
+        for (int level = 1; level < kLevels; ++level)
+        {
+            if ((tick & ((uint64_t{1} << (kSlotBits * level)) - 1)) != 0) break;
+            Cascade(level, static_cast<uint32_t>(tick >> (kSlotBits * level)) & kSlotMask);
+        }
+
+        const uint32_t list = static_cast<uint32_t>(tick) & kSlotMask;
+        // Popped one at a time: a callback may cancel other timers in this same slot.
+        while (mHeads[list] != kNil)
+        {
+            Fire(mHeads[list]);
+        }
+    }
+
+    void TimerService::Cascade(int level, uint32_t slot)
+    {
+        const uint32_t list = level * kSlots + slot;
+        while (mHeads[list] != kNil)
+        {
+            const uint32_t index = mHeads[list];
+            Unlink(index);
+            Link(index);
+        }
+    }
+
+    void TimerService::Fire(uint32_t index)
+    {
+        Unlink(index);
+        ++mFiredThisAdvance;
+
+        // Moved out: the callback may add timers and reallocate mNodes.
+        std::function<void()> fn = std::move(mNodes[index].fn);
+        if (mNodes[index].intervalTicks == 0)
+        {
+            Release(index);
+            fn();
+            return;
+        }
+
+        const uint32_t generation = mNodes[index].generation;
+        mNodes[index].list = kFiring;
+        fn();
+
+        Node& node = mNodes[index];
+        if (node.generation != generation) return; // cancelled by its own callback
+
+        node.fn = std::move(fn);
+        if (node.list == kFiring)
+        {
+            // Next multiple of the interval after the time being caught up to, so intervals
+            // missed while the app was asleep are skipped rather than replayed.
+            const uint64_t missed = (mTargetTick - node.deadlineTick) / node.intervalTicks;
+            node.deadlineTick += (missed + 1) * node.intervalTicks;
+            Link(index);
+        }
+    }
+
+    uint64_t TimerService::FindNextTick() const
+    {
+        uint64_t best = UINT64_MAX;
+        for (int level = 0; level < kLevels; ++level)
+        {
+            const int shift = kSlotBits * level;
+            const uint64_t block = mCurrentTick >> shift;
+
+            // First occupied slot after the current one, wrapping around the level.
+            const uint32_t start = static_cast<uint32_t>(block + 1) & kSlotMask;
+            for (uint32_t distance = 0; distance < kSlots;)
+            {
+                const uint32_t slot = (start + distance) & kSlotMask;
+                const uint64_t bits = mOccupied[level][slot / 64] >> (slot % 64);
+                if (bits != 0)
+                {
+                    const uint32_t found = distance + static_cast<uint32_t>(std::countr_zero(bits));
+                    if (found < kSlots)
+                    {
+                        best = std::min(best, (block + 1 + found) << shift);
+                    }
+                    break;
+                }
+                distance += 64 - slot % 64;
+            }
+        }
+        return best;
+    }
+}
@@ -1,17 +1,72 @@
 ﻿#include "Base/Window.h"
+#include "Base/EventQueue.h"
 #include "Base/Log.h"
 #include "glad/glad.h"
 #include <glfw/glfw3.h>
+#include <atomic>
 namespace tg
 {
     namespace
     {
-        uint32_t sGLFWWindowCount = 0;
+        // Atomic because Wake() checks it from other threads.
+        std::atomic<uint32_t> sGLFWWindowCount = 0;
+        bool sPlatformInitialized = false;
 
         void GLFWErrorCallback(int error, const char* description)
         {
             TG(CoreLog,Error,"GLFW Error ({0}): {1}", error, description)
         }
+
+        // ImGui's GLFW backend is initialized later and chains to these, so both see the input.
+        void InstallEventCallbacks(GLFWwindow* window)
+        {
+            glfwSetWindowCloseCallback(window, [](GLFWwindow*)
+            {
+                EventQueue::Get().Push(WindowCloseEvent{});
+            });
+            glfwSetWindowSizeCallback(window, [](GLFWwindow*, int width, int height)
+            {
+                EventQueue::Get().Push(WindowResizeEvent{static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
+            });
+            glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int width, int height)
+            {
+                EventQueue::Get().Push(FramebufferResizeEvent{static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
+            });
+            glfwSetWindowFocusCallback(window, [](GLFWwindow*, int focused)
+            {
+                EventQueue::Get().Push(WindowFocusEvent{focused == GLFW_TRUE});
+            });
+            glfwSetWindowContentScaleCallback(window, [](GLFWwindow*, float x, float y)
+            {
+                EventQueue::Get().Push(WindowContentScaleEvent{x, y});
+            });
+            glfwSetKeyCallback(window, [](GLFWwindow*, int key, int, int action, int mods)
+            {
+                if (action == GLFW_RELEASE)
+                    EventQueue::Get().Push(KeyReleasedEvent{key, mods});
+                else
+                    EventQueue::Get().Push(KeyPressedEvent{key, mods, action == GLFW_REPEAT});
+            });
+            glfwSetCharCallback(window, [](GLFWwindow*, unsigned int codepoint)
+            {
+                EventQueue::Get().Push(KeyTypedEvent{codepoint});
+            });
+            glfwSetMouseButtonCallback(window, [](GLFWwindow*, int button, int action, int mods)
+            {
+                if (action == GLFW_PRESS)
+                    EventQueue::Get().Push(MouseButtonPressedEvent{button, mods});
+                else
+                    EventQueue::Get().Push(MouseButtonReleasedEvent{button, mods});
+            });
+            glfwSetCursorPosCallback(window, [](GLFWwindow*, double x, double y)
+            {
+                EventQueue::Get().Push(MouseMovedEvent{static_cast<float>(x), static_cast<float>(y)});
+            });
+            glfwSetScrollCallback(window, [](GLFWwindow*, double xOffset, double yOffset)
+            {
+                EventQueue::Get().Push(MouseScrolledEvent{static_cast<float>(xOffset), static_cast<float>(yOffset)});
+            });
+        }
         
     }
     
@@ -20,17 +75,42 @@ namespace tg
         Shutdown();
     }
 
+    void Window::InitPlatform(Mode mode)
+    {
+        if (sPlatformInitialized) return;
+
+        if (mode == Mode::Headless)
+        {
+            // The null platform needs no display server, so this works on CI boxes.
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+        if (!glfwInit()) {
+            const char* description;
+            glfwGetError(&description);
+            TG(CoreLog, Error, "GLFW Init Error: {}", description);
+            throw std::runtime_error("Could not initialize GLFW");
+        }
+        glfwSetErrorCallback(GLFWErrorCallback);
+        sPlatformInitialized = true;
+    }
+
+    float Window::GetPrimaryContentScale()
+    {
+        GLFWmonitor* monitor = sPlatformInitialized ? glfwGetPrimaryMonitor() : nullptr;
+        if (!monitor) return 1.0f;
+
+        float scale = 1.0f;
+        glfwGetMonitorContentScale(monitor, &scale, nullptr);
+        return scale > 0.0f ? scale : 1.0f;
+    }
+
     void Window::Init()
     {
-        if (sGLFWWindowCount == 0)
+        InitPlatform(mConfig.mode);
+        if (mConfig.mode == Mode::Headless)
         {
-            if (!glfwInit()) {
-                const char* description;
-                glfwGetError(&description);
-                TG(CoreLog, Error, "GLFW Init Error: {}", description);
-                throw std::runtime_error("Could not initialize GLFW");
-            }
-            glfwSetErrorCallback(GLFWErrorCallback);
+            InitHeadless();
+            return;
         }
 
         if (mConfig.dimensions.startPosX > 0 || mConfig.dimensions.startPosY > 0)
@@ -87,6 +167,53 @@ namespace tg
         }
         ++sGLFWWindowCount;
 
+        InitContext();
+
+        glfwSetWindowUserPointer(mWindow, this);
+        InstallEventCallbacks(mWindow);
+    }
+
+    void Window::InitHeadless()
+    {
+        const int width = static_cast<int>(mConfig.dimensions.width);
+        const int height = static_cast<int>(mConfig.dimensions.height);
+
+        TG(CoreLog, Info, "Creating headless window: {}x{}", width, height)
+
+        // Offscreen OSMesa context first, so the GL renderer still runs.
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        mWindow = glfwCreateWindow(width, height, mConfig.title.c_str(), nullptr, nullptr);
+
+        if (!mWindow)
+        {
+            TG(CoreLog, Warn, "No offscreen GL context available, using the null renderer")
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            mWindow = glfwCreateWindow(width, height, mConfig.title.c_str(), nullptr, nullptr);
+        }
+
+        if (!mWindow) {
+            const char* description;
+            glfwGetError(&description);
+            TG(CoreLog, Error, "Failed to create headless window: {}", description ? description : "unknown")
+            throw std::runtime_error("Could not create headless window");
+        }
+        ++sGLFWWindowCount;
+
+        if (glfwGetWindowAttrib(mWindow, GLFW_CLIENT_API) != GLFW_NO_API)
+        {
+            InitContext();
+        }
+
+        glfwSetWindowUserPointer(mWindow, this);
+    }
+
+    void Window::InitContext()
+    {
         glfwMakeContextCurrent(mWindow); //TODO: Move to context class
         glfwSwapInterval(mConfig.vsync == VSync::On ? 1 : 0); //TODO: Check in func IsVSync
 
@@ -101,7 +228,7 @@ namespace tg
         glfwGetFramebufferSize(mWindow, &fbWidth, &fbHeight); //TODO: Move to context class or framebuffer class
         glViewport(0, 0, fbWidth, fbHeight);
 
-        glfwSetWindowUserPointer(mWindow, this);
+        mHasRenderContext = true;
     }
 
     void Window::ProcessEvents()
@@ -109,16 +236,40 @@ namespace tg
         glfwPollEvents();
     }
 
+    void Window::WaitEvents(double timeoutSeconds)
+    {
+        glfwWaitEventsTimeout(timeoutSeconds);
+    }
+
+    void Window::Wake()
+    {
+        if (sGLFWWindowCount > 0)
+        {
+            glfwPostEmptyEvent();
+        }
+    }
+
     void Window::SwapBuffers()
     {
+        if (!mHasRenderContext) return;
         glfwSwapBuffers(mWindow); //TODO: for other api's this done differently
     }
 
+    void Window::RequestClose()
+    {
+        glfwSetWindowShouldClose(mWindow, GLFW_TRUE);
+    }
+
     bool Window::isOpen() const
     {
         return !glfwWindowShouldClose(mWindow);
     }
 
+    bool Window::IsIconified() const
+    {
+        return glfwGetWindowAttrib(mWindow, GLFW_ICONIFIED) == GLFW_TRUE;
+    }
+
     
     void Window::Shutdown()
     {
@@ -134,6 +285,7 @@ namespace tg
             if (sGLFWWindowCount == 0)
             {
                 glfwTerminate();
+                sPlatformInitialized = false;
             }
         }
     }
@@ -0,0 +1,265 @@
+﻿#include "Debug/InputScript.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "Base/Log.h"
+
+namespace tg
+{
+    namespace
+    {
+        struct ModifierName
+        {
+            ImGuiKey key;
+            std::string_view name;
+        };
+
+        // Modifiers are submitted as ImGuiMod_ flags, which have no entry in the named key
+        // range; ImGui records them under reserved keys that GetKeyName() calls the same.
+        constexpr ModifierName kModifiers[] = {
+            { ImGuiMod_Ctrl, "ModCtrl" },
+            { ImGuiMod_Shift, "ModShift" },
+            { ImGuiMod_Alt, "ModAlt" },
+            { ImGuiMod_Super, "ModSuper" },
+        };
+
+        std::string_view GetKeyScriptName(ImGuiKey key)
+        {
+            for (const ModifierName& modifier : kModifiers)
+            {
+                if (modifier.key == key) return modifier.name;
+            }
+            return ImGui::GetKeyName(key);
+        }
+
+        ImGuiKey FindKey(std::string_view name)
+        {
+            for (const ModifierName& modifier : kModifiers)
+            {
+                if (modifier.name == name) return modifier.key;
+            }
+            for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; ++key)
+            {
+                if (name == ImGui::GetKeyName(static_cast<ImGuiKey>(key))) return static_cast<ImGuiKey>(key);
+            }
+            return ImGuiKey_None;
+        }
+
+        std::string_view NextToken(std::string_view& line)
+        {
+            const size_t start = line.find_first_not_of(" \t");
+            if (start == std::string_view::npos)
+            {
+                line = {};
+                return {};
+            }
+            line.remove_prefix(start);
+            const size_t end = std::min(line.find_first_of(" \t"), line.size());
+            const std::string_view token = line.substr(0, end);
+            line.remove_prefix(end);
+            return token;
+        }
+
+        template<typename T>
+        bool ParseNumber(std::string_view token, T& value)
+        {
+            const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+            return ec == std::errc() && ptr == token.data() + token.size();
+        }
+
+        bool ParseEvent(std::string_view line, InputScriptEvent& event)
+        {
+            if (!ParseNumber(NextToken(line), event.frame)) return false;
+
+            const std::string_view type = NextToken(line);
+            if (type == "mouse" || type == "wheel")
+            {
+                event.type = type == "mouse" ? InputScriptEventType::MousePos : InputScriptEventType::MouseWheel;
+                return ParseNumber(NextToken(line), event.x) && ParseNumber(NextToken(line), event.y);
+            }
+            if (type == "button" || type == "key")
+            {
+                const std::string_view target = NextToken(line);
+                const std::string_view state = NextToken(line);
+                event.down = state == "down";
+                if (!event.down && state != "up") return false;
+                if (type == "button")
+                {
+                    event.type = InputScriptEventType::MouseButton;
+                    return ParseNumber(target, event.code) && event.code >= 0 && event.code < ImGuiMouseButton_COUNT;
+                }
+                event.type = InputScriptEventType::Key;
+                event.code = FindKey(target);
+                return event.code != ImGuiKey_None;
+            }
+            if (type == "text")
+            {
+                event.type = InputScriptEventType::Text;
+                return ParseNumber(NextToken(line), event.code) && event.code > 0;
+            }
+            if (type == "focus")
+            {
+                event.type = InputScriptEventType::Focus;
+                int focused = 0;
+                if (!ParseNumber(NextToken(line), focused)) return false;
+                event.down = focused != 0;
+                return true;
+            }
+            if (type == "command")
+            {
+                event.type = InputScriptEventType::Command;
+                const size_t start = line.find_first_not_of(" \t");
+                if (start == std::string_view::npos) return false;
+                event.command = line.substr(start);
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool InputScript::Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            TG(CoreLog, Error, "Could not open input script '{}'", path)
+            return false;
+        }
+
+        mEvents.clear();
+        mReplayPos = 0;
+        std::string line;
+        for (uint32_t lineNumber = 1; std::getline(in, line); ++lineNumber)
+        {
+            std::string_view view(line);
+            if (!view.empty() && view.back() == '\r') view.remove_suffix(1);
+            const size_t start = view.find_first_not_of(" \t");
+            if (start == std::string_view::npos || view[start] == '#') continue;
+
+            InputScriptEvent event;
+            if (!ParseEvent(view, event))
+            {
+                TG(CoreLog, Error, "{}:{}: bad input script line '{}'", path, lineNumber, view)
+                return false;
+            }
+            mEvents.push_back(std::move(event));
+        }
+
+        // Hand-written scripts need not be in order; same-frame events keep theirs.
+        std::ranges::stable_sort(mEvents, {}, &InputScriptEvent::frame);
+        TG(CoreLog, Info, "Loaded input script '{}': {} events over {} frames", path, mEvents.size(), GetLastFrame() + 1)
+        return true;
+    }
+
+    bool InputScript::Save(const std::string& path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+        {
+            TG(CoreLog, Error, "Could not write input script '{}'", path)
+            return false;
+        }
+
+        out << "# <frame> mouse <x> <y> | button <n> down|up | wheel <x> <y> | key <name> down|up | text <codepoint> | focus 0|1 | command <text>\n";
+        for (const InputScriptEvent& event : mEvents)
+        {
+            out << event.frame << ' ';
+            switch (event.type)
+            {
+            case InputScriptEventType::MousePos:    out << "mouse " << event.x << ' ' << event.y; break;
+            case InputScriptEventType::MouseButton: out << "button " << event.code << (event.down ? " down" : " up"); break;
+            case InputScriptEventType::MouseWheel:  out << "wheel " << event.x << ' ' << event.y; break;
+            case InputScriptEventType::Key:         out << "key " << GetKeyScriptName(static_cast<ImGuiKey>(event.code)) << (event.down ? " down" : " up"); break;
+            case InputScriptEventType::Text:        out << "text " << event.code; break;
+            case InputScriptEventType::Focus:       out << "focus " << (event.down ? 1 : 0); break;
+            case InputScriptEventType::Command:     out << "command " << event.command; break;
+            }
+            out << '\n';
+        }
+        TG(CoreLog, Info, "Saved input script '{}': {} events", path, mEvents.size())
+        return static_cast<bool>(out);
+    }
+
+    void InputScript::Add(InputScriptEvent event)
+    {
+        mEvents.push_back(std::move(event));
+    }
+
+    void InputScript::CaptureFrame(uint64_t frame)
+    {
+        const ImGuiContext& g = *GImGui;
+        for (const ImGuiInputEvent& input : g.InputEventsTrail)
+        {
+            InputScriptEvent event;
+            event.frame = frame;
+            switch (input.Type)
+            {
+            case ImGuiInputEventType_MousePos:
+                event.type = InputScriptEventType::MousePos;
+                event.x = input.MousePos.PosX;
+                event.y = input.MousePos.PosY;
+                break;
+            case ImGuiInputEventType_MouseButton:
+                event.type = InputScriptEventType::MouseButton;
+                event.code = input.MouseButton.Button;
+                event.down = input.MouseButton.Down;
+                break;
+            case ImGuiInputEventType_MouseWheel:
+                event.type = InputScriptEventType::MouseWheel;
+                event.x = input.MouseWheel.WheelX;
+                event.y = input.MouseWheel.WheelY;
+                break;
+            case ImGuiInputEventType_Key:
+                if (GetKeyScriptName(input.Key.Key) == "Unknown") continue;
+                event.type = InputScriptEventType::Key;
+                event.code = input.Key.Key;
+                event.down = input.Key.Down;
+                break;
+            case ImGuiInputEventType_Text:
+                event.type = InputScriptEventType::Text;
+                event.code = static_cast<int>(input.Text.Char);
+                break;
+            case ImGuiInputEventType_Focus:
+                event.type = InputScriptEventType::Focus;
+                event.down = input.AppFocused.Focused;
+                break;
+            default:
+                // Viewport hover changes follow from the mouse position on replay.
+                continue;
+            }
+            mEvents.push_back(std::move(event));
+        }
+    }
+
+    void InputScript::ReplayFrame(uint64_t frame, const CommandHandler& handler)
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        for (; mReplayPos < mEvents.size() && mEvents[mReplayPos].frame <= frame; ++mReplayPos)
+        {
+            const InputScriptEvent& event = mEvents[mReplayPos];
+            switch (event.type)
+            {
+            case InputScriptEventType::MousePos:    io.AddMousePosEvent(event.x, event.y); break;
+            case InputScriptEventType::MouseButton: io.AddMouseButtonEvent(event.code, event.down); break;
+            case InputScriptEventType::MouseWheel:  io.AddMouseWheelEvent(event.x, event.y); break;
+            case InputScriptEventType::Key:         io.AddKeyEvent(static_cast<ImGuiKey>(event.code), event.down); break;
+            case InputScriptEventType::Text:        io.AddInputCharacter(static_cast<unsigned int>(event.code)); break;
+            case InputScriptEventType::Focus:       io.AddFocusEvent(event.down); break;
+            case InputScriptEventType::Command:
+                if (handler)
+                {
+                    handler(event.command);
+                }
+                else
+                {
+                    TG(CoreLog, Warn, "Input script command without a handler: {}", event.command)
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,140 @@
+﻿#include "Debug/MemoryOverlay.h"
+
+#include <cstdio>
+#include <imgui.h>
+
+#include "Debug/Profiler.h"
+#include "Memory/AllocationTracker.h"
+
+namespace tg
+{
+    namespace
+    {
+        constexpr size_t kTagCount = static_cast<size_t>(MemoryTag::Count);
+        // Rates are averaged over this long so they stay readable.
+        constexpr uint64_t kRateWindowNs = 500'000'000;
+
+        struct RateState
+        {
+            uint64_t windowStartNs = 0;
+            MemoryTagStats windowStart[kTagCount + 1] = {};
+            double allocationsPerSecond[kTagCount + 1] = {};
+            double bytesPerSecond[kTagCount + 1] = {};
+        };
+
+        RateState sRates;
+
+        // Index kTagCount is the total.
+        MemoryTagStats ReadStats(size_t index)
+        {
+            return index < kTagCount ? AllocationTracker::GetTagStats(static_cast<MemoryTag>(index))
+                                     : AllocationTracker::GetTotalStats();
+        }
+
+        void UpdateRates()
+        {
+            const uint64_t now = Profiler::NowNs();
+            const uint64_t elapsed = now - sRates.windowStartNs;
+            if (sRates.windowStartNs != 0 && elapsed < kRateWindowNs) return;
+
+            const double seconds = static_cast<double>(elapsed) / 1e9;
+            for (size_t i = 0; i <= kTagCount; ++i)
+            {
+                const MemoryTagStats stats = ReadStats(i);
+                if (sRates.windowStartNs != 0)
+                {
+                    sRates.allocationsPerSecond[i] = static_cast<double>(stats.allocations - sRates.windowStart[i].allocations) / seconds;
+                    sRates.bytesPerSecond[i] = static_cast<double>(stats.allocatedBytes - sRates.windowStart[i].allocatedBytes) / seconds;
+                }
+                sRates.windowStart[i] = stats;
+            }
+            sRates.windowStartNs = now;
+        }
+
+        void FormatBytes(char* buffer, size_t size, double bytes)
+        {
+            if (bytes < 0) bytes = 0;
+            if (bytes < 1024.0) std::snprintf(buffer, size, "%.0f B", bytes);
+            else if (bytes < 1024.0 * 1024.0) std::snprintf(buffer, size, "%.1f KB", bytes / 1024.0);
+            else std::snprintf(buffer, size, "%.2f MB", bytes / (1024.0 * 1024.0));
+        }
+
+        void BytesCell(double bytes)
+        {
+            char text[32];
+            FormatBytes(text, sizeof(text), bytes);
+            ImGui::TextUnformatted(text);
+        }
+
+        void RenderRow(const char* name, size_t index)
+        {
+            const MemoryTagStats stats = ReadStats(index);
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(name);
+            ImGui::TableSetColumnIndex(1);
+            BytesCell(static_cast<double>(stats.liveBytes));
+            ImGui::TableSetColumnIndex(2);
+            BytesCell(static_cast<double>(stats.peakBytes));
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.0f", sRates.allocationsPerSecond[index]);
+            ImGui::TableSetColumnIndex(4);
+            char text[32];
+            FormatBytes(text, sizeof(text), sRates.bytesPerSecond[index]);
+            ImGui::Text("%s/s", text);
+        }
+    }
+
+    void MemoryOverlay::Render(bool* open)
+    {
+        if (!open || !*open) return;
+
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + viewport->WorkSize.y - 10.0f),
+                                ImGuiCond_FirstUseEver, ImVec2(1.0f, 1.0f));
+        ImGui::SetNextWindowBgAlpha(0.85f);
+
+        ImGuiWindowFlags windowFlags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing |
+                                       ImGuiWindowFlags_NoSavedSettings;
+        if (!ImGui::Begin("Memory", open, windowFlags))
+        {
+            ImGui::End();
+            return;
+        }
+
+        if constexpr (!AllocationTracker::IsEnabled())
+        {
+            ImGui::TextDisabled("Built without TG_TRACK_ALLOCATIONS (Debug only)");
+            ImGui::End();
+            return;
+        }
+
+        UpdateRates();
+        if (ImGui::BeginTable("##memory", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Live");
+            ImGui::TableSetupColumn("Peak");
+            ImGui::TableSetupColumn("Allocs/s");
+            ImGui::TableSetupColumn("Bytes/s");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < kTagCount; ++i)
+            {
+                RenderRow(GetMemoryTagName(static_cast<MemoryTag>(i)), i);
+            }
+            RenderRow("Total", kTagCount);
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+        if (ImGui::Button("Reset Peaks"))
+        {
+            AllocationTracker::ResetPeaks();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("Textures are GL memory; the rest is heap");
+
+        ImGui::End();
+    }
+}
@@ -0,0 +1,544 @@
+﻿#include "Debug/Profiler.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Base/Log.h"
+
+namespace tg
+{
+    namespace
+    {
+        enum class TraceEventType : uint8_t { Scope, Counter };
+
+        struct TraceEvent
+        {
+            const char* name;
+            uint64_t startNs;
+            uint64_t endNs;
+            double value;
+            TraceEventType type;
+        };
+
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            std::vector<TraceEvent> events;
+            std::string name;
+            uint32_t tid = 0;
+            bool nameWritten = false;
+        };
+
+        ////////////////////////////////////////////////////////
+        ///              Trace writers
+        ////////////////////////////////////////////////////////
+        class TraceWriter
+        {
+        public:
+            virtual ~TraceWriter() = default;
+            virtual void WriteHeader() {}
+            virtual void WriteThreadName(uint32_t tid, const std::string& name) = 0;
+            virtual void WriteEvent(uint32_t tid, const TraceEvent& event) = 0;
+            virtual void WriteFooter() {}
+        };
+
+        uint32_t GetProcessID()
+        {
+#ifdef _WIN32
+            return static_cast<uint32_t>(_getpid());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        void WriteJsonString(std::ofstream& out, const char* str)
+        {
+            out.put('"');
+            for (const char* c = str; *c; ++c)
+            {
+                switch (*c)
+                {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                default: out.put(*c);
+                }
+            }
+            out.put('"');
+        }
+
+        class ChromeJsonWriter : public TraceWriter
+        {
+        public:
+            explicit ChromeJsonWriter(std::ofstream& out, uint64_t originNs)
+            : mOut(out), mOriginNs(originNs), mPid(GetProcessID()) {}
+
+            void WriteHeader() override { mOut << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["; }
+
+            void WriteThreadName(uint32_t tid, const std::string& name) override
+            {
+                Separator();
+                mOut << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << mPid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+                WriteJsonString(mOut, name.c_str());
+                mOut << "}}";
+            }
+
+            void WriteEvent(uint32_t tid, const TraceEvent& event) override
+            {
+                Separator();
+                if (event.type == TraceEventType::Counter)
+                {
+                    char args[96];
+                    std::snprintf(args, sizeof(args), "%.3f,\"args\":{\"value\":%.6g}",
+                        static_cast<double>(event.startNs - mOriginNs) / 1000.0, event.value);
+                    mOut << "{\"ph\":\"C\",\"name\":";
+                    WriteJsonString(mOut, event.name);
+                    mOut << ",\"pid\":" << mPid << ",\"ts\":" << args << "}";
+                    return;
+                }
+
+                char times[64];
+                std::snprintf(times, sizeof(times), "%.3f,\"dur\":%.3f",
+                    static_cast<double>(event.startNs - mOriginNs) / 1000.0,
+                    static_cast<double>(event.endNs - event.startNs) / 1000.0);
+                mOut << "{\"ph\":\"X\",\"cat\":\"tg\",\"name\":";
+                WriteJsonString(mOut, event.name);
+                mOut << ",\"pid\":" << mPid << ",\"tid\":" << tid << ",\"ts\":" << times << "}";
+            }
+
+            void WriteFooter() override { mOut << "]}"; }
+
+        private:
+            void Separator()
+            {
+                if (!mFirst) mOut.put(',');
+                mOut.put('\n');
+                mFirst = false;
+            }
+
+            std::ofstream& mOut;
+            uint64_t mOriginNs;
+            uint32_t mPid;
+            bool mFirst = true;
+        };
+
+        // Minimal protobuf encoder for the subset of perfetto.protos.Trace we emit:
+        // one TrackDescriptor per thread and SLICE_BEGIN/SLICE_END TrackEvents.
+        class PerfettoWriter : public TraceWriter
+        {
+        public:
+            explicit PerfettoWriter(std::ofstream& out) : mOut(out), mPid(GetProcessID()) {}
+
+            void WriteThreadName(uint32_t tid, const std::string& name) override
+            {
+                std::string thread;
+                PutVarintField(thread, 1, mPid);
+                PutVarintField(thread, 2, tid);
+                PutBytesField(thread, 5, name);
+
+                std::string descriptor;
+                PutVarintField(descriptor, 1, TrackUuid(tid));
+                PutBytesField(descriptor, 4, thread);
+
+                std::string packet;
+                PutVarintField(packet, 10, kSequenceId);
+                PutBytesField(packet, 60, descriptor);
+                WritePacket(packet);
+            }
+
+            void WriteEvent(uint32_t tid, const TraceEvent& event) override
+            {
+                if (event.type == TraceEventType::Counter)
+                {
+                    WriteCounter(event);
+                    return;
+                }
+                WriteSlice(tid, event.startNs, 1, event.name);
+                WriteSlice(tid, event.endNs, 2, nullptr);
+            }
+
+        private:
+            static constexpr uint32_t kSequenceId = 1;
+
+            static uint64_t TrackUuid(uint32_t tid) { return 0x7467000000000000ull | tid; }
+
+            static void PutVarint(std::string& out, uint64_t value)
+            {
+                while (value >= 0x80)
+                {
+                    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                    value >>= 7;
+                }
+                out.push_back(static_cast<char>(value));
+            }
+
+            static void PutVarintField(std::string& out, uint32_t field, uint64_t value)
+            {
+                PutVarint(out, (static_cast<uint64_t>(field) << 3) | 0);
+                PutVarint(out, value);
+            }
+
+            static void PutBytesField(std::string& out, uint32_t field, const std::string& bytes)
+            {
+                PutVarint(out, (static_cast<uint64_t>(field) << 3) | 2);
+                PutVarint(out, bytes.size());
+                out.append(bytes);
+            }
+
+            static void PutDoubleField(std::string& out, uint32_t field, double value)
+            {
+                PutVarint(out, (static_cast<uint64_t>(field) << 3) | 1);
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                for (int i = 0; i < 8; ++i)
+                {
+                    out.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+                }
+            }
+
+            void WriteCounter(const TraceEvent& event)
+            {
+                // Counter names are interned, so the pointer identifies the track.
+                const uint64_t uuid = 0x7463000000000000ull | (reinterpret_cast<uintptr_t>(event.name) & 0xFFFFFFFFFFFFull);
+                if (mCounterTracks.insert(uuid).second)
+                {
+                    std::string descriptor;
+                    PutVarintField(descriptor, 1, uuid);
+                    PutBytesField(descriptor, 2, event.name);
+                    PutBytesField(descriptor, 8, std::string());
+
+                    std::string packet;
+                    PutVarintField(packet, 10, kSequenceId);
+                    PutBytesField(packet, 60, descriptor);
+                    WritePacket(packet);
+                }
+
+                std::string trackEvent;
+                PutVarintField(trackEvent, 9, 4);
+                PutVarintField(trackEvent, 11, uuid);
+                PutDoubleField(trackEvent, 44, event.value);
+
+                std::string packet;
+                PutVarintField(packet, 8, event.startNs);
+                PutVarintField(packet, 10, kSequenceId);
+                PutBytesField(packet, 11, trackEvent);
+                WritePacket(packet);
+            }
+
+            void WriteSlice(uint32_t tid, uint64_t timestampNs, uint64_t type, const char* name)
+            {
+                std::string trackEvent;
+                PutVarintField(trackEvent, 9, type);
+                PutVarintField(trackEvent, 11, TrackUuid(tid));
+                if (name)
+                {
+                    PutBytesField(trackEvent, 23, name);
+                }
+
+                std::string packet;
+                PutVarintField(packet, 8, timestampNs);
+                PutVarintField(packet, 10, kSequenceId);
+                PutBytesField(packet, 11, trackEvent);
+                WritePacket(packet);
+            }
+
+            void WritePacket(const std::string& packet)
+            {
+                mScratch.clear();
+                PutBytesField(mScratch, 1, packet);
+                mOut.write(mScratch.data(), static_cast<std::streamsize>(mScratch.size()));
+            }
+
+            std::ofstream& mOut;
+            uint32_t mPid;
+            std::string mScratch;
+            std::unordered_set<uint64_t> mCounterTracks;
+        };
+
+        ////////////////////////////////////////////////////////
+        ///              Profiler state
+        ////////////////////////////////////////////////////////
+        std::mutex sBuffersMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> sBuffers;
+        uint32_t sNextThreadID = 1;
+
+        std::mutex sCaptureMutex;
+        std::condition_variable sWriterWakeup;
+        std::thread sWriterThread;
+        bool sStopWriter = false;
+        TraceCaptureConfig sCaptureConfig;
+        uint64_t sCaptureStartNs = 0;
+        std::string sLastCapturePath;
+
+        std::mutex sCountersMutex;
+        std::unordered_set<std::string> sCounterNames;
+        std::map<std::string_view, double> sCounters;
+
+        volatile std::sig_atomic_t sSignalCaptureRequested = 0;
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = []
+            {
+                auto newBuffer = std::make_shared<ThreadBuffer>();
+                std::lock_guard lock(sBuffersMutex);
+                newBuffer->tid = sNextThreadID++;
+                newBuffer->name = "Thread " + std::to_string(newBuffer->tid);
+                sBuffers.push_back(newBuffer);
+                return newBuffer;
+            }();
+            return *buffer;
+        }
+
+        void DrainBuffers(TraceWriter& writer, std::vector<TraceEvent>& scratch)
+        {
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            {
+                std::lock_guard lock(sBuffersMutex);
+                buffers = sBuffers;
+            }
+
+            for (auto& buffer : buffers)
+            {
+                std::string threadName;
+                {
+                    std::lock_guard lock(buffer->mutex);
+                    scratch.swap(buffer->events);
+                    if (!buffer->nameWritten && !scratch.empty())
+                    {
+                        threadName = buffer->name;
+                        buffer->nameWritten = true;
+                    }
+                }
+
+                if (!threadName.empty())
+                {
+                    writer.WriteThreadName(buffer->tid, threadName);
+                }
+                for (const auto& event : scratch)
+                {
+                    writer.WriteEvent(buffer->tid, event);
+                }
+                scratch.clear();
+            }
+        }
+
+        void WriterThreadMain(std::string path, TraceFormat format, uint64_t originNs)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                TG(CoreLog, Error, "Failed to open trace file: {}", path)
+                return;
+            }
+
+            std::unique_ptr<TraceWriter> writer;
+            if (format == TraceFormat::Perfetto)
+                writer = std::make_unique<PerfettoWriter>(out);
+            else
+                writer = std::make_unique<ChromeJsonWriter>(out, originNs);
+
+            writer->WriteHeader();
+
+            std::vector<TraceEvent> scratch;
+            std::unique_lock lock(sCaptureMutex);
+            while (!sStopWriter)
+            {
+                sWriterWakeup.wait_for(lock, std::chrono::milliseconds(100));
+                lock.unlock();
+                DrainBuffers(*writer, scratch);
+                lock.lock();
+            }
+            lock.unlock();
+
+            DrainBuffers(*writer, scratch);
+            writer->WriteFooter();
+        }
+
+        std::string MakeCapturePath(const TraceCaptureConfig& config)
+        {
+            std::time_t now = std::time(nullptr);
+            std::tm localTime{};
+#ifdef _WIN32
+            localtime_s(&localTime, &now);
+#else
+            localtime_r(&now, &localTime);
+#endif
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &localTime);
+
+            const char* extension = config.format == TraceFormat::Perfetto ? ".perfetto-trace" : ".json";
+            return (std::filesystem::path(config.outputDir) / (std::string("trace-") + stamp + extension)).string();
+        }
+
+        void OnCaptureSignal(int)
+        {
+            sSignalCaptureRequested = 1;
+        }
+    }
+
+    std::atomic<bool> Profiler::sCapturing{ false };
+
+    void Profiler::Init()
+    {
+        SetThreadName("Main");
+
+#ifdef _WIN32
+        std::signal(SIGBREAK, OnCaptureSignal);
+#else
+        std::signal(SIGUSR1, OnCaptureSignal);
+#endif
+    }
+
+    void Profiler::Shutdown()
+    {
+        EndCapture();
+    }
+
+    void Profiler::BeginCapture(const TraceCaptureConfig& config)
+    {
+        std::lock_guard lock(sCaptureMutex);
+        if (sCapturing.load())
+        {
+            TG(CoreLog, Warn, "Trace capture already running: {}", sLastCapturePath)
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(config.outputDir, ec);
+
+        {
+            std::lock_guard buffersLock(sBuffersMutex);
+            for (auto& buffer : sBuffers)
+            {
+                std::lock_guard bufferLock(buffer->mutex);
+                buffer->events.clear();
+                buffer->nameWritten = false;
+            }
+        }
+
+        sCaptureConfig = config;
+        sCaptureStartNs = NowNs();
+        sLastCapturePath = MakeCapturePath(config);
+        sStopWriter = false;
+        sWriterThread = std::thread(WriterThreadMain, sLastCapturePath, config.format, sCaptureStartNs);
+        sCapturing.store(true);
+
+        TG(CoreLog, Info, "Trace capture started: {} ({:.1f}s)", sLastCapturePath, config.durationSeconds)
+    }
+
+    void Profiler::EndCapture()
+    {
+        {
+            std::lock_guard lock(sCaptureMutex);
+            if (!sCapturing.load()) return;
+            sCapturing.store(false);
+            sStopWriter = true;
+        }
+        sWriterWakeup.notify_all();
+
+        if (sWriterThread.joinable())
+        {
+            sWriterThread.join();
+        }
+
+        TG(CoreLog, Info, "Trace capture written: {}", sLastCapturePath)
+    }
+
+    const std::string& Profiler::GetLastCapturePath()
+    {
+        return sLastCapturePath;
+    }
+
+    void Profiler::OnFrameEnd()
+    {
+        if (sSignalCaptureRequested)
+        {
+            sSignalCaptureRequested = 0;
+            if (!IsCapturing())
+            {
+                BeginCapture();
+            }
+        }
+
+        if (IsCapturing() && sCaptureConfig.durationSeconds > 0.0f)
+        {
+            const auto durationNs = static_cast<uint64_t>(sCaptureConfig.durationSeconds * 1e9);
+            if (NowNs() - sCaptureStartNs >= durationNs)
+            {
+                EndCapture();
+            }
+        }
+    }
+
+    void Profiler::SetThreadName(const char* name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    void Profiler::RecordScope(const char* name, uint64_t startNs, uint64_t endNs)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard lock(buffer.mutex);
+        buffer.events.push_back({ name, startNs, endNs, 0.0, TraceEventType::Scope });
+    }
+
+    void Profiler::SetCounter(std::string_view name, double value)
+    {
+        const char* internedName;
+        {
+            std::lock_guard lock(sCountersMutex);
+            auto it = sCounters.find(name);
+            if (it == sCounters.end())
+            {
+                const std::string& stored = *sCounterNames.emplace(name).first;
+                it = sCounters.emplace(stored, value).first;
+            }
+            it->second = value;
+            internedName = it->first.data();
+        }
+
+        if (IsCapturing())
+        {
+            const uint64_t now = NowNs();
+            ThreadBuffer& buffer = GetThreadBuffer();
+            std::lock_guard lock(buffer.mutex);
+            buffer.events.push_back({ internedName, now, now, value, TraceEventType::Counter });
+        }
+    }
+
+    void Profiler::ForEachCounter(const std::function<void(const char* name, double value)>& fn)
+    {
+        std::lock_guard lock(sCountersMutex);
+        for (const auto& [name, value] : sCounters)
+        {
+            fn(name.data(), value);
+        }
+    }
+
+    uint64_t Profiler::NowNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
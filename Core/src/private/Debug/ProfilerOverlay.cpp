@@ -0,0 +1,71 @@
+﻿#include "Debug/ProfilerOverlay.h"
+
+#include <cstring>
+#include <imgui.h>
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    void ProfilerOverlay::Render(bool* open)
+    {
+        if (!open || !*open) return;
+
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + 30.0f),
+                                ImGuiCond_FirstUseEver, ImVec2(1.0f, 0.0f));
+        ImGui::SetNextWindowBgAlpha(0.85f);
+
+        ImGuiWindowFlags windowFlags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing |
+                                       ImGuiWindowFlags_NoSavedSettings;
+        if (!ImGui::Begin("Profiler", open, windowFlags))
+        {
+            ImGui::End();
+            return;
+        }
+
+        double cpuMs = 0.0;
+        double gpuMs = 0.0;
+
+        if (ImGui::BeginTable("##counters", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            char currentGroup[64] = {};
+            Profiler::ForEachCounter([&](const char* name, double value)
+            {
+                const char* separator = std::strchr(name, '/');
+                const size_t groupLength = separator ? static_cast<size_t>(separator - name) : 0;
+                if (groupLength > 0 && groupLength < sizeof(currentGroup) &&
+                    (std::strncmp(currentGroup, name, groupLength) != 0 || currentGroup[groupLength] != '\0'))
+                {
+                    std::memcpy(currentGroup, name, groupLength);
+                    currentGroup[groupLength] = '\0';
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::TextColored(ImVec4(0.26f, 0.59f, 0.98f, 1.0f), "%s", currentGroup);
+                }
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("  %s", separator ? separator + 1 : name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f", value);
+
+                if (std::strcmp(name, "CPU/Frame (ms)") == 0) cpuMs = value;
+                if (std::strcmp(name, "GPU/Total (ms)") == 0) gpuMs = value;
+            });
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+        if (cpuMs > 0.0 || gpuMs > 0.0)
+        {
+            ImGui::Text("Frame is %s-bound", gpuMs > cpuMs ? "GPU" : "CPU");
+        }
+        if (Profiler::IsCapturing())
+        {
+            ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "Recording trace...");
+        }
+
+        ImGui::End();
+    }
+}
@@ -0,0 +1,73 @@
+﻿#include "ImGui/DrawDataSnapshot.h"
+
+#include <cstring>
+
+namespace tg
+{
+    namespace
+    {
+        template<typename T>
+        void CopyBuffer(ImVector<T>& dst, const ImVector<T>& src)
+        {
+            // resize() only grows the capacity, unlike ImVector::operator= which frees first.
+            dst.resize(src.Size);
+            if (src.Size > 0)
+            {
+                std::memcpy(dst.Data, src.Data, static_cast<size_t>(src.Size) * sizeof(T));
+            }
+        }
+    }
+
+    DrawDataSnapshot::~DrawDataSnapshot()
+    {
+        for (ImDrawList* list : mOwnedLists)
+        {
+            IM_DELETE(list);
+        }
+        mOwnedLists.clear();
+    }
+
+    void DrawDataSnapshot::Capture(const ImDrawData* source)
+    {
+        if (!source || !source->Valid)
+        {
+            Clear();
+            return;
+        }
+
+        while (mOwnedLists.Size < source->CmdListsCount)
+        {
+            mOwnedLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+
+        mDrawData.CmdLists.resize(source->CmdListsCount);
+        for (int i = 0; i < source->CmdListsCount; ++i)
+        {
+            const ImDrawList* src = source->CmdLists[i];
+            ImDrawList* dst = mOwnedLists[i];
+            CopyBuffer(dst->CmdBuffer, src->CmdBuffer);
+            CopyBuffer(dst->IdxBuffer, src->IdxBuffer);
+            CopyBuffer(dst->VtxBuffer, src->VtxBuffer);
+            dst->Flags = src->Flags;
+            mDrawData.CmdLists[i] = dst;
+        }
+
+        mDrawData.Valid = true;
+        mDrawData.CmdListsCount = source->CmdListsCount;
+        mDrawData.TotalIdxCount = source->TotalIdxCount;
+        mDrawData.TotalVtxCount = source->TotalVtxCount;
+        mDrawData.DisplayPos = source->DisplayPos;
+        mDrawData.DisplaySize = source->DisplaySize;
+        mDrawData.FramebufferScale = source->FramebufferScale;
+        mDrawData.OwnerViewport = source->OwnerViewport;
+    }
+
+    void DrawDataSnapshot::Clear()
+    {
+        mDrawData.Valid = false;
+        mDrawData.CmdListsCount = 0;
+        mDrawData.TotalIdxCount = 0;
+        mDrawData.TotalVtxCount = 0;
+        mDrawData.CmdLists.resize(0);
+    }
+}
@@ -0,0 +1,387 @@
+﻿#include "ImGui/DynamicGlyphs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <imgui_internal.h>
+
+// ImGui compiles its copy of stb_truetype with internal linkage, so we need our own.
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+#include "TG/TGFontTexture.h"
+
+namespace tg
+{
+    struct DynamicGlyphs::FontSource
+    {
+        std::string path;
+        std::vector<unsigned char> data;
+        stbtt_fontinfo info{};
+        float scale = 1.0f;
+    };
+
+    namespace
+    {
+        bool ReadFile(const std::string& path, std::vector<unsigned char>& out)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file) return false;
+
+            out.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size())));
+        }
+    }
+
+    DynamicGlyphs::~DynamicGlyphs()
+    {
+        Stop();
+    }
+
+    void DynamicGlyphs::Start(ImFont* font, const std::string& fontPath, const std::vector<std::string>& fallbackPaths)
+    {
+        Stop();
+
+        mFont = font;
+        mRequested.assign((IM_UNICODE_CODEPOINT_MAX + 64) / 64, 0);
+        mSizePixels = font->FontSize;
+        mAscent = IM_ROUND(font->Ascent);
+        mShelfX = 0;
+        mShelfY = -1;
+        mShelfHeight = 0;
+
+        // Files are only read by the worker, so large CJK fallbacks don't cost startup time.
+        if (!fontPath.empty())
+        {
+            mSources.push_back(new FontSource{fontPath});
+        }
+        for (const std::string& path : fallbackPaths)
+        {
+            std::error_code error;
+            if (std::filesystem::is_regular_file(path, error))
+            {
+                mSources.push_back(new FontSource{path});
+            }
+        }
+
+        mStopRequested = false;
+        mThread = std::thread(&DynamicGlyphs::WorkerMain, this);
+        TG(CoreLog, Info, "Dynamic glyph loading enabled with {} font sources", mSources.size())
+    }
+
+    void DynamicGlyphs::Stop()
+    {
+        if (mThread.joinable())
+        {
+            {
+                std::lock_guard lock(mMutex);
+                mStopRequested = true;
+            }
+            mCondition.notify_all();
+            mThread.join();
+        }
+
+        for (FontSource* source : mSources)
+        {
+            delete source;
+        }
+        mSources.clear();
+        mPending.clear();
+        mCompleted.clear();
+        mFont = nullptr;
+    }
+
+    void DynamicGlyphs::Request(std::string_view utf8)
+    {
+        if (!mFont) return;
+
+        const char* text = utf8.data();
+        const char* end = text + utf8.size();
+        bool queued = false;
+        while (text < end)
+        {
+            // Everything ASCII is baked.
+            if (static_cast<unsigned char>(*text) < 0x80)
+            {
+                ++text;
+                continue;
+            }
+
+            unsigned int codepoint = 0;
+            text += ImTextCharFromUtf8(&codepoint, text, end);
+            if (codepoint == IM_UNICODE_CODEPOINT_INVALID || codepoint > IM_UNICODE_CODEPOINT_MAX) continue;
+
+            uint64_t& word = mRequested[codepoint >> 6];
+            const uint64_t bit = 1ull << (codepoint & 63);
+            if (word & bit) continue;
+            word |= bit;
+
+            if (mFont->FindGlyphNoFallback(static_cast<ImWchar>(codepoint))) continue;
+
+            std::lock_guard lock(mMutex);
+            mPending.push_back(codepoint);
+            queued = true;
+        }
+
+        if (queued)
+        {
+            mCondition.notify_one();
+        }
+    }
+
+    void DynamicGlyphs::WorkerMain()
+    {
+        Profiler::SetThreadName("Glyphs");
+
+        for (FontSource* source : mSources)
+        {
+            const int offset = ReadFile(source->path, source->data)
+                ? stbtt_GetFontOffsetForIndex(source->data.data(), 0) : -1;
+            if (offset < 0 || !stbtt_InitFont(&source->info, source->data.data(), offset))
+            {
+                TG(CoreLog, Warn, "Could not load glyph source {}", source->path)
+                source->data.clear();
+                continue;
+            }
+            // Same pixel height as the baked font, like ImGui with SizePixels > 0.
+            source->scale = stbtt_ScaleForPixelHeight(&source->info, mSizePixels);
+        }
+
+        while (true)
+        {
+            uint32_t codepoint = 0;
+            {
+                std::unique_lock lock(mMutex);
+                mCondition.wait(lock, [this] { return !mPending.empty() || mStopRequested; });
+                if (mStopRequested) break;
+
+                codepoint = mPending.front();
+                mPending.pop_front();
+            }
+
+            TG_PROFILE_SCOPE("DynamicGlyphs::Rasterize")
+            RasterizedGlyph glyph;
+            glyph.codepoint = codepoint;
+            for (FontSource* source : mSources)
+            {
+                if (source->data.empty()) continue;
+
+                const int index = stbtt_FindGlyphIndex(&source->info, static_cast<int>(codepoint));
+                if (index == 0) continue;
+
+                int advance = 0, leftBearing = 0;
+                int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+                stbtt_GetGlyphHMetrics(&source->info, index, &advance, &leftBearing);
+                stbtt_GetGlyphBitmapBox(&source->info, index, source->scale, source->scale, &x0, &y0, &x1, &y1);
+
+                glyph.found = true;
+                glyph.width = x1 - x0;
+                glyph.height = y1 - y0;
+                glyph.x0 = static_cast<float>(x0);
+                glyph.y0 = static_cast<float>(y0) + mAscent;
+                glyph.advanceX = static_cast<float>(advance) * source->scale;
+                if (glyph.width > 0 && glyph.height > 0)
+                {
+                    glyph.alpha.resize(static_cast<size_t>(glyph.width) * glyph.height);
+                    stbtt_MakeGlyphBitmap(&source->info, glyph.alpha.data(), glyph.width, glyph.height, glyph.width,
+                                          source->scale, source->scale, index);
+                }
+                break;
+            }
+
+            std::lock_guard lock(mMutex);
+            mCompleted.push_back(std::move(glyph));
+        }
+    }
+
+    void DynamicGlyphs::ApplyCompleted()
+    {
+        if (!mFont) return;
+
+        std::vector<RasterizedGlyph> completed;
+        {
+            std::lock_guard lock(mMutex);
+            if (mCompleted.empty()) return;
+            completed.swap(mCompleted);
+        }
+
+        TG_PROFILE_FUNCTION()
+        ImFontAtlas* atlas = mFont->ContainerAtlas;
+        if (!atlas->TexPixelsRGBA32) return;
+
+        bool added = false;
+        for (const RasterizedGlyph& glyph : completed)
+        {
+            if (!glyph.found)
+            {
+                ++mMissingCount;
+                continue;
+            }
+
+            float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+            if (glyph.width > 0 && glyph.height > 0)
+            {
+                int x = 0, y = 0;
+                if (!Pack(glyph.width, glyph.height, x, y))
+                {
+                    TG(CoreLog, Warn, "Font atlas is full, dropping glyph U+{:04X}", glyph.codepoint)
+                    continue;
+                }
+
+                unsigned int* pixels = atlas->TexPixelsRGBA32;
+                for (int row = 0; row < glyph.height; ++row)
+                {
+                    unsigned int* dst = pixels + static_cast<size_t>(y + row) * atlas->TexWidth + x;
+                    const uint8_t* src = glyph.alpha.data() + static_cast<size_t>(row) * glyph.width;
+                    for (int column = 0; column < glyph.width; ++column)
+                    {
+                        dst[column] = IM_COL32(255, 255, 255, src[column]);
+                    }
+                }
+
+                mDirtyY0 = mDirtyY1 > mDirtyY0 ? std::min(mDirtyY0, y) : y;
+                mDirtyY1 = std::max(mDirtyY1, y + glyph.height);
+
+                u0 = static_cast<float>(x) * atlas->TexUvScale.x;
+                v0 = static_cast<float>(y) * atlas->TexUvScale.y;
+                u1 = static_cast<float>(x + glyph.width) * atlas->TexUvScale.x;
+                v1 = static_cast<float>(y + glyph.height) * atlas->TexUvScale.y;
+            }
+
+            mFont->AddGlyph(nullptr, static_cast<ImWchar>(glyph.codepoint),
+                            glyph.x0, glyph.y0, glyph.x0 + static_cast<float>(glyph.width), glyph.y0 + static_cast<float>(glyph.height),
+                            u0, v0, u1, v1, glyph.advanceX);
+            ++mLoadedCount;
+            added = true;
+        }
+
+        if (added)
+        {
+            mFont->BuildLookupTable();
+            ++mGeneration;
+        }
+        Profiler::SetCounter("Fonts/Dynamic Glyphs", mLoadedCount);
+        Profiler::SetCounter("Fonts/Missing Glyphs", mMissingCount);
+        Profiler::SetCounter("Fonts/Atlas Height", atlas->TexHeight);
+    }
+
+    bool DynamicGlyphs::Pack(int width, int height, int& outX, int& outY)
+    {
+        ImFontAtlas* atlas = mFont->ContainerAtlas;
+        const int padding = atlas->TexGlyphPadding;
+        width += padding;
+        height += padding;
+        if (width > atlas->TexWidth) return false;
+
+        // Dynamic rows start below the baked atlas; each shelf is the last one, so it can grow.
+        if (mShelfY < 0 || mShelfX + width > atlas->TexWidth)
+        {
+            mShelfY = mShelfY < 0 ? atlas->TexHeight : mShelfY + mShelfHeight;
+            mShelfX = 0;
+            mShelfHeight = 0;
+        }
+        mShelfHeight = std::max(mShelfHeight, height);
+
+        if (mShelfY + mShelfHeight > atlas->TexHeight)
+        {
+            Grow(mShelfY + mShelfHeight);
+            if (mShelfY + mShelfHeight > atlas->TexHeight) return false;
+        }
+
+        outX = mShelfX;
+        outY = mShelfY;
+        mShelfX += width;
+        return true;
+    }
+
+    void DynamicGlyphs::Grow(int minHeight)
+    {
+        ImFontAtlas* atlas = mFont->ContainerAtlas;
+        const int oldHeight = atlas->TexHeight;
+        int newHeight = oldHeight;
+        while (newHeight < minHeight)
+        {
+            newHeight += kPageHeight;
+        }
+        if (newHeight > kMaxTextureHeight) return;
+
+        const size_t oldCount = static_cast<size_t>(atlas->TexWidth) * oldHeight;
+        const size_t newCount = static_cast<size_t>(atlas->TexWidth) * newHeight;
+        auto* pixels = static_cast<unsigned int*>(IM_ALLOC(newCount * sizeof(unsigned int)));
+        std::memcpy(pixels, atlas->TexPixelsRGBA32, oldCount * sizeof(unsigned int));
+        std::memset(pixels + oldCount, 0, (newCount - oldCount) * sizeof(unsigned int));
+        IM_FREE(atlas->TexPixelsRGBA32);
+        atlas->TexPixelsRGBA32 = pixels;
+
+        // The alpha copy would now be stale.
+        if (atlas->TexPixelsAlpha8)
+        {
+            IM_FREE(atlas->TexPixelsAlpha8);
+            atlas->TexPixelsAlpha8 = nullptr;
+        }
+
+        // Pixel positions stay put; normalized V coordinates shrink with the taller texture.
+        const float ratio = static_cast<float>(oldHeight) / static_cast<float>(newHeight);
+        for (ImFont* font : atlas->Fonts)
+        {
+            for (ImFontGlyph& glyph : font->Glyphs)
+            {
+                glyph.V0 *= ratio;
+                glyph.V1 *= ratio;
+            }
+        }
+        atlas->TexUvWhitePixel.y *= ratio;
+        for (ImVec4& uv : atlas->TexUvLines)
+        {
+            uv.y *= ratio;
+            uv.w *= ratio;
+        }
+        atlas->TexHeight = newHeight;
+        atlas->TexUvScale.y = 1.0f / static_cast<float>(newHeight);
+        mResized = true;
+    }
+
+    void DynamicGlyphs::QueueUploads()
+    {
+        if (!mFont || (!mResized && mDirtyY1 <= mDirtyY0)) return;
+
+        ImFontAtlas* atlas = mFont->ContainerAtlas;
+        // Without a texture yet (or without a renderer) the first upload takes the CPU pixels as they are.
+        if (atlas->TexID)
+        {
+            Upload& upload = mUploads[mNextUpload];
+            mNextUpload = (mNextUpload + 1) % kUploadSlots;
+
+            upload.texture = atlas->TexID;
+            upload.width = atlas->TexWidth;
+            upload.height = atlas->TexHeight;
+            upload.resize = mResized;
+            upload.y = mResized ? 0 : mDirtyY0;
+            upload.rows = mResized ? atlas->TexHeight : mDirtyY1 - mDirtyY0;
+
+            const unsigned int* first = atlas->TexPixelsRGBA32 + static_cast<size_t>(upload.y) * atlas->TexWidth;
+            upload.pixels.assign(first, first + static_cast<size_t>(upload.rows) * atlas->TexWidth);
+
+            // Runs on the GL thread before anything in the main viewport samples the atlas.
+            ImDrawList* drawList = ImGui::GetBackgroundDrawList(ImGui::GetMainViewport());
+            drawList->AddCallback(UploadCallback, &upload);
+            drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        }
+
+        mResized = false;
+        mDirtyY0 = 0;
+        mDirtyY1 = 0;
+    }
+
+    void DynamicGlyphs::UploadCallback(const ImDrawList*, const ImDrawCmd* cmd)
+    {
+        const auto* upload = static_cast<const Upload*>(cmd->UserCallbackData);
+        TGFontTexture::Upload(upload->texture, upload->width, upload->height, upload->y, upload->rows,
+                              upload->pixels.data(), upload->resize);
+    }
+}
@@ -0,0 +1,426 @@
+﻿#include "ImGui/FontLibrary.h"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <imgui_internal.h>
+
+#include "Base/App.h"
+#include "Base/Log.h"
+#include "Base/MappedFile.h"
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    namespace
+    {
+        constexpr uint32_t kCacheMagic = 0x41464754; // "TGFA"
+        constexpr uint32_t kCacheVersion = 1;
+
+        // File layout: CacheHeader, CachedGlyph[glyphCount], RGBA32 pixels[texWidth * texHeight].
+        struct CacheHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            double bakeMs;
+            int32_t texWidth;
+            int32_t texHeight;
+            ImVec2 texUvScale;
+            ImVec2 texUvWhitePixel;
+            ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+            float fontSize;
+            float ascent;
+            float descent;
+            uint32_t glyphCount;
+        };
+
+        struct CachedGlyph
+        {
+            uint32_t codepoint;
+            uint32_t colored;
+            float advanceX;
+            float x0, y0, x1, y1;
+            float u0, v0, u1, v1;
+        };
+
+        class KeyHasher
+        {
+        public:
+            void Add(const void* data, size_t size)
+            {
+                const auto* bytes = static_cast<const uint8_t*>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    mHash = (mHash ^ bytes[i]) * 1099511628211ull;
+                }
+            }
+
+            template<typename T>
+            void Add(const T& value) { Add(&value, sizeof(T)); }
+
+            [[nodiscard]] uint64_t Get() const { return mHash; }
+
+        private:
+            uint64_t mHash = 14695981039346656037ull; // FNV-1a
+        };
+
+        double MillisecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        uint64_t ComputeKey(const std::string& path, float sizePixels, float dpiScale, const ImWchar* ranges,
+                            const ImFontAtlas* atlas, const ImFontConfig& config)
+        {
+            KeyHasher hasher;
+            hasher.Add(kCacheVersion);
+            hasher.Add(IMGUI_VERSION_NUM);
+            hasher.Add(sizeof(ImWchar));
+            hasher.Add(path.data(), path.size());
+
+            // A font update in place must not reuse the old atlas.
+            std::error_code error;
+            const uint64_t fileSize = std::filesystem::file_size(path, error);
+            const auto writeTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+            hasher.Add(fileSize);
+            hasher.Add(writeTime);
+
+            hasher.Add(sizePixels);
+            hasher.Add(dpiScale);
+            for (const ImWchar* range = ranges; range[0]; range += 2)
+            {
+                hasher.Add(range[0]);
+                hasher.Add(range[1]);
+            }
+
+            hasher.Add(atlas->Flags);
+            hasher.Add(atlas->TexGlyphPadding);
+            hasher.Add(config.OversampleH);
+            hasher.Add(config.OversampleV);
+            hasher.Add(config.PixelSnapH);
+            hasher.Add(config.RasterizerMultiply);
+            return hasher.Get();
+        }
+    }
+
+    FontLibraryConfig FontLibraryConfig::FromCommandLine()
+    {
+        FontLibraryConfig config;
+        const CommandLineArgs& args = App::GetCommandLineArgs();
+
+        if (const char* font = args.GetValue("--font"))
+        {
+            config.fontPaths.emplace_back(font);
+        }
+        if (const char* font = std::getenv("TG_FONT"))
+        {
+            config.fontPaths.emplace_back(font);
+        }
+
+#if defined(_WIN32)
+        config.fontPaths.emplace_back(R"(C:\Windows\Fonts\segoeui.ttf)");
+        config.fallbackFontPaths = {
+            R"(C:\Windows\Fonts\seguiemj.ttf)",
+            R"(C:\Windows\Fonts\seguisym.ttf)",
+            R"(C:\Windows\Fonts\msyh.ttc)",
+            R"(C:\Windows\Fonts\YuGothM.ttc)",
+            R"(C:\Windows\Fonts\malgun.ttf)",
+        };
+#elif defined(__APPLE__)
+        config.fontPaths.emplace_back("/System/Library/Fonts/SFNS.ttf");
+        config.fontPaths.emplace_back("/System/Library/Fonts/Supplemental/Arial.ttf");
+        config.fallbackFontPaths = {
+            "/System/Library/Fonts/Supplemental/Arial Unicode.ttf",
+            "/System/Library/Fonts/Hiragino Sans GB.ttc",
+        };
+#else
+        config.fontPaths.emplace_back("/usr/share/fonts/truetype/noto/NotoSans-Regular.ttf");
+        config.fontPaths.emplace_back("/usr/share/fonts/noto/NotoSans-Regular.ttf");
+        config.fontPaths.emplace_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+        config.fontPaths.emplace_back("/usr/share/fonts/TTF/DejaVuSans.ttf");
+        config.fontPaths.emplace_back("/usr/share/fonts/dejavu-sans-fonts/DejaVuSans.ttf");
+        // Outline fonts only: stb_truetype cannot rasterize bitmap (CBDT) color emoji.
+        config.fallbackFontPaths = {
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/truetype/noto/NotoEmoji-Regular.ttf",
+            "/usr/share/fonts/noto/NotoEmoji-Regular.ttf",
+            "/usr/share/fonts/truetype/ancient-scripts/Symbola_hint.ttf",
+            "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+            "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+        };
+#endif
+
+        if (const char* size = args.GetValue("--font-size"))
+        {
+            const char* end = size + std::strlen(size);
+            float value = 0.0f;
+            const auto [ptr, ec] = std::from_chars(size, end, value);
+            if (ec == std::errc() && ptr == end && value > 0.0f && std::isfinite(value))
+            {
+                config.sizePixels = value;
+            }
+            else
+            {
+                TG(CoreLog, Warn, "Ignoring --font-size '{}': expected a size in pixels, keeping {}", size, config.sizePixels)
+            }
+        }
+        config.useCache = !args.HasFlag("--no-font-cache");
+        config.dynamicGlyphs = !args.HasFlag("--no-dynamic-glyphs");
+        return config;
+    }
+
+    FontLibrary& FontLibrary::Get()
+    {
+        static FontLibrary instance;
+        return instance;
+    }
+
+    void FontLibrary::Prepare(float dpiScale)
+    {
+        mPreparedAtlas = std::make_unique<ImFontAtlas>();
+        mPreparedFont = LoadAtlas(mPreparedAtlas.get(), dpiScale);
+        mPreparedScale = dpiScale;
+    }
+
+    ImFont* FontLibrary::LoadDefaultFont(float dpiScale)
+    {
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        ImFont* font = nullptr;
+        if (mPreparedFont && atlas == mPreparedAtlas.get() && mPreparedScale == dpiScale)
+        {
+            font = mPreparedFont;
+        }
+        else
+        {
+            if (atlas == mPreparedAtlas.get())
+            {
+                // The window opened on a monitor with a different scale than the primary one.
+                TG(CoreLog, Info, "Font atlas was prepared for scale {:.2f}, window has {:.2f}; rebuilding",
+                   mPreparedScale, dpiScale)
+                atlas->Clear();
+            }
+            font = LoadAtlas(atlas, dpiScale);
+        }
+
+        if (font && mConfig.dynamicGlyphs)
+        {
+            mDynamicGlyphs.Start(font, mFontPath, mConfig.fallbackFontPaths);
+        }
+        return font;
+    }
+
+    ImFont* FontLibrary::LoadAtlas(ImFontAtlas* atlas, float dpiScale)
+    {
+        TG_PROFILE_FUNCTION()
+        const auto start = std::chrono::steady_clock::now();
+
+        // Software cursors are never drawn, and their texture rects would not survive the cache.
+        atlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
+
+        mFontPath.clear();
+        mLoadedFromCache = false;
+        for (const std::string& path : mConfig.fontPaths)
+        {
+            std::error_code error;
+            if (std::filesystem::is_regular_file(path, error))
+            {
+                mFontPath = path;
+                break;
+            }
+        }
+
+        if (mFontPath.empty())
+        {
+            TG(CoreLog, Warn, "No UI font found in {} configured paths, using the built-in font", mConfig.fontPaths.size())
+            ImFont* font = atlas->AddFontDefault();
+            atlas->Build();
+            return font;
+        }
+
+        const float sizePixels = mConfig.sizePixels * dpiScale;
+        const ImWchar* ranges = mConfig.glyphRanges ? mConfig.glyphRanges : atlas->GetGlyphRangesDefault();
+
+        ImFontConfig config;
+        config.SizePixels = sizePixels;
+        config.GlyphRanges = ranges;
+        ImFormatString(config.Name, IM_ARRAYSIZE(config.Name), "%s, %.0fpx",
+                       std::filesystem::path(mFontPath).filename().string().c_str(), sizePixels);
+
+        const uint64_t key = ComputeKey(mFontPath, sizePixels, dpiScale, ranges, atlas, config);
+        char fileName[32];
+        ImFormatString(fileName, IM_ARRAYSIZE(fileName), "%016llx.tgfont", static_cast<unsigned long long>(key));
+        const std::string cachePath = (std::filesystem::path(mConfig.cacheDir) / fileName).string();
+
+        double bakeMs = 0.0;
+        if (mConfig.useCache && LoadCache(cachePath, key, atlas, config, bakeMs))
+        {
+            const double loadMs = MillisecondsSince(start);
+            mLoadedFromCache = true;
+            Profiler::SetCounter("Startup/Font Atlas (ms)", loadMs);
+            TG(CoreLog, Info, "Font atlas for {} loaded from cache in {:.2f} ms (baking took {:.1f} ms, saved {:.1f} ms)",
+               config.Name, loadMs, bakeMs, bakeMs - loadMs)
+            return atlas->Fonts.back();
+        }
+
+        ImFont* font = atlas->AddFontFromFileTTF(mFontPath.c_str(), sizePixels, &config, ranges);
+        if (!font)
+        {
+            TG(CoreLog, Warn, "Failed to load UI font {}, using the built-in font", mFontPath)
+            font = atlas->AddFontDefault();
+            atlas->Build();
+            return font;
+        }
+
+        atlas->Build();
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+        bakeMs = MillisecondsSince(start);
+        Profiler::SetCounter("Startup/Font Atlas (ms)", bakeMs);
+        TG(CoreLog, Info, "Font atlas for {} baked in {:.1f} ms ({}x{})", config.Name, bakeMs, width, height)
+
+        if (mConfig.useCache)
+        {
+            WriteCache(cachePath, key, atlas, font, bakeMs);
+        }
+        return font;
+    }
+
+    bool FontLibrary::LoadCache(const std::string& cachePath, uint64_t key, ImFontAtlas* atlas, ImFontConfig& config, double& bakeMs)
+    {
+        MappedFile file;
+        if (!file.Open(cachePath)) return false;
+
+        if (file.GetSize() < sizeof(CacheHeader)) return false;
+        CacheHeader header;
+        std::memcpy(&header, file.GetData(), sizeof(header));
+        if (header.magic != kCacheMagic || header.version != kCacheVersion || header.key != key ||
+            header.texWidth <= 0 || header.texHeight <= 0)
+        {
+            return false;
+        }
+
+        const size_t glyphBytes = static_cast<size_t>(header.glyphCount) * sizeof(CachedGlyph);
+        const size_t pixelBytes = static_cast<size_t>(header.texWidth) * header.texHeight * 4;
+        if (file.GetSize() != sizeof(CacheHeader) + glyphBytes + pixelBytes)
+        {
+            TG(CoreLog, Warn, "Ignoring truncated font cache {}", cachePath)
+            return false;
+        }
+
+        // The TTF itself is still attached (a plain read, no rasterization) so that anything
+        // that later rebuilds the atlas works exactly as without the cache.
+        size_t fontDataSize = 0;
+        void* fontData = ImFileLoadToMemory(mFontPath.c_str(), "rb", &fontDataSize, 0);
+        if (!fontData) return false;
+
+        config.FontData = fontData;
+        config.FontDataSize = static_cast<int>(fontDataSize);
+        config.FontDataOwnedByAtlas = true;
+        atlas->ConfigData.push_back(config);
+        ImFontConfig& storedConfig = atlas->ConfigData.back();
+
+        ImFont* font = IM_NEW(ImFont);
+        atlas->Fonts.push_back(font);
+        storedConfig.DstFont = font;
+        font->ContainerAtlas = atlas;
+        font->ConfigData = &storedConfig;
+        font->ConfigDataCount = 1;
+        font->FontSize = header.fontSize;
+        font->Ascent = header.ascent;
+        font->Descent = header.descent;
+
+        atlas->TexWidth = header.texWidth;
+        atlas->TexHeight = header.texHeight;
+        atlas->TexUvScale = header.texUvScale;
+        atlas->TexUvWhitePixel = header.texUvWhitePixel;
+        std::memcpy(atlas->TexUvLines, header.texUvLines, sizeof(header.texUvLines));
+
+        const uint8_t* cursor = file.GetData() + sizeof(CacheHeader);
+        font->Glyphs.reserve(static_cast<int>(header.glyphCount));
+        for (uint32_t i = 0; i < header.glyphCount; ++i)
+        {
+            CachedGlyph glyph;
+            std::memcpy(&glyph, cursor, sizeof(glyph));
+            cursor += sizeof(glyph);
+            font->AddGlyph(nullptr, static_cast<ImWchar>(glyph.codepoint), glyph.x0, glyph.y0, glyph.x1, glyph.y1,
+                           glyph.u0, glyph.v0, glyph.u1, glyph.v1, glyph.advanceX);
+            font->Glyphs.back().Colored = glyph.colored != 0;
+        }
+        font->BuildLookupTable();
+
+        // Copied out of the mapping: the atlas owns and frees its pixels.
+        atlas->TexPixelsRGBA32 = static_cast<unsigned int*>(IM_ALLOC(pixelBytes));
+        std::memcpy(atlas->TexPixelsRGBA32, cursor, pixelBytes);
+        atlas->TexReady = true;
+
+        bakeMs = header.bakeMs;
+        return true;
+    }
+
+    void FontLibrary::WriteCache(const std::string& cachePath, uint64_t key, ImFontAtlas* atlas, const ImFont* font, double bakeMs) const
+    {
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+        if (!pixels) return;
+
+        CacheHeader header{};
+        header.magic = kCacheMagic;
+        header.version = kCacheVersion;
+        header.key = key;
+        header.bakeMs = bakeMs;
+        header.texWidth = width;
+        header.texHeight = height;
+        header.texUvScale = atlas->TexUvScale;
+        header.texUvWhitePixel = atlas->TexUvWhitePixel;
+        std::memcpy(header.texUvLines, atlas->TexUvLines, sizeof(header.texUvLines));
+        header.fontSize = font->FontSize;
+        header.ascent = font->Ascent;
+        header.descent = font->Descent;
+        header.glyphCount = static_cast<uint32_t>(font->Glyphs.Size);
+
+        std::error_code error;
+        std::filesystem::create_directories(mConfig.cacheDir, error);
+
+        // Written next to the target and renamed, so a crash never leaves a torn cache behind.
+        const std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                TG(CoreLog, Warn, "Could not write font cache {}", cachePath)
+                return;
+            }
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const ImFontGlyph& glyph : font->Glyphs)
+            {
+                const CachedGlyph cached{glyph.Codepoint, glyph.Colored, glyph.AdvanceX,
+                                         glyph.X0, glyph.Y0, glyph.X1, glyph.Y1,
+                                         glyph.U0, glyph.V0, glyph.U1, glyph.V1};
+                out.write(reinterpret_cast<const char*>(&cached), sizeof(cached));
+            }
+            out.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(width) * height * 4);
+        }
+
+        if (std::ifstream(tempPath, std::ios::binary | std::ios::ate).tellg() !=
+            static_cast<std::streamoff>(sizeof(header) + font->Glyphs.Size * sizeof(CachedGlyph) + static_cast<size_t>(width) * height * 4))
+        {
+            TG(CoreLog, Warn, "Could not write font cache {}", cachePath)
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error)
+        {
+            TG(CoreLog, Warn, "Could not write font cache {}: {}", cachePath, error.message())
+            std::filesystem::remove(tempPath, error);
+        }
+    }
+}
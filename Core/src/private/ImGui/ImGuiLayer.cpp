@@ -1,6 +1,7 @@
 ﻿#include "ImGui/ImGuiLayer.h"
 #include <imgui.h>
 
+#include "Debug/Profiler.h"
 #include "TG/TGImGuiLayer.h"
 
 namespace tg
@@ -65,6 +66,34 @@ namespace tg
     {
     }
 
+    void ImGuiLayer::CollectFrameStats()
+    {
+        ImGuiFrameStats stats;
+        for (const ImGuiViewport* viewport : ImGui::GetPlatformIO().Viewports)
+        {
+            const ImDrawData* drawData = viewport->DrawData;
+            if (!drawData || !drawData->Valid) continue;
+
+            ++stats.viewports;
+            stats.drawLists += static_cast<uint32_t>(drawData->CmdListsCount);
+            stats.vertices += static_cast<uint32_t>(drawData->TotalVtxCount);
+            stats.indices += static_cast<uint32_t>(drawData->TotalIdxCount);
+            for (int i = 0; i < drawData->CmdListsCount; ++i)
+            {
+                for (const ImDrawCmd& cmd : drawData->CmdLists[i]->CmdBuffer)
+                {
+                    if (cmd.UserCallback == nullptr)
+                        ++stats.drawCalls;
+                }
+            }
+        }
+        mFrameStats = stats;
+
+        Profiler::SetCounter("ImGui/Draw Calls", mFrameStats.drawCalls);
+        Profiler::SetCounter("ImGui/Vertices", mFrameStats.vertices);
+        Profiler::SetCounter("ImGui/Indices", mFrameStats.indices);
+    }
+
     ImGuiLayer* ImGuiLayer::Create()
     {
     	return new TGImGuiLayer();
@@ -0,0 +1,285 @@
+﻿#include "ImGui/RetainedView.h"
+
+#include <atomic>
+#include <vector>
+#include <GLFW/glfw3.h>
+#include <imgui_internal.h>
+
+#include "ImGui/DrawDataSnapshot.h"
+#include "ImGui/FontLibrary.h"
+#include "TG/TGOffscreenTarget.h"
+
+namespace tg
+{
+    bool RetainedView::sSupported = false;
+    std::vector<RetainedView::Shared*> RetainedView::sOrphans;
+
+    // Everything the GL side touches. Captures are at least kSettleFrames apart, so with
+    // three slots a slot is never rewritten while a frame that references it is in flight
+    // on the render thread.
+    struct RetainedView::Shared
+    {
+        static constexpr int kSlots = 3;
+
+        struct Job
+        {
+            Shared* owner = nullptr;
+            int slot = 0;
+            uint32_t generation = 0;
+            ImVec4 clearColor;
+        };
+
+        TGOffscreenTarget target;
+        DrawDataSnapshot snapshots[kSlots];
+        Job jobs[kSlots];
+        int nextSlot = 0;
+
+        // Main thread scratch, kept to reuse its CmdLists capacity.
+        ImDrawData source;
+
+        std::atomic<uint32_t> readyGeneration{0};
+        std::atomic<intptr_t> texture{0};
+    };
+
+    namespace
+    {
+        ImDrawList* GetCaptureDrawList()
+        {
+            return ImGui::GetBackgroundDrawList(ImGui::GetMainViewport());
+        }
+
+        bool HasInputIn(ImGuiWindow* window)
+        {
+            ImGuiContext& g = *GImGui;
+            ImGuiIO& io = g.IO;
+
+            if (g.DragDropActive || ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId))
+            {
+                return true;
+            }
+            if (g.ActiveId != 0 && g.ActiveIdWindow && ImGui::IsWindowChildOf(g.ActiveIdWindow, window, false, false))
+            {
+                return true;
+            }
+
+            // Either end of a mouse move counts, so leaving the region also clears hover states.
+            const ImRect rect = window->Rect();
+            const bool mouseInside = (ImGui::IsMousePosValid(&io.MousePos) && rect.Contains(io.MousePos)) ||
+                                     (ImGui::IsMousePosValid(&io.MousePosPrev) && rect.Contains(io.MousePosPrev));
+            if (mouseInside)
+            {
+                if (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f)
+                {
+                    return true;
+                }
+                for (int button = 0; button < IM_ARRAYSIZE(io.MouseDown); ++button)
+                {
+                    if (io.MouseDown[button] || io.MouseReleased[button])
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            if (g.NavWindow && ImGui::IsWindowChildOf(g.NavWindow, window, false, false))
+            {
+                if (io.InputQueueCharacters.Size > 0)
+                {
+                    return true;
+                }
+                for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; ++key)
+                {
+                    if (ImGui::IsKeyDown(static_cast<ImGuiKey>(key)))
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool IsTooltipVisible()
+        {
+            ImGuiWindow* tooltip = ImGui::FindWindowByName("##Tooltip_00");
+            return tooltip && tooltip->Active;
+        }
+
+        void CollectDrawLists(ImGuiWindow* window, ImDrawData& out)
+        {
+            if (!window->Active || window->Hidden) return;
+
+            // Same order ImGui uses when it builds the viewport's draw data.
+            ImDrawList* drawList = window->DrawList;
+            if (drawList->CmdBuffer.Size > 0 && drawList->IdxBuffer.Size > 0)
+            {
+                out.CmdLists.push_back(drawList);
+                out.TotalVtxCount += drawList->VtxBuffer.Size;
+                out.TotalIdxCount += drawList->IdxBuffer.Size;
+            }
+            for (ImGuiWindow* child : window->DC.ChildWindows)
+            {
+                CollectDrawLists(child, out);
+            }
+        }
+    }
+
+    // Draw callbacks run inside ImGui_ImplOpenGL3_RenderDrawData on whichever thread owns
+    // the main context. They sit in the main viewport's background draw list, which carries
+    // no geometry here, so the nested render cannot clobber vertices the outer pass still needs.
+    void RetainedView::RenderCapture(const ImDrawList*, const ImDrawCmd* cmd)
+    {
+        auto* job = static_cast<Shared::Job*>(cmd->UserCallbackData);
+        auto* owner = job->owner;
+        owner->target.Render(owner->snapshots[job->slot].GetDrawData(), job->clearColor);
+        owner->texture.store((intptr_t)owner->target.GetTextureID(), std::memory_order_relaxed);
+        owner->readyGeneration.store(job->generation, std::memory_order_release);
+    }
+
+    void RetainedView::ReleaseCapture(const ImDrawList*, const ImDrawCmd* cmd)
+    {
+        auto* shared = static_cast<Shared*>(cmd->UserCallbackData);
+        shared->target.Release();
+        delete shared;
+    }
+
+    RetainedView::~RetainedView()
+    {
+        Release();
+    }
+
+    void RetainedView::Release()
+    {
+        Invalidate();
+        if (!mShared) return;
+
+        ReleaseShared(mShared);
+        mShared = nullptr;
+    }
+
+    void RetainedView::ReleaseOrphans()
+    {
+        std::vector<Shared*> orphans;
+        orphans.swap(sOrphans);
+        for (Shared* shared : orphans)
+        {
+            ReleaseShared(shared);
+        }
+    }
+
+    void RetainedView::ReleaseShared(Shared* shared)
+    {
+        ImGuiContext* context = ImGui::GetCurrentContext();
+        if (context && context->WithinFrameScope)
+        {
+            // The GL objects have to die on the render side, after every frame that still uses them.
+            GetCaptureDrawList()->AddCallback(ReleaseCapture, shared);
+            GetCaptureDrawList()->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        }
+        else if (glfwGetCurrentContext())
+        {
+            // Rendering happens on this thread and is finished, so no frame uses them any more.
+            shared->target.Release();
+            delete shared;
+        }
+        else if (sSupported)
+        {
+            // The render thread owns the context and may still be drawing a frame that uses
+            // them; the next frame releases them.
+            sOrphans.push_back(shared);
+        }
+        else
+        {
+            // The renderer is gone and its context took the GL objects with it.
+            delete shared;
+        }
+    }
+
+    bool RetainedView::DrawCached(bool contentDirty)
+    {
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        const ImRect rect = window->InnerRect;
+        const ImVec2 size = rect.GetSize();
+
+        // Newly paged-in glyphs change how the same text renders.
+        const uint32_t glyphGeneration = FontLibrary::Get().GetGlyphGeneration();
+        mLiveQuiet = sSupported && !contentDirty && size.x == mSize.x && size.y == mSize.y &&
+                     glyphGeneration == mGlyphGeneration && !HasInputIn(window);
+        mSize = size;
+        mGlyphGeneration = glyphGeneration;
+        if (!mLiveQuiet)
+        {
+            Invalidate();
+            return false;
+        }
+
+        // A capture may still be queued on the render thread; stay live until it lands.
+        if (!mCached || mShared->readyGeneration.load(std::memory_order_acquire) != mGeneration)
+        {
+            return false;
+        }
+
+        const ImTextureID texture = (ImTextureID)mShared->texture.load(std::memory_order_relaxed);
+        window->DrawList->AddImage(texture, rect.Min, rect.Max, ImVec2(0, 1), ImVec2(1, 0));
+
+        // Keep the content size so scrollbars and the scroll position survive cached frames.
+        ImGui::Dummy(mContentSize);
+        return true;
+    }
+
+    void RetainedView::EndLive()
+    {
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        mContentSize = ImVec2(window->DC.CursorMaxPos.x - window->DC.CursorStartPos.x,
+                              window->DC.CursorMaxPos.y - window->DC.CursorStartPos.y);
+
+        if (!mLiveQuiet || mCached) return;
+
+        if (IsTooltipVisible())
+        {
+            mQuietFrames = 0;
+            return;
+        }
+        if (++mQuietFrames < kSettleFrames) return;
+
+        if (!mShared)
+        {
+            mShared = new Shared();
+        }
+        Shared& shared = *mShared;
+
+        const ImRect rect = window->InnerRect;
+        ImDrawData& source = shared.source;
+        source.Clear();
+        CollectDrawLists(window, source);
+        source.Valid = true;
+        source.CmdListsCount = source.CmdLists.Size;
+        source.DisplayPos = rect.Min;
+        source.DisplaySize = rect.GetSize();
+        source.FramebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+        source.OwnerViewport = nullptr;
+
+        const int slot = shared.nextSlot;
+        shared.nextSlot = (slot + 1) % Shared::kSlots;
+        shared.snapshots[slot].Capture(&source);
+
+        // The content area is see-through; what shows behind it is the host window background.
+        ImVec4 clearColor = ImGui::GetStyleColorVec4(ImGuiCol_WindowBg);
+        clearColor.w = 1.0f;
+
+        Shared::Job& job = shared.jobs[slot];
+        job.owner = &shared;
+        job.slot = slot;
+        job.generation = ++mGeneration;
+        job.clearColor = clearColor;
+
+        GetCaptureDrawList()->AddCallback(RenderCapture, &job);
+        GetCaptureDrawList()->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        mCached = true;
+    }
+
+    void RetainedView::Invalidate()
+    {
+        mCached = false;
+        mQuietFrames = 0;
+    }
+}
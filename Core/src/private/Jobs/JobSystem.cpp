@@ -0,0 +1,382 @@
+﻿#include "Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "Base/App.h"
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    struct Job
+    {
+        std::function<void()> work;
+        JobPriority priority = JobPriority::Normal;
+        // One extra count is held by Schedule() until all dependencies are wired up.
+        std::atomic<uint32_t> unmetDependencies{1};
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Job>> continuations;
+        std::atomic<bool> done{false};
+    };
+
+    namespace
+    {
+        thread_local int tWorkerIndex = -1;
+
+        constexpr int kLowLane = static_cast<int>(JobPriority::Low);
+        constexpr uint64_t kStatsIntervalNs = 500'000'000;
+    }
+
+    bool JobHandle::IsDone() const
+    {
+        return !mJob || mJob->done.load(std::memory_order_acquire);
+    }
+
+    JobSystem& JobSystem::Get()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    void JobSystem::Init(uint32_t workerCount)
+    {
+        if (IsRunning()) return;
+
+        if (workerCount == 0)
+        {
+            if (const char* value = App::GetCommandLineArgs().GetValue("--job-workers"))
+            {
+                const char* end = value + std::strlen(value);
+                const auto [ptr, ec] = std::from_chars(value, end, workerCount);
+                if (ec != std::errc() || ptr != end)
+                {
+                    TG(CoreLog, Warn, "Ignoring --job-workers '{}': expected a worker count", value)
+                    workerCount = 0;
+                }
+            }
+        }
+        if (workerCount == 0)
+        {
+            // hardware_concurrency() may report 0 when it cannot tell.
+            workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        }
+        // A single worker would be all Low work may take, so there are always two.
+        workerCount = std::max(2u, workerCount);
+
+        mStopRequested = false;
+        mMaxLowRunning = workerCount - 1;
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->name = "Job Worker " + std::to_string(i);
+            worker->counterName = "Jobs/Worker " + std::to_string(i) + " Busy (%)";
+            mWorkers.push_back(std::move(worker));
+        }
+        // Started after the vector is complete; workers steal from each other by index.
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            mWorkers[i]->thread = std::thread(&JobSystem::WorkerMain, this, i);
+        }
+
+        TG(CoreLog, Info, "Job system started with {} workers", workerCount)
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if (!IsRunning()) return;
+
+        {
+            std::lock_guard lock(mSleepMutex);
+            mStopRequested = true;
+        }
+        mWake.notify_all();
+        for (auto& worker : mWorkers)
+        {
+            worker->thread.join();
+        }
+
+        uint32_t dropped = 0;
+        for (int lane = 0; lane < kLaneCount; ++lane)
+        {
+            dropped += mQueued[lane].exchange(0);
+            mInjected.queues[lane].clear();
+        }
+        mWorkers.clear();
+
+        if (dropped > 0)
+        {
+            TG(CoreLog, Warn, "Job system stopped with {} jobs still queued", dropped)
+        }
+    }
+
+    JobHandle JobSystem::Schedule(std::function<void()> work, JobPriority priority)
+    {
+        return Schedule(std::move(work), priority, {});
+    }
+
+    JobHandle JobSystem::Schedule(std::function<void()> work, JobPriority priority, std::span<const JobHandle> dependencies)
+    {
+        auto job = std::make_shared<Job>();
+        job->work = std::move(work);
+        job->priority = priority;
+
+        for (const JobHandle& dependency : dependencies)
+        {
+            if (!dependency.mJob) continue;
+
+            Job& before = *dependency.mJob;
+            std::lock_guard lock(before.mutex);
+            if (!before.done.load(std::memory_order_relaxed))
+            {
+                job->unmetDependencies.fetch_add(1, std::memory_order_relaxed);
+                before.continuations.push_back(job);
+            }
+        }
+
+        Release(job);
+        return JobHandle(std::move(job));
+    }
+
+    JobHandle JobSystem::Then(const JobHandle& dependency, std::function<void()> work, JobPriority priority)
+    {
+        return Schedule(std::move(work), priority, std::span(&dependency, 1));
+    }
+
+    JobHandle JobSystem::ParallelFor(size_t count, size_t batchSize, std::function<void(size_t begin, size_t end)> fn,
+                                     JobPriority priority)
+    {
+        batchSize = std::max<size_t>(1, batchSize);
+        auto shared = std::make_shared<std::function<void(size_t, size_t)>>(std::move(fn));
+
+        std::vector<JobHandle> batches;
+        batches.reserve((count + batchSize - 1) / batchSize);
+        for (size_t begin = 0; begin < count; begin += batchSize)
+        {
+            const size_t end = std::min(count, begin + batchSize);
+            batches.push_back(Schedule([shared, begin, end] { (*shared)(begin, end); }, priority));
+        }
+        return Schedule([] {}, priority, batches);
+    }
+
+    void JobSystem::Wait(const JobHandle& handle)
+    {
+        TG_PROFILE_FUNCTION()
+        while (!handle.IsDone())
+        {
+            if (JobRef job = TryPop(tWorkerIndex))
+            {
+                Execute(job, tWorkerIndex);
+            }
+            else if (!IsRunning())
+            {
+                // Dropped by Shutdown(), or waiting on a job that was; it will never run.
+                return;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::PublishStats()
+    {
+        const uint64_t now = Profiler::NowNs();
+        if (mLastStatsNs == 0)
+        {
+            mLastStatsNs = now;
+            return;
+        }
+        const uint64_t elapsed = now - mLastStatsNs;
+        if (elapsed < kStatsIntervalNs) return;
+
+        for (auto& worker : mWorkers)
+        {
+            const uint64_t busy = worker->busyNs.load(std::memory_order_relaxed);
+            const double percent = 100.0 * static_cast<double>(busy - worker->lastBusyNs) / static_cast<double>(elapsed);
+            worker->lastBusyNs = busy;
+            Profiler::SetCounter(worker->counterName, std::min(percent, 100.0));
+        }
+        Profiler::SetCounter("Jobs/Queued High", mQueued[0].load(std::memory_order_relaxed));
+        Profiler::SetCounter("Jobs/Queued Normal", mQueued[1].load(std::memory_order_relaxed));
+        Profiler::SetCounter("Jobs/Queued Low", mQueued[2].load(std::memory_order_relaxed));
+        mLastStatsNs = now;
+    }
+
+    void JobSystem::WorkerMain(uint32_t index)
+    {
+        tWorkerIndex = static_cast<int>(index);
+        Profiler::SetThreadName(mWorkers[index]->name.c_str());
+
+        for (;;)
+        {
+            if (JobRef job = TryPop(tWorkerIndex))
+            {
+                Execute(job, tWorkerIndex);
+                continue;
+            }
+
+            std::unique_lock lock(mSleepMutex);
+            mWake.wait(lock, [this] { return mStopRequested || HasRunnableWork(); });
+            if (mStopRequested) return;
+        }
+    }
+
+    void JobSystem::Release(const JobRef& job)
+    {
+        if (job->unmetDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Enqueue(job);
+        }
+    }
+
+    void JobSystem::Enqueue(JobRef job)
+    {
+        // Without workers (not started, or a tool that never starts them) jobs run inline.
+        if (!IsRunning())
+        {
+            Execute(job, -1);
+            return;
+        }
+
+        const int lane = static_cast<int>(job->priority);
+        // Counted before it is visible, so a thief can never take the count below zero.
+        {
+            std::lock_guard lock(mSleepMutex);
+            mQueued[lane].fetch_add(1, std::memory_order_relaxed);
+        }
+        Lanes& lanes = tWorkerIndex >= 0 ? mWorkers[tWorkerIndex]->lanes : mInjected;
+        {
+            std::lock_guard lock(lanes.mutex);
+            lanes.queues[lane].push_back(std::move(job));
+        }
+        mWake.notify_one();
+    }
+
+    JobSystem::JobRef JobSystem::TryPop(int workerIndex)
+    {
+        for (int lane = 0; lane < kLaneCount; ++lane)
+        {
+            if (mQueued[lane].load(std::memory_order_relaxed) == 0) continue;
+
+            // Workers keep one slot free of bulk work; a thread helping in Wait() is not a worker.
+            const bool limited = lane == kLowLane && workerIndex >= 0;
+            if (limited)
+            {
+                uint32_t running = mLowRunning.load(std::memory_order_relaxed);
+                do
+                {
+                    if (running >= mMaxLowRunning) return nullptr;
+                } while (!mLowRunning.compare_exchange_weak(running, running + 1, std::memory_order_relaxed));
+            }
+
+            if (JobRef job = TryPopLane(workerIndex, lane))
+            {
+                return job;
+            }
+            if (limited)
+            {
+                mLowRunning.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        return nullptr;
+    }
+
+    JobSystem::JobRef JobSystem::TryPopLane(int workerIndex, int lane)
+    {
+        const auto take = [this, lane](Lanes& lanes, bool newest) -> JobRef
+        {
+            std::lock_guard lock(lanes.mutex);
+            std::deque<JobRef>& queue = lanes.queues[lane];
+            if (queue.empty()) return nullptr;
+
+            JobRef job;
+            if (newest)
+            {
+                job = std::move(queue.back());
+                queue.pop_back();
+            }
+            else
+            {
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            mQueued[lane].fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        };
+
+        if (workerIndex >= 0)
+        {
+            if (JobRef job = take(mWorkers[workerIndex]->lanes, true)) return job;
+        }
+        if (JobRef job = take(mInjected, false)) return job;
+
+        const size_t count = mWorkers.size();
+        const size_t first = workerIndex >= 0 ? static_cast<size_t>(workerIndex) + 1 : 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t victim = (first + i) % count;
+            if (static_cast<int>(victim) == workerIndex) continue;
+            if (JobRef job = take(mWorkers[victim]->lanes, false)) return job;
+        }
+        return nullptr;
+    }
+
+    void JobSystem::Execute(const JobRef& job, int workerIndex)
+    {
+        const uint64_t startNs = workerIndex >= 0 ? Profiler::NowNs() : 0;
+        {
+            TG_PROFILE_SCOPE("Job")
+            try
+            {
+                job->work();
+            }
+            catch (const std::exception& e)
+            {
+                TG(CoreLog, Error, "Job threw: {}", e.what())
+            }
+            catch (...)
+            {
+                TG(CoreLog, Error, "Job threw an unknown exception")
+            }
+        }
+
+        std::vector<JobRef> continuations;
+        {
+            std::lock_guard lock(job->mutex);
+            job->done.store(true, std::memory_order_release);
+            continuations.swap(job->continuations);
+        }
+        // Captured state can be large; do not keep it alive through outstanding handles.
+        job->work = nullptr;
+
+        for (const JobRef& next : continuations)
+        {
+            Release(next);
+        }
+
+        if (workerIndex < 0) return;
+
+        mWorkers[workerIndex]->busyNs.fetch_add(Profiler::NowNs() - startNs, std::memory_order_relaxed);
+        if (job->priority == JobPriority::Low)
+        {
+            mLowRunning.fetch_sub(1, std::memory_order_relaxed);
+            if (mQueued[kLowLane].load(std::memory_order_relaxed) > 0)
+            {
+                // A worker may be asleep only because the bulk slots were full.
+                { std::lock_guard lock(mSleepMutex); }
+                mWake.notify_one();
+            }
+        }
+    }
+
+    bool JobSystem::HasRunnableWork() const
+    {
+        return mQueued[0].load(std::memory_order_relaxed) > 0 ||
+               mQueued[1].load(std::memory_order_relaxed) > 0 ||
+               (mQueued[kLowLane].load(std::memory_order_relaxed) > 0 &&
+                mLowRunning.load(std::memory_order_relaxed) < mMaxLowRunning);
+    }
+}
@@ -0,0 +1,94 @@
+﻿#include "Jobs/MainThreadDispatcher.h"
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    MainThreadDispatcher& MainThreadDispatcher::Get()
+    {
+        static MainThreadDispatcher instance;
+        return instance;
+    }
+
+    void MainThreadDispatcher::Post(std::function<void()> task, DispatchPriority priority)
+    {
+        {
+            std::lock_guard lock(mMutex);
+            mIncoming[static_cast<int>(priority)].push_back({std::move(task), mFrame});
+        }
+        if (auto* wake = mWakeHandler.load())
+        {
+            wake();
+        }
+    }
+
+    uint32_t MainThreadDispatcher::Drain()
+    {
+        TG_PROFILE_FUNCTION()
+        {
+            std::lock_guard lock(mMutex);
+            ++mFrame;
+            for (int lane = 0; lane < kLaneCount; ++lane)
+            {
+                std::deque<Task>& incoming = mIncoming[lane];
+                if (incoming.empty()) continue;
+
+                if (mPending[lane].empty())
+                {
+                    mPending[lane].swap(incoming);
+                }
+                else
+                {
+                    for (Task& task : incoming)
+                    {
+                        mPending[lane].push_back(std::move(task));
+                    }
+                    incoming.clear();
+                }
+            }
+        }
+
+        const uint64_t startNs = Profiler::NowNs();
+        const uint64_t budgetNs = static_cast<uint64_t>(std::chrono::nanoseconds(mBudget).count());
+        uint32_t ran = 0;
+
+        const auto runFront = [this, &ran](std::deque<Task>& lane)
+        {
+            std::function<void()> fn = std::move(lane.front().fn);
+            lane.pop_front();
+            fn();
+            ++ran;
+        };
+
+        for (int lane = 0; lane < kLaneCount; ++lane)
+        {
+            std::deque<Task>& pending = mPending[lane];
+            const bool unbudgeted = lane == static_cast<int>(DispatchPriority::Critical);
+            while (!pending.empty() && (unbudgeted || Profiler::NowNs() - startNs < budgetNs))
+            {
+                runFront(pending);
+            }
+        }
+
+        // Out of budget: only tasks that have waited too long still run.
+        for (int lane = 1; lane < kLaneCount; ++lane)
+        {
+            std::deque<Task>& pending = mPending[lane];
+            while (!pending.empty() && mFrame - pending.front().postedFrame >= kMaxWaitFrames)
+            {
+                runFront(pending);
+            }
+        }
+
+        mBacklog = 0;
+        for (const std::deque<Task>& pending : mPending)
+        {
+            mBacklog += pending.size();
+        }
+
+        Profiler::SetCounter("Main Thread/Dispatch (us)", static_cast<double>(Profiler::NowNs() - startNs) / 1000.0);
+        Profiler::SetCounter("Main Thread/Dispatch Tasks", ran);
+        Profiler::SetCounter("Main Thread/Dispatch Backlog", static_cast<double>(mBacklog));
+        return ran;
+    }
+}
@@ -0,0 +1,285 @@
+﻿#include "Memory/AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+
+#ifdef TG_TRACK_ALLOCATIONS
+#include <imgui.h>
+#endif
+
+namespace tg
+{
+    namespace
+    {
+        constexpr const char* kMemoryTagNames[] = {
+            "Untagged", "ImGui", "Panels", "Chats", "Messages", "Textures", "Logs"
+        };
+        static_assert(std::size(kMemoryTagNames) == static_cast<size_t>(MemoryTag::Count));
+
+        // Padded so threads charging different tags do not share a cache line.
+        struct alignas(64) TagCounters
+        {
+            std::atomic<int64_t> liveBytes{0};
+            std::atomic<int64_t> peakBytes{0};
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> allocatedBytes{0};
+        };
+
+        thread_local uint64_t tThreadAllocations = 0;
+        std::atomic<uint64_t> sTotalAllocations{0};
+
+        [[maybe_unused]] thread_local MemoryTag tMemoryTag = MemoryTag::Untagged;
+        TagCounters sTagCounters[static_cast<size_t>(MemoryTag::Count)];
+        TagCounters sTotalCounters;
+
+        MemoryTagStats ReadCounters(const TagCounters& counters)
+        {
+            return { counters.liveBytes.load(std::memory_order_relaxed), counters.peakBytes.load(std::memory_order_relaxed),
+                     counters.allocations.load(std::memory_order_relaxed), counters.allocatedBytes.load(std::memory_order_relaxed) };
+        }
+
+        void RaisePeak(TagCounters& counters, int64_t live)
+        {
+            int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+            while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        }
+
+        [[maybe_unused]] void Charge(MemoryTag tag, int64_t bytes)
+        {
+            for (TagCounters* counters : { &sTagCounters[static_cast<size_t>(tag)], &sTotalCounters })
+            {
+                const int64_t live = counters->liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+                if (bytes > 0)
+                {
+                    counters->allocations.fetch_add(1, std::memory_order_relaxed);
+                    counters->allocatedBytes.fetch_add(static_cast<uint64_t>(bytes), std::memory_order_relaxed);
+                    RaisePeak(*counters, live);
+                }
+            }
+        }
+    }
+
+    const char* GetMemoryTagName(MemoryTag tag)
+    {
+        return tag < MemoryTag::Count ? kMemoryTagNames[static_cast<size_t>(tag)] : "?";
+    }
+
+    uint64_t AllocationTracker::GetThreadAllocationCount()
+    {
+        return tThreadAllocations;
+    }
+
+    uint64_t AllocationTracker::GetTotalAllocationCount()
+    {
+        return sTotalAllocations.load(std::memory_order_relaxed);
+    }
+
+    MemoryTagStats AllocationTracker::GetTagStats(MemoryTag tag)
+    {
+        return tag < MemoryTag::Count ? ReadCounters(sTagCounters[static_cast<size_t>(tag)]) : MemoryTagStats{};
+    }
+
+    MemoryTagStats AllocationTracker::GetTotalStats()
+    {
+        return ReadCounters(sTotalCounters);
+    }
+
+    void AllocationTracker::ResetPeaks()
+    {
+        for (TagCounters& counters : sTagCounters)
+        {
+            counters.peakBytes.store(counters.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        sTotalCounters.peakBytes.store(sTotalCounters.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+#ifdef TG_TRACK_ALLOCATIONS
+    void AllocationTracker::RecordExternal(MemoryTag tag, int64_t bytes)
+    {
+        Charge(tag, bytes);
+    }
+
+    MemoryTagScope::MemoryTagScope(MemoryTag tag)
+        : mPrevious(tMemoryTag)
+    {
+        tMemoryTag = tag;
+    }
+
+    MemoryTagScope::~MemoryTagScope()
+    {
+        tMemoryTag = mPrevious;
+    }
+#endif
+}
+
+#ifdef TG_TRACK_ALLOCATIONS
+
+namespace
+{
+    // Sits right before every block handed out. `offset` leads back to the start of the
+    // underlying allocation, which for over-aligned blocks is a whole alignment earlier.
+    struct BlockHeader
+    {
+        uint64_t size;
+        uint32_t offset;
+        tg::MemoryTag tag;
+    };
+    constexpr std::size_t kHeaderSize = 16;
+    static_assert(sizeof(BlockHeader) <= kHeaderSize && kHeaderSize % alignof(std::max_align_t) == 0);
+
+    void CountAllocation()
+    {
+        ++tg::tThreadAllocations;
+        tg::sTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* FinishBlock(void* base, std::size_t offset, std::size_t size, tg::MemoryTag tag)
+    {
+        void* p = static_cast<char*>(base) + offset;
+        *reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - kHeaderSize) = { size, static_cast<uint32_t>(offset), tag };
+        tg::Charge(tag, static_cast<int64_t>(size));
+        return p;
+    }
+
+    // Returns the start of the underlying allocation.
+    void* ReleaseBlock(void* p)
+    {
+        const BlockHeader& header = *reinterpret_cast<const BlockHeader*>(static_cast<char*>(p) - kHeaderSize);
+        tg::Charge(header.tag, -static_cast<int64_t>(header.size));
+        return static_cast<char*>(p) - header.offset;
+    }
+
+    void* TaggedAlloc(std::size_t size, tg::MemoryTag tag)
+    {
+        if (size > SIZE_MAX - kHeaderSize) return nullptr;
+        for (;;)
+        {
+            if (void* base = std::malloc(kHeaderSize + size)) return FinishBlock(base, kHeaderSize, size, tag);
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) return nullptr;
+            handler();
+        }
+    }
+
+    void TaggedFree(void* p)
+    {
+        if (p) std::free(ReleaseBlock(p));
+    }
+
+    void* TrackedAlloc(std::size_t size)
+    {
+        CountAllocation();
+        return TaggedAlloc(size, tg::tMemoryTag);
+    }
+
+    void* TrackedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+    {
+        CountAllocation();
+        // The header takes a whole alignment step so the block stays aligned.
+        const std::size_t align = static_cast<std::size_t>(alignment);
+        const std::size_t offset = std::max(align, kHeaderSize);
+        if (size > SIZE_MAX - 2 * offset) return nullptr;
+        const std::size_t total = (offset + size + align - 1) & ~(align - 1);
+        for (;;)
+        {
+#ifdef _WIN32
+            if (void* base = _aligned_malloc(total, align)) return FinishBlock(base, offset, size, tg::tMemoryTag);
+#else
+            if (void* base = std::aligned_alloc(align, total)) return FinishBlock(base, offset, size, tg::tMemoryTag);
+#endif
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) return nullptr;
+            handler();
+        }
+    }
+
+    void TrackedAlignedFree(void* p)
+    {
+        if (!p) return;
+#ifdef _WIN32
+        _aligned_free(ReleaseBlock(p));
+#else
+        std::free(ReleaseBlock(p));
+#endif
+    }
+
+    void* ImGuiAlloc(std::size_t size, void*)
+    {
+        return TaggedAlloc(size, tg::MemoryTag::ImGui);
+    }
+
+    void ImGuiFree(void* p, void*)
+    {
+        TaggedFree(p);
+    }
+
+    // ImGui blocks freed through these must also come from them, and the font atlas is
+    // baked on a worker before the context exists, so the hooks go in before main().
+    [[maybe_unused]] const bool sImGuiHooksInstalled = []
+    {
+        ImGui::SetAllocatorFunctions(&ImGuiAlloc, &ImGuiFree);
+        return true;
+    }();
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* p = TrackedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* p = TrackedAlignedAlloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TrackedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TrackedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* p) noexcept { TaggedFree(p); }
+void operator delete[](void* p) noexcept { TaggedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { TaggedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { TaggedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { TaggedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { TaggedFree(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { TrackedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { TrackedAlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { TrackedAlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { TrackedAlignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { TrackedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { TrackedAlignedFree(p); }
+
+#endif
@@ -0,0 +1,111 @@
+﻿#include "Memory/FrameArena.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    namespace
+    {
+        constexpr size_t kBlockAlignment = 64;
+
+        std::byte* AllocateBlock(size_t size)
+        {
+            return static_cast<std::byte*>(::operator new(size, std::align_val_t{kBlockAlignment}));
+        }
+
+        void FreeBlock(std::byte* block)
+        {
+            ::operator delete(block, std::align_val_t{kBlockAlignment});
+        }
+
+        size_t AlignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    FrameArena& FrameArena::Get()
+    {
+        static FrameArena instance;
+        return instance;
+    }
+
+    FrameArena::FrameArena(size_t capacity)
+        : mBuffer(AllocateBlock(capacity)), mCapacity(capacity)
+    {
+    }
+
+    FrameArena::~FrameArena()
+    {
+        for (const Block& block : mOverflow)
+        {
+            FreeBlock(block.data);
+        }
+        FreeBlock(mBuffer);
+    }
+
+    void* FrameArena::Allocate(size_t size, size_t alignment)
+    {
+        const size_t offset = AlignUp(mOffset, alignment);
+        if (offset + size <= mCapacity)
+        {
+            mOffset = offset + size;
+            return mBuffer + offset;
+        }
+        return AllocateOverflow(size, alignment);
+    }
+
+    void* FrameArena::AllocateOverflow(size_t size, size_t alignment)
+    {
+        if (!mOverflow.empty())
+        {
+            const Block& block = mOverflow.back();
+            const size_t offset = AlignUp(mOverflowOffset, alignment);
+            if (offset + size <= block.size)
+            {
+                mOverflowUsed += offset + size - mOverflowOffset;
+                mOverflowOffset = offset + size;
+                return block.data + offset;
+            }
+        }
+
+        const size_t blockSize = std::max(mCapacity / 2, AlignUp(size, kBlockAlignment));
+        mOverflow.push_back({AllocateBlock(blockSize), blockSize});
+        mOverflowOffset = size;
+        mOverflowUsed += size;
+        return mOverflow.back().data;
+    }
+
+    void FrameArena::Reset()
+    {
+        const size_t used = GetUsed();
+        mPeak = std::max(mPeak, used);
+
+        if (!mOverflow.empty())
+        {
+            for (const Block& block : mOverflow)
+            {
+                FreeBlock(block.data);
+            }
+            mOverflow.clear();
+            mOverflowOffset = 0;
+            mOverflowUsed = 0;
+
+            // Padding lands differently once everything is in one buffer, so leave some headroom.
+            const size_t capacity = std::bit_ceil(used + used / 4);
+            TG(CoreLog, Info, "Frame arena grown from {} KB to {} KB", mCapacity / 1024, capacity / 1024)
+            FreeBlock(mBuffer);
+            mBuffer = AllocateBlock(capacity);
+            mCapacity = capacity;
+        }
+
+        mOffset = 0;
+
+        Profiler::SetCounter("Memory/Frame Arena Used (KB)", static_cast<double>(used) / 1024.0);
+        Profiler::SetCounter("Memory/Frame Arena Capacity (KB)", static_cast<double>(mCapacity) / 1024.0);
+    }
+}
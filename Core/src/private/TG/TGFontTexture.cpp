@@ -0,0 +1,36 @@
+﻿#include "TG/TGFontTexture.h"
+
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace tg
+{
+    void TGFontTexture::Upload(ImTextureID texture, int width, int height, int y, int rows, const void* pixels, bool resize)
+    {
+        const auto name = static_cast<GLuint>((intptr_t)texture);
+        if (!name || !pixels) return;
+
+        GLint lastTexture = 0;
+        GLint lastRowLength = 0;
+        GLint lastAlignment = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &lastRowLength);
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &lastAlignment);
+
+        glBindTexture(GL_TEXTURE_2D, name);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (resize)
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, lastRowLength);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, lastAlignment);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(lastTexture));
+    }
+}
@@ -0,0 +1,113 @@
+﻿#include "TG/TGGpuTimer.h"
+
+#include <cstdio>
+#include <glad/glad.h>
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    void TGGpuTimer::Begin(uint32_t viewportID, bool isMainViewport)
+    {
+        QueryRing& ring = mRings[viewportID];
+        if (!ring.initialized)
+        {
+            glGenQueries(kQueryCount, ring.queries);
+            ring.initialized = true;
+
+            ViewportStats& stats = mStats[viewportID];
+            if (isMainViewport)
+            {
+                stats.counterName = "GPU/Main Viewport (ms)";
+            }
+            else
+            {
+                char name[64];
+                std::snprintf(name, sizeof(name), "GPU/Viewport %08X (ms)", viewportID);
+                stats.counterName = name;
+            }
+        }
+
+        Collect(viewportID, ring);
+
+        if (ring.pending[ring.writeIndex])
+        {
+            // Oldest query still in flight: skip timing rather than stall.
+            ++mStats[viewportID].skippedFrames;
+            ring.active = false;
+            return;
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, ring.queries[ring.writeIndex]);
+        ring.active = true;
+    }
+
+    void TGGpuTimer::End(uint32_t viewportID)
+    {
+        auto it = mRings.find(viewportID);
+        if (it == mRings.end() || !it->second.active) return;
+
+        QueryRing& ring = it->second;
+        glEndQuery(GL_TIME_ELAPSED);
+        ring.pending[ring.writeIndex] = true;
+        ring.writeIndex = (ring.writeIndex + 1) % kQueryCount;
+        ring.active = false;
+    }
+
+    void TGGpuTimer::Collect(uint32_t viewportID, QueryRing& ring)
+    {
+        ViewportStats& stats = mStats[viewportID];
+
+        // Read in submission order, oldest first, and stop at the first unfinished query.
+        for (uint32_t i = 0; i < kQueryCount; ++i)
+        {
+            const uint32_t index = (ring.writeIndex + i) % kQueryCount;
+            if (!ring.pending[index]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(ring.queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(ring.queries[index], GL_QUERY_RESULT, &elapsedNs);
+            ring.pending[index] = false;
+
+            stats.lastMs = static_cast<double>(elapsedNs) / 1.0e6;
+            stats.averageMs = stats.measuredFrames == 0 ? stats.lastMs : stats.averageMs * 0.95 + stats.lastMs * 0.05;
+            ++stats.measuredFrames;
+        }
+    }
+
+    void TGGpuTimer::Release(uint32_t viewportID)
+    {
+        auto it = mRings.find(viewportID);
+        if (it != mRings.end() && it->second.initialized)
+        {
+            glDeleteQueries(kQueryCount, it->second.queries);
+        }
+        Forget(viewportID);
+    }
+
+    void TGGpuTimer::Forget(uint32_t viewportID)
+    {
+        auto it = mStats.find(viewportID);
+        if (it != mStats.end())
+        {
+            Profiler::SetCounter(it->second.counterName, 0.0);
+            mStats.erase(it);
+        }
+        mRings.erase(viewportID);
+    }
+
+    void TGGpuTimer::Publish()
+    {
+        double totalMs = 0.0;
+        for (const auto& [viewportID, stats] : mStats)
+        {
+            Profiler::SetCounter(stats.counterName, stats.lastMs);
+            totalMs += stats.lastMs;
+        }
+        Profiler::SetCounter("GPU/Total (ms)", totalMs);
+        Profiler::SetCounter("GPU/Timed Viewports", static_cast<double>(mStats.size()));
+    }
+}
@@ -1,11 +1,22 @@
 ﻿#include "TG/TGImGuiLayer.h"
 #include <glad/glad.h>
 #include "Base/App.h"
+#include "Base/Log.h"
 #include "Base/Window.h"
+#include "Debug/Profiler.h"
+#include "ImGui/FontLibrary.h"
+#include "ImGui/RetainedView.h"
 
 
 namespace tg
 {
+    namespace
+    {
+        TGImGuiLayer* sTimedLayer = nullptr;
+        void (*sOriginalRenderWindow)(ImGuiViewport*, void*) = nullptr;
+        void (*sOriginalDestroyWindow)(ImGuiViewport*) = nullptr;
+    }
+
     TGImGuiLayer::TGImGuiLayer()
     {
     }
@@ -16,13 +27,29 @@ namespace tg
 
     TGImGuiLayer::~TGImGuiLayer()
     {
+        // Normally done by OnDetach; a layer destroyed without it must not leave the thread
+        // running into static destruction.
+        StopRenderThread();
     }
 
     void TGImGuiLayer::Begin()
     {
-        ImGui_ImplOpenGL3_NewFrame();
+        FontLibrary& fonts = FontLibrary::Get();
+        fonts.BeginFrame();
+
+        if (mHasRenderer)
+        {
+            ImGui_ImplOpenGL3_NewFrame();
+        }
         ImGui_ImplGlfw_NewFrame();
+        if (mFixedDeltaTime > 0.0f)
+        {
+            ImGui::GetIO().DeltaTime = mFixedDeltaTime;
+        }
         ImGui::NewFrame();
+
+        fonts.QueueTextureUploads();
+        RetainedView::ReleaseOrphans();
     }
 
     void TGImGuiLayer::End()
@@ -32,26 +59,69 @@ namespace tg
         auto [width, height] = app.GetWindow().GetSize();
         io.DisplaySize = ImVec2(float(width), float(height));
 
-        //TODO: Render to swapchain... how do we handle this better?
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
         // Rendering
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        CollectFrameStats();
+
+        if (!mHasRenderer)
+        {
+            // Null renderer: the frame is fully built and counted, nothing is submitted.
+            return;
+        }
+
+        if (mRenderThread)
+        {
+            mRenderThread->Submit(ImGui::GetDrawData());
+            return;
+        }
+
+        RenderMainViewport(ImGui::GetDrawData());
 
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
+            TG_PROFILE_SCOPE("RenderPlatformWindows")
             GLFWwindow* backup_current_context = glfwGetCurrentContext();
             ImGui::UpdatePlatformWindows();
             ImGui::RenderPlatformWindowsDefault();
             glfwMakeContextCurrent(backup_current_context);
         }
+
+        mGpuTimer.Publish();
+    }
+
+    void TGImGuiLayer::RenderMainViewport(ImDrawData* drawData)
+    {
+        TG_PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData")
+        //TODO: Render to swapchain... how do we handle this better?
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        const ImGuiID mainViewportID = drawData->OwnerViewport ? drawData->OwnerViewport->ID : 0;
+        mGpuTimer.Begin(mainViewportID, true);
+        ImGui_ImplOpenGL3_RenderDrawData(drawData);
+        mGpuTimer.End(mainViewportID);
+    }
+
+    void TGImGuiLayer::RenderWindowTimed(ImGuiViewport* viewport, void* renderArg)
+    {
+        // Platform_RenderWindow has already made this viewport's context current.
+        sTimedLayer->mGpuTimer.Begin(viewport->ID, false);
+        sOriginalRenderWindow(viewport, renderArg);
+        sTimedLayer->mGpuTimer.End(viewport->ID);
+    }
+
+    void TGImGuiLayer::DestroyWindowTimed(ImGuiViewport* viewport)
+    {
+        // The viewport's context (and its queries) is destroyed with the window.
+        sTimedLayer->mGpuTimer.Forget(viewport->ID);
+        sOriginalDestroyWindow(viewport);
     }
 
     void TGImGuiLayer::OnAttach()
     {
         IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
+        // Borrows the atlas baked during startup, if there is one.
+        FontLibrary& fonts = FontLibrary::Get();
+        ImGui::CreateContext(fonts.GetPreparedAtlas());
         ImGuiIO& io = ImGui::GetIO(); (void)io;
         io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
         //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
@@ -60,12 +130,6 @@ namespace tg
         //io.ConfigViewportsNoAutoMerge = true;
         //io.ConfigViewportsNoTaskBarIcon = true;
 
-        {
-            io.FontDefault = io.Fonts->AddFontFromFileTTF(R"(C:\Windows\Fonts\segoeui.ttf)", 18.0f);
-            if (!io.FontDefault)
-                io.FontDefault = io.Fonts->AddFontDefault();
-        }
-
         ImGui::StyleColorsDark();
         SetDarkThemeV2Colors();
 
@@ -80,13 +144,114 @@ namespace tg
         App& app = App::Get();
         GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
 
-        ImGui_ImplGlfw_InitForOpenGL(window, true);
-        ImGui_ImplOpenGL3_Init("#version 410");
+        {
+            float dpiScale = 1.0f;
+            glfwGetWindowContentScale(window, &dpiScale, nullptr);
+            if (!fonts.GetPreparedAtlas())
+            {
+                fonts.SetConfig(FontLibraryConfig::FromCommandLine());
+            }
+            io.FontDefault = fonts.LoadDefaultFont(dpiScale > 0.0f ? dpiScale : 1.0f);
+        }
+
+        if (app.GetWindow().IsHeadless())
+        {
+            // No desktop to spawn platform windows on.
+            io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+            io.IniFilename = nullptr;
+        }
+
+        mHasRenderer = app.GetWindow().HasRenderContext();
+        RetainedView::SetSupported(mHasRenderer);
+
+        // Platform windows create and render through their own contexts on the main
+        // thread, so the render thread is limited to the main viewport.
+        const bool useRenderThread = mHasRenderer && App::GetCommandLineArgs().HasFlag("--render-thread");
+        if (useRenderThread)
+        {
+            io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+        }
+
+        if (mHasRenderer)
+        {
+            ImGui_ImplGlfw_InitForOpenGL(window, true);
+            ImGui_ImplOpenGL3_Init("#version 410");
+        }
+        else
+        {
+            ImGui_ImplGlfw_InitForOther(window, true);
+
+            // Mirror what the GL backend sets up so frame building (and the counts) is identical.
+            io.BackendRendererName = "tg_null_renderer";
+            io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+            unsigned char* pixels = nullptr;
+            int texWidth = 0, texHeight = 0;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &texWidth, &texHeight);
+        }
+
+        if (mHasRenderer && (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable))
+        {
+            ImGuiPlatformIO& platformIO = ImGui::GetPlatformIO();
+            sTimedLayer = this;
+            sOriginalRenderWindow = platformIO.Renderer_RenderWindow;
+            sOriginalDestroyWindow = platformIO.Platform_DestroyWindow;
+            platformIO.Renderer_RenderWindow = RenderWindowTimed;
+            platformIO.Platform_DestroyWindow = DestroyWindowTimed;
+        }
+
+        if (useRenderThread)
+        {
+            // Create the shader and font texture while the context is still current here,
+            // so ImGui_ImplOpenGL3_NewFrame never touches GL from the main thread.
+            ImGui_ImplOpenGL3_CreateDeviceObjects();
+            glfwMakeContextCurrent(nullptr);
+
+            const int swapInterval = app.GetWindow().IsVSync() ? 1 : 0;
+            mRenderThread = std::make_unique<TGRenderThread>(window, swapInterval, [this](ImDrawData* drawData)
+            {
+                RenderMainViewport(drawData);
+                mGpuTimer.Publish();
+            });
+            mRenderThread->Start();
+            TG(CoreLog, Info, "ImGui rendering on a dedicated render thread")
+        }
+    }
+
+    void TGImGuiLayer::StopRenderThread()
+    {
+        if (!mRenderThread) return;
+
+        // Renders the frame still pending, joins, and hands the context back to this thread.
+        mRenderThread->Stop();
+        mRenderThread.reset();
+        glfwMakeContextCurrent(static_cast<GLFWwindow*>(App::Get().GetWindow().GetNativeWindow()));
+        TG(CoreLog, Info, "Render thread stopped")
     }
 
     void TGImGuiLayer::OnDetach()
     {
-        ImGui_ImplOpenGL3_Shutdown();
+        StopRenderThread();
+
+        // With the context current here, views released between the last frame and now are freed.
+        RetainedView::ReleaseOrphans();
+        RetainedView::SetSupported(false);
+        if (mHasRenderer)
+        {
+            mGpuTimer.Release(ImGui::GetMainViewport()->ID);
+        }
+        if (sTimedLayer == this)
+        {
+            ImGuiPlatformIO& platformIO = ImGui::GetPlatformIO();
+            platformIO.Renderer_RenderWindow = sOriginalRenderWindow;
+            platformIO.Platform_DestroyWindow = sOriginalDestroyWindow;
+            sTimedLayer = nullptr;
+        }
+
+        FontLibrary::Get().Shutdown();
+        if (mHasRenderer)
+        {
+            ImGui_ImplOpenGL3_Shutdown();
+        }
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
     }
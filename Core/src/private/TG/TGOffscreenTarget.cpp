@@ -0,0 +1,91 @@
+﻿#include "TG/TGOffscreenTarget.h"
+
+#include <glad/glad.h>
+
+#ifndef IMGUI_IMPL_API
+#define IMGUI_IMPL_API
+#endif
+#include "backends/imgui_impl_opengl3.h"
+
+#include "Base/Log.h"
+#include "Memory/AllocationTracker.h"
+
+namespace tg
+{
+    void TGOffscreenTarget::Render(ImDrawData* drawData, const ImVec4& clearColor)
+    {
+        if (!drawData) return;
+
+        const int width = static_cast<int>(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+        const int height = static_cast<int>(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+        if (width <= 0 || height <= 0) return;
+
+        GLint lastFramebuffer = 0;
+        GLint lastViewport[4];
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &lastFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, lastViewport);
+
+        if (width != mWidth || height != mHeight)
+        {
+            Resize(width, height);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glViewport(0, 0, width, height);
+        glDisable(GL_SCISSOR_TEST);
+        glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // Backs up and restores all other GL state itself.
+        ImGui_ImplOpenGL3_RenderDrawData(drawData);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(lastFramebuffer));
+        glViewport(lastViewport[0], lastViewport[1], lastViewport[2], lastViewport[3]);
+    }
+
+    void TGOffscreenTarget::Resize(int width, int height)
+    {
+        if (!mFramebuffer)
+        {
+            glGenFramebuffers(1, &mFramebuffer);
+            glGenTextures(1, &mTexture);
+        }
+
+        GLint lastTexture = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+
+        glBindTexture(GL_TEXTURE_2D, mTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(lastTexture));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            TG(CoreLog, Error, "Offscreen framebuffer incomplete ({}x{})", width, height)
+        }
+
+        // RGBA8, replacing the previous storage
+        AllocationTracker::RecordExternal(MemoryTag::Textures, 4 * (int64_t{width} * height - int64_t{mWidth} * mHeight));
+        mWidth = width;
+        mHeight = height;
+    }
+
+    void TGOffscreenTarget::Release()
+    {
+        if (mFramebuffer)
+        {
+            glDeleteFramebuffers(1, &mFramebuffer);
+            glDeleteTextures(1, &mTexture);
+            AllocationTracker::RecordExternal(MemoryTag::Textures, -4 * int64_t{mWidth} * mHeight);
+        }
+        mFramebuffer = 0;
+        mTexture = 0;
+        mWidth = 0;
+        mHeight = 0;
+    }
+}
@@ -0,0 +1,101 @@
+﻿#include "TG/TGRenderThread.h"
+
+#include <GLFW/glfw3.h>
+
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    TGRenderThread::TGRenderThread(GLFWwindow* window, int swapInterval, RenderFn render)
+    : mWindow(window), mSwapInterval(swapInterval), mRender(std::move(render))
+    {
+    }
+
+    TGRenderThread::~TGRenderThread()
+    {
+        Stop();
+    }
+
+    void TGRenderThread::Start()
+    {
+        if (mThread.joinable()) return;
+
+        mStopRequested = false;
+        mThread = std::thread(&TGRenderThread::ThreadMain, this);
+    }
+
+    void TGRenderThread::Stop()
+    {
+        if (!mThread.joinable()) return;
+
+        {
+            std::lock_guard lock(mMutex);
+            mStopRequested = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+
+    void TGRenderThread::Submit(const ImDrawData* drawData)
+    {
+        TG_PROFILE_FUNCTION()
+        {
+            std::unique_lock lock(mMutex);
+            mCondition.wait(lock, [this]
+            {
+                return mPendingIndex == -1 && mRenderingIndex != mWriteIndex;
+            });
+        }
+
+        // Neither pending nor being rendered, so the render thread cannot touch it.
+        mSnapshots[mWriteIndex].Capture(drawData);
+
+        {
+            std::lock_guard lock(mMutex);
+            mPendingIndex = mWriteIndex;
+            mWriteIndex ^= 1;
+        }
+        mCondition.notify_all();
+    }
+
+    void TGRenderThread::ThreadMain()
+    {
+        Profiler::SetThreadName("Render");
+        glfwMakeContextCurrent(mWindow);
+        glfwSwapInterval(mSwapInterval);
+
+        while (true)
+        {
+            {
+                std::unique_lock lock(mMutex);
+                mCondition.wait(lock, [this] { return mPendingIndex != -1 || mStopRequested; });
+                if (mPendingIndex == -1)
+                {
+                    break;
+                }
+                mRenderingIndex = mPendingIndex;
+                mPendingIndex = -1;
+            }
+            mCondition.notify_all();
+
+            {
+                TG_PROFILE_SCOPE("RenderThread::Frame")
+                if (ImDrawData* drawData = mSnapshots[mRenderingIndex].GetDrawData())
+                {
+                    mRender(drawData);
+                }
+
+                TG_PROFILE_SCOPE("RenderThread::SwapBuffers")
+                glfwSwapBuffers(mWindow);
+            }
+
+            {
+                std::lock_guard lock(mMutex);
+                mRenderingIndex = -1;
+            }
+            mCondition.notify_all();
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    }
+}
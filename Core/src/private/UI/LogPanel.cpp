@@ -0,0 +1,321 @@
+﻿#include "UI/LogPanel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <ctime>
+#include "spdlog/details/os.h"
+
+#include "Base/BinaryLog.h"
+#include "Base/Log.h"
+#include "Base/LogRing.h"
+#include "Debug/Profiler.h"
+#include "Memory/FixedString.h"
+
+namespace tg
+{
+    namespace
+    {
+        // Per update; a full rescan of a million lines spreads over a few dozen frames.
+        constexpr uint64_t kScanBudgetNs = 2'000'000;
+        // Items between clock reads while scanning.
+        constexpr uint32_t kScanBatch = 256;
+
+        char ToLower(char c)
+        {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        std::string ToLower(std::string_view text)
+        {
+            std::string lower(text);
+            std::ranges::transform(lower, lower.begin(), [](char c) { return ToLower(c); });
+            return lower;
+        }
+
+        bool ContainsIgnoreCase(std::string_view text, std::string_view lowerNeedle)
+        {
+            if (lowerNeedle.empty()) return true;
+            return !std::ranges::search(text, lowerNeedle, [](char a, char b) { return ToLower(a) == b; }).empty();
+        }
+
+        ImVec4 GetLevelColor(spdlog::level::level_enum level)
+        {
+            switch (level)
+            {
+            case spdlog::level::trace:
+            case spdlog::level::debug:    return ImVec4(0.55f, 0.55f, 0.55f, 1.0f);
+            case spdlog::level::warn:     return ImVec4(0.95f, 0.8f, 0.3f, 1.0f);
+            case spdlog::level::err:      return ImVec4(0.95f, 0.4f, 0.4f, 1.0f);
+            case spdlog::level::critical: return ImVec4(1.0f, 0.2f, 0.2f, 1.0f);
+            default:                      return ImGui::GetStyleColorVec4(ImGuiCol_Text);
+            }
+        }
+
+        std::string_view GetFileName(const char* path)
+        {
+            if (!path) return {};
+            const std::string_view view(path);
+            const size_t slash = view.find_last_of("/\\");
+            return slash == std::string_view::npos ? view : view.substr(slash + 1);
+        }
+    }
+
+    LogPanel::LogPanel(const std::string& name)
+        : Panel(name, "📜")
+    {
+    }
+
+    bool LogPanel::Filter::Narrows(const Filter& previous) const
+    {
+        return minLevel >= previous.minLevel && (loggerMask & ~previous.loggerMask) == 0 &&
+               text.find(previous.text) != std::string::npos;
+    }
+
+    bool LogPanel::Filter::Matches(const LogLine& line) const
+    {
+        return line.level >= minLevel && line.logger < 32 && (loggerMask >> line.logger & 1) != 0 &&
+               ContainsIgnoreCase(line.GetText(), text);
+    }
+
+    void LogPanel::SetFilter(Filter filter)
+    {
+        if (filter.Narrows(mFilter))
+        {
+            // Matches so far plus those not yet re-tested, still in index order.
+            std::vector<uint64_t> candidates(mMatches.begin(), mMatches.end());
+            candidates.insert(candidates.end(), mCandidates.begin() + static_cast<ptrdiff_t>(mCandidatePos), mCandidates.end());
+            mCandidates = std::move(candidates);
+        }
+        else
+        {
+            mCandidates.clear();
+            mScanned = 0;
+        }
+        mCandidatePos = 0;
+        mMatches.clear();
+        mFilter = std::move(filter);
+    }
+
+    void LogPanel::Scan(uint64_t budgetNs)
+    {
+        const LogRing* ring = Log::GetRing();
+        if (!ring) return;
+
+        TG_PROFILE_FUNCTION()
+        const uint64_t deadline = Profiler::NowNs() + budgetNs;
+        const uint64_t first = std::max(ring->GetFirstIndex(), mClearedBefore);
+        while (!mMatches.empty() && mMatches.front() < first)
+        {
+            mMatches.pop_front();
+        }
+
+        LogLine line;
+        uint32_t batch = 0;
+        const auto outOfTime = [&]
+        {
+            if (++batch < kScanBatch) return false;
+            batch = 0;
+            return Profiler::NowNs() >= deadline;
+        };
+
+        while (mCandidatePos < mCandidates.size())
+        {
+            const uint64_t index = mCandidates[mCandidatePos++];
+            if (index >= first && ring->Read(index, line) && mFilter.Matches(line))
+            {
+                mMatches.push_back(index);
+            }
+            if (outOfTime()) return;
+        }
+        mCandidates.clear();
+        mCandidatePos = 0;
+
+        mScanned = std::max(mScanned, first);
+        const uint64_t end = ring->GetEndIndex();
+        while (mScanned < end)
+        {
+            if (!ring->Read(mScanned, line))
+            {
+                // Either overwritten already, or claimed by a writer that is not done yet.
+                if (mScanned >= ring->GetFirstIndex()) break;
+            }
+            else if (mFilter.Matches(line))
+            {
+                mMatches.push_back(mScanned);
+            }
+            ++mScanned;
+            if (outOfTime()) return;
+        }
+    }
+
+    void LogPanel::OnUpdate(TimeStep ts)
+    {
+        Scan(kScanBudgetNs);
+    }
+
+    void LogPanel::OnRender()
+    {
+        TG_PROFILE_FUNCTION()
+        const LogRing* ring = Log::GetRing();
+        if (!ring)
+        {
+            ImGui::TextDisabled("The in-memory log is off (--log-view-lines 0).");
+            return;
+        }
+
+        RenderToolbar();
+        ImGui::Separator();
+        RenderLines();
+    }
+
+    void LogPanel::RenderToolbar()
+    {
+        const LogRing& ring = *Log::GetRing();
+        Filter filter = mFilter;
+
+        ImGui::SetNextItemWidth(110.0f);
+        const spdlog::string_view_t levelName = spdlog::level::to_string_view(filter.minLevel);
+        if (ImGui::BeginCombo("##level", levelName.data()))
+        {
+            for (int level = spdlog::level::trace; level < spdlog::level::off; ++level)
+            {
+                const auto value = static_cast<spdlog::level::level_enum>(level);
+                if (ImGui::Selectable(spdlog::level::to_string_view(value).data(), value == filter.minLevel))
+                {
+                    filter.minLevel = value;
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        const std::vector<std::string>& loggers = ring.GetLoggerNames();
+        for (size_t i = 0; i < loggers.size() && i < 32; ++i)
+        {
+            ImGui::SameLine();
+            bool enabled = (filter.loggerMask >> i & 1) != 0;
+            if (ImGui::Checkbox(loggers[i].c_str(), &enabled))
+            {
+                filter.loggerMask ^= 1u << i;
+            }
+        }
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(220.0f);
+        if (ImGui::InputTextWithHint("##filter", "Filter", mSearchBuffer, sizeof(mSearchBuffer)))
+        {
+            filter.text = ToLower(mSearchBuffer);
+        }
+
+        if (filter.minLevel != mFilter.minLevel || filter.loggerMask != mFilter.loggerMask || filter.text != mFilter.text)
+        {
+            SetFilter(std::move(filter));
+            // Show the result this frame rather than after the next update.
+            Scan(kScanBudgetNs);
+            RequestSave();
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Auto-scroll", &mAutoScroll))
+        {
+            RequestSave();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear"))
+        {
+            mClearedBefore = ring.GetEndIndex();
+            mMatches.clear();
+            mCandidates.clear();
+            mCandidatePos = 0;
+        }
+
+        ImGui::SameLine();
+        const uint64_t retained = ring.GetEndIndex() - std::max(ring.GetFirstIndex(), mClearedBefore);
+        if (mCandidatePos < mCandidates.size() || mScanned + kScanBatch < ring.GetEndIndex())
+        {
+            ImGui::TextDisabled("%zu of %llu lines (filtering...)", mMatches.size(), static_cast<unsigned long long>(retained));
+        }
+        else
+        {
+            ImGui::TextDisabled("%zu of %llu lines", mMatches.size(), static_cast<unsigned long long>(retained));
+        }
+        if (BinaryLog::IsEnabled())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(binary log: only warnings and errors)");
+        }
+    }
+
+    void LogPanel::RenderLines()
+    {
+        const LogRing& ring = *Log::GetRing();
+        const std::vector<std::string>& loggers = ring.GetLoggerNames();
+
+        ImGui::BeginChild("##lines", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+
+        LogLine line;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(std::min<size_t>(mMatches.size(), INT32_MAX)));
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                if (!ring.Read(mMatches[static_cast<size_t>(row)], line))
+                {
+                    ImGui::TextDisabled("(overwritten)");
+                    continue;
+                }
+
+                const std::tm time = spdlog::details::os::localtime(static_cast<std::time_t>(line.timeNs / 1'000'000'000));
+                FixedString<384> text;
+                text.AppendFormat("{:02}:{:02}:{:02}.{:03}  {:<6} {}:{}  ", time.tm_hour, time.tm_min, time.tm_sec,
+                                  line.timeNs / 1'000'000 % 1000,
+                                  line.logger < loggers.size() ? std::string_view(loggers[line.logger]) : std::string_view("?"),
+                                  GetFileName(line.file), line.line);
+                text.Append(line.GetText());
+
+                ImGui::PushStyleColor(ImGuiCol_Text, GetLevelColor(line.level));
+                ImGui::TextUnformatted(text.CStr(), text.CStr() + text.GetSize());
+                ImGui::PopStyleColor();
+            }
+        }
+        clipper.End();
+
+        if (mAutoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+        {
+            ImGui::SetScrollHereY(1.0f);
+        }
+        ImGui::EndChild();
+    }
+
+    void LogPanel::OnSaveState(BinaryWriter& writer) const
+    {
+        writer.Write(static_cast<uint8_t>(mFilter.minLevel));
+        writer.Write(mFilter.loggerMask);
+        writer.WriteString(mSearchBuffer);
+        writer.Write(mAutoScroll);
+    }
+
+    void LogPanel::OnRestore(BinaryReader& reader)
+    {
+        Filter filter;
+        filter.minLevel = static_cast<spdlog::level::level_enum>(std::min<uint8_t>(reader.Read<uint8_t>(), spdlog::level::critical));
+        filter.loggerMask = reader.Read<uint32_t>();
+        const std::string search = reader.ReadString();
+        std::snprintf(mSearchBuffer, sizeof(mSearchBuffer), "%s", search.c_str());
+        filter.text = ToLower(mSearchBuffer);
+        mAutoScroll = reader.Read<bool>();
+        if (!reader.IsValid()) return;
+
+        SetFilter(std::move(filter));
+    }
+
+    void LogPanel::OnHibernate()
+    {
+        // Rebuilt by the scan once restored.
+        std::deque<uint64_t>().swap(mMatches);
+        std::vector<uint64_t>().swap(mCandidates);
+        mCandidatePos = 0;
+        mScanned = 0;
+    }
+}
@@ -1,7 +1,43 @@
 ﻿#include "UI/Panel.h"
 
+#include "Base/Log.h"
+#include "Memory/AllocationTracker.h"
 
 namespace tg
 {
     uint32_t Panel::sNextID = 0;
+
+    void Panel::Hibernate()
+    {
+        if (mIsHibernated || !CanHibernate()) return;
+
+        BinaryWriter writer;
+        OnSaveState(writer);
+        mHibernatedState = writer.TakeBuffer();
+        OnHibernate();
+        mRetainedView.Release();
+        mIsHibernated = true;
+
+        TG(CoreLog, Info, "Panel '{}' hibernated ({} bytes kept)", mName, mHibernatedState.size())
+    }
+
+    void Panel::Restore()
+    {
+        if (!mIsHibernated) return;
+
+        TG_MEMORY_TAG(Panels)
+        BinaryReader reader(mHibernatedState);
+        OnRestore(reader);
+        if (!reader.IsValid())
+        {
+            TG(CoreLog, Warn, "Panel '{}' restored from truncated hibernation state", mName)
+        }
+
+        std::vector<uint8_t>().swap(mHibernatedState);
+        mIsHibernated = false;
+        mSaveRequested = false; // nothing new to save yet
+        mIdleSeconds = 0.0f;
+        mPendingUpdateSeconds = 0.0f;
+        Invalidate();
+    }
 }
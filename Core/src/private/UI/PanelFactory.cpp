@@ -0,0 +1,49 @@
+﻿#include "UI/PanelFactory.h"
+
+#include <algorithm>
+
+#include "Base/Log.h"
+#include "UI/Panel.h"
+
+namespace tg
+{
+    PanelFactory& PanelFactory::Get()
+    {
+        static PanelFactory instance;
+        return instance;
+    }
+
+    void PanelFactory::Register(PanelType type)
+    {
+        auto it = std::ranges::find(mTypes, type.typeId, &PanelType::typeId);
+        if (it != mTypes.end())
+        {
+            *it = std::move(type);
+            return;
+        }
+        mTypes.push_back(std::move(type));
+    }
+
+    const PanelType* PanelFactory::Find(std::string_view typeId) const
+    {
+        auto it = std::ranges::find(mTypes, typeId, &PanelType::typeId);
+        return it != mTypes.end() ? &*it : nullptr;
+    }
+
+    std::shared_ptr<Panel> PanelFactory::Create(std::string_view typeId, const std::string& name) const
+    {
+        const PanelType* type = Find(typeId);
+        if (!type || !type->create)
+        {
+            TG(CoreLog, Error, "Unknown panel type: {}", typeId)
+            return nullptr;
+        }
+
+        std::shared_ptr<Panel> panel = type->create(name);
+        if (panel)
+        {
+            panel->SetTypeId(type->typeId);
+        }
+        return panel;
+    }
+}
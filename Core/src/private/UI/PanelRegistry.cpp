@@ -0,0 +1,130 @@
+﻿#include "UI/PanelRegistry.h"
+
+#include "UI/Panel.h"
+
+namespace tg
+{
+    PanelHandle PanelRegistry::Add(std::shared_ptr<Panel> panel)
+    {
+        if (!panel || mByName.contains(panel->GetName())) return {};
+
+        uint32_t index;
+        if (!mFreeSlots.empty())
+        {
+            index = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(mSlots.size());
+            mSlots.emplace_back();
+        }
+
+        Slot& slot = mSlots[index];
+        const PanelHandle handle{index, slot.generation};
+        slot.orderIndex = static_cast<uint32_t>(mOrder.size());
+        mOrder.push_back(handle);
+        mByName.emplace(panel->GetName(), index);
+
+        panel->SetHandle(handle);
+        slot.panel = std::move(panel);
+        return handle;
+    }
+
+    bool PanelRegistry::Remove(PanelHandle handle)
+    {
+        if (!Resolve(handle)) return false;
+
+        Slot& slot = mSlots[handle.index];
+        mByName.erase(slot.panel->GetName());
+
+        mOrder.erase(mOrder.begin() + slot.orderIndex);
+        for (size_t i = slot.orderIndex; i < mOrder.size(); ++i)
+        {
+            mSlots[mOrder[i].index].orderIndex = static_cast<uint32_t>(i);
+        }
+
+        slot.panel->SetHandle({});
+        slot.panel.reset();
+        ++slot.generation;
+        mFreeSlots.push_back(handle.index);
+        return true;
+    }
+
+    bool PanelRegistry::Replace(PanelHandle handle, std::shared_ptr<Panel> panel)
+    {
+        if (!panel || !Resolve(handle)) return false;
+
+        Slot& slot = mSlots[handle.index];
+        if (panel->GetName() != slot.panel->GetName())
+        {
+            if (mByName.contains(panel->GetName())) return false;
+            mByName.erase(slot.panel->GetName());
+            mByName.emplace(panel->GetName(), handle.index);
+        }
+
+        slot.panel->SetHandle({});
+        panel->SetHandle(handle);
+        slot.panel = std::move(panel);
+        return true;
+    }
+
+    void PanelRegistry::Clear()
+    {
+        for (Slot& slot : mSlots)
+        {
+            if (slot.panel)
+            {
+                slot.panel->SetHandle({});
+            }
+        }
+        mSlots.clear();
+        mFreeSlots.clear();
+        mOrder.clear();
+        mByName.clear();
+    }
+
+    Panel* PanelRegistry::Get(PanelHandle handle) const
+    {
+        const Slot* slot = Resolve(handle);
+        return slot ? slot->panel.get() : nullptr;
+    }
+
+    std::shared_ptr<Panel> PanelRegistry::GetShared(PanelHandle handle) const
+    {
+        const Slot* slot = Resolve(handle);
+        return slot ? slot->panel : nullptr;
+    }
+
+    PanelHandle PanelRegistry::Find(std::string_view name) const
+    {
+        auto it = mByName.find(name);
+        if (it == mByName.end()) return {};
+
+        return {it->second, mSlots[it->second].generation};
+    }
+
+    size_t PanelRegistry::GetOrderIndex(PanelHandle handle) const
+    {
+        const Slot* slot = Resolve(handle);
+        return slot ? slot->orderIndex : mOrder.size();
+    }
+
+    void PanelRegistry::Swap(PanelHandle a, PanelHandle b)
+    {
+        if (!Resolve(a) || !Resolve(b)) return;
+
+        Slot& slotA = mSlots[a.index];
+        Slot& slotB = mSlots[b.index];
+        std::swap(mOrder[slotA.orderIndex], mOrder[slotB.orderIndex]);
+        std::swap(slotA.orderIndex, slotB.orderIndex);
+    }
+
+    const PanelRegistry::Slot* PanelRegistry::Resolve(PanelHandle handle) const
+    {
+        if (handle.index >= mSlots.size()) return nullptr;
+
+        const Slot& slot = mSlots[handle.index];
+        return (slot.generation == handle.generation && slot.panel) ? &slot : nullptr;
+    }
+}
@@ -0,0 +1,114 @@
+﻿#include "UI/SessionWriter.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Base/App.h"
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+
+namespace tg
+{
+    SessionConfig SessionConfig::FromCommandLine()
+    {
+        SessionConfig config;
+        const CommandLineArgs& args = App::GetCommandLineArgs();
+        if (const char* path = args.GetValue("--session"))
+        {
+            config.path = path;
+        }
+        config.enabled = !args.HasFlag("--no-session");
+        return config;
+    }
+
+    SessionWriter::~SessionWriter()
+    {
+        Stop();
+    }
+
+    void SessionWriter::Start(const std::string& path)
+    {
+        if (mThread.joinable()) return;
+
+        mPath = path;
+        mStopRequested = false;
+        mThread = std::thread(&SessionWriter::WorkerMain, this);
+    }
+
+    void SessionWriter::Post(std::vector<uint8_t> snapshot)
+    {
+        {
+            std::lock_guard lock(mMutex);
+            mPending = std::move(snapshot);
+            mHasPending = true;
+        }
+        mCondition.notify_one();
+    }
+
+    void SessionWriter::Stop()
+    {
+        if (!mThread.joinable()) return;
+
+        {
+            std::lock_guard lock(mMutex);
+            mStopRequested = true;
+        }
+        mCondition.notify_one();
+        mThread.join();
+    }
+
+    void SessionWriter::WorkerMain()
+    {
+        Profiler::SetThreadName("Session Writer");
+
+        std::unique_lock lock(mMutex);
+        for (;;)
+        {
+            mCondition.wait(lock, [this] { return mHasPending || mStopRequested; });
+            if (!mHasPending) return;
+
+            std::vector<uint8_t> snapshot = std::move(mPending);
+            mHasPending = false;
+
+            lock.unlock();
+            {
+                TG_PROFILE_SCOPE("SessionWriter::WriteFile")
+                WriteFile(mPath, snapshot);
+            }
+            lock.lock();
+        }
+    }
+
+    bool SessionWriter::WriteFile(const std::string& path, const std::vector<uint8_t>& bytes)
+    {
+        std::error_code error;
+        const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty())
+        {
+            std::filesystem::create_directories(parent, error);
+        }
+
+        // Written next to the target and renamed, so a crash never leaves a torn session behind.
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!out.flush())
+            {
+                TG(CoreLog, Warn, "Could not write session {}", path)
+                out.close();
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            TG(CoreLog, Warn, "Could not write session {}: {}", path, error.message())
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+}
@@ -1,33 +1,159 @@
 ﻿#include "UI/TabManager.h"
 
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "Base/App.h"
 #include "Base/Log.h"
+#include "Base/MappedFile.h"
+#include "Debug/Profiler.h"
+#include "ImGui/FontLibrary.h"
+#include "Memory/AllocationTracker.h"
+#include "Memory/FixedString.h"
+#include "UI/PanelFactory.h"
 
 namespace tg
 {
+    namespace
+    {
+        // Stands in for a tab opened by type until it is first shown.
+        class PendingPanel final : public Panel
+        {
+        public:
+            PendingPanel(const std::string& name, const PanelType& type, std::vector<uint8_t> state)
+            : Panel(name, type.icon), mState(std::move(state))
+            {
+                mTypeId = type.typeId;
+            }
+
+            void OnRender() override
+            {
+                ImGui::TextDisabled("Panel type '%s' is not available.", mTypeId.c_str());
+            }
+
+            std::vector<uint8_t> mState;
+        };
+
+        constexpr uint32_t kSessionMagic = 0x53534754; // "TGSS"
+        constexpr uint32_t kSessionVersion = 1;
+
+        // Leaves value as it is unless the whole argument is a finite number.
+        void ReadFloatArg(const char* flag, float& value)
+        {
+            if (const char* text = App::GetCommandLineArgs().GetValue(flag))
+            {
+                const char* end = text + std::strlen(text);
+                float parsed = 0.0f;
+                const auto [ptr, ec] = std::from_chars(text, end, parsed);
+                if (ec == std::errc() && ptr == end && std::isfinite(parsed))
+                {
+                    value = parsed;
+                }
+                else
+                {
+                    TG(CoreLog, Warn, "Ignoring {} '{}': expected a number, keeping {}", flag, text, value)
+                }
+            }
+        }
+    }
+
+    TabLifecycleConfig TabLifecycleConfig::FromCommandLine()
+    {
+        TabLifecycleConfig config;
+        ReadFloatArg("--background-update-hz", config.backgroundUpdateHz);
+        ReadFloatArg("--hibernate-after", config.hibernateAfterSeconds);
+        return config;
+    }
+
     void TabManager::Init()
     {
-        TG(CoreLog, Info, "TabManager initialized")
+        mLifecycle = TabLifecycleConfig::FromCommandLine();
+        mSessionConfig = SessionConfig::FromCommandLine();
+        if (mSessionConfig.enabled)
+        {
+            mSessionWriter.Start(mSessionConfig.path);
+        }
+        TG(CoreLog, Info, "TabManager initialized (background updates {} Hz, hibernate after {} s)",
+           mLifecycle.backgroundUpdateHz, mLifecycle.hibernateAfterSeconds)
     }
 
-    void TabManager::Shutdown()
+    void TabManager::Update(TimeStep ts)
     {
-        for (auto& panel : mPanels)
+        TG_PROFILE_FUNCTION()
+        const float backgroundInterval = mLifecycle.backgroundUpdateHz > 0.0f ? 1.0f / mLifecycle.backgroundUpdateHz : 0.0f;
+        int hibernated = 0;
+
+        for (PanelHandle handle : mRegistry.GetOrder())
         {
-            if (panel)
+            Panel* panel = mRegistry.Get(handle);
+            if (std::exchange(panel->mSaveRequested, false))
             {
-                panel->OnDetach();
+                MarkSessionDirty();
+            }
+            if (panel->IsHibernated())
+            {
+                ++hibernated;
+                continue;
+            }
+
+            if (IsVisible(panel))
+            {
+                panel->mIdleSeconds = 0.0f;
+                panel->mPendingUpdateSeconds = 0.0f;
+                panel->OnUpdate(ts);
+                continue;
+            }
+
+            panel->mIdleSeconds += ts.GetSeconds();
+            if (backgroundInterval <= 0.0f) continue;
+
+            panel->mPendingUpdateSeconds += ts.GetSeconds();
+            if (panel->mPendingUpdateSeconds >= backgroundInterval)
+            {
+                panel->OnUpdate(TimeStep(panel->mPendingUpdateSeconds));
+                panel->mPendingUpdateSeconds = 0.0f;
+            }
+        }
+
+        if (mSessionDirty && mSessionConfig.enabled)
+        {
+            mSecondsSinceChange += ts.GetSeconds();
+            if (mSecondsSinceChange >= mSessionConfig.saveDelaySeconds)
+            {
+                SaveSession();
             }
         }
-        mPanels.clear();
+
+        Profiler::SetCounter("Tabs/Open", static_cast<double>(mRegistry.Size()));
+        Profiler::SetCounter("Tabs/Hibernated", static_cast<double>(hibernated));
+    }
+
+    void TabManager::Shutdown()
+    {
+        if (mSessionConfig.enabled)
+        {
+            SaveSession();
+            mSessionWriter.Stop();
+        }
+        
+        for (PanelHandle handle : mRegistry.GetOrder())
+        {
+            mRegistry.Get(handle)->OnDetach();
+        }
+        mRegistry.Clear();
+        mPendingCloses.clear();
         mActivePanel = nullptr;
     }
 
     void TabManager::Render()
     {
+        TG_PROFILE_FUNCTION()
+        HibernateIdlePanels();
         RenderDetachedWindows();
         
-        bool hasAttachedPanels = std::ranges::any_of(mPanels,
-                                                     [](const auto& panel) { return panel && !panel->IsDetached(); });
+        bool hasAttachedPanels = std::ranges::any_of(mRegistry.GetOrder(),
+                                                     [this](PanelHandle handle) { return !mRegistry.Get(handle)->IsDetached(); });
         
         ImGuiWindowFlags windowFlags = ImGuiWindowFlags_NoTitleBar | 
                                       ImGuiWindowFlags_NoCollapse | 
@@ -58,13 +184,11 @@ namespace tg
     {
         if (!panel) return;
         
-        auto it = std::ranges::find_if(mPanels,
-                                       [&panel](const auto& p) { return p && p->GetName() == panel->GetName(); });
-        
-        if (it == mPanels.end())
+        if (!mRegistry.Find(panel->GetName()).IsValid())
         {
             panel->OnAttach();
-            mPanels.push_back(panel);
+            mRegistry.Add(panel);
+            MarkSessionDirty();
             
             if (!mActivePanel)
             {
@@ -76,54 +200,73 @@ namespace tg
         }
     }
 
-    void TabManager::RemovePanel(const std::string& panelName)
+    PanelHandle TabManager::OpenPanel(std::string_view typeId, const std::string& name, std::vector<uint8_t> state)
     {
-        auto it = std::ranges::find_if(mPanels,
-                                       [&panelName](const auto& p) { return p && p->GetName() == panelName; });
-        
-        if (it != mPanels.end())
+        const PanelType* type = PanelFactory::Get().Find(typeId);
+        if (!type)
         {
-            if (mActivePanel == it->get())
-            {
-                mActivePanel = nullptr;
-                (*it)->OnLostFocus();
-                
-                auto nextIt = std::ranges::find_if(mPanels,
-                                                   [&it](const auto& p) { return p && p != *it && !p->IsDetached(); });
-                
-                if (nextIt != mPanels.end())
-                {
-                    mActivePanel = nextIt->get();
-                    (*nextIt)->OnFocus();
-                }
-            }
-            
-            (*it)->OnDetach();
-            mPanels.erase(it);
+            TG(CoreLog, Error, "Cannot open panel of unknown type: {}", typeId)
+            return {};
         }
+
+        const std::string panelName = name.empty() ? MakeUniqueName(type->displayName) : name;
+        const PanelHandle handle = AddPendingPanel(*type, panelName, std::move(state));
+        if (!handle.IsValid()) return {};
+
+        if (!mActivePanel)
+        {
+            SetActivePanel(mRegistry.Get(handle));
+        }
+
+        TG(CoreLog, Info, "Opened panel: {} ({})", panelName, type->typeId)
+        return handle;
+    }
+
+    void TabManager::RemovePanel(const std::string& panelName)
+    {
+        RemovePanel(mRegistry.Find(panelName));
     }
 
     void TabManager::RemovePanel(Panel* panel)
     {
         if (!panel) return;
-        RemovePanel(panel->GetName());
+        RemovePanel(panel->GetHandle());
     }
 
-    std::shared_ptr<Panel> TabManager::GetPanel(const std::string& panelName)
+    void TabManager::RemovePanel(PanelHandle handle)
     {
-        auto it = std::ranges::find_if(mPanels,
-                                       [&panelName](const auto& p) { return p && p->GetName() == panelName; });
+        Panel* panel = mRegistry.Get(handle);
+        if (!panel) return;
+        
+        if (mActivePanel == panel)
+        {
+            mActivePanel = nullptr;
+            panel->OnLostFocus();
+            
+            auto nextIt = std::ranges::find_if(mRegistry.GetOrder(),
+                                               [this, handle](PanelHandle h) { return h != handle && !mRegistry.Get(h)->IsDetached(); });
+            
+            if (nextIt != mRegistry.GetOrder().end())
+            {
+                SetActivePanel(mRegistry.Get(*nextIt));
+            }
+        }
         
-        return (it != mPanels.end()) ? *it : nullptr;
-   
+        panel->OnDetach();
+        mRegistry.Remove(handle);
+        MarkSessionDirty();
+    }
+
+    std::shared_ptr<Panel> TabManager::GetPanel(const std::string& panelName)
+    {
+        return mRegistry.GetShared(mRegistry.Find(panelName));
     }
 
     void TabManager::SetActivePanel(const std::string& panelName)
     {
-        auto panel = GetPanel(panelName);
-        if (panel)
+        if (Panel* panel = mRegistry.Get(mRegistry.Find(panelName)))
         {
-            SetActivePanel(panel.get());
+            SetActivePanel(panel);
         }
     }
 
@@ -131,12 +274,19 @@ namespace tg
     {
         if (!panel || panel->IsDetached()) return;
         
+        panel = Materialize(panel);
+        
         if (mActivePanel && mActivePanel != panel)
         {
             mActivePanel->OnLostFocus();
             mActivePanel->SetFocused(false);
         }
+        if (mActivePanel != panel)
+        {
+            MarkSessionDirty();
+        }
         
+        panel->Restore();
         mActivePanel = panel;
         panel->SetFocused(true);
         panel->OnFocus();
@@ -147,18 +297,19 @@ namespace tg
         if (!panel || panel->IsDetached()) return;
         
         panel->SetDetached(true);
+        MarkSessionDirty();
         
         if (mActivePanel == panel)
         {
             mActivePanel = nullptr;
             panel->OnLostFocus();
             
-            auto it = std::ranges::find_if(mPanels,
-                                           [](const auto& p) { return p && !p->IsDetached(); });
+            auto it = std::ranges::find_if(mRegistry.GetOrder(),
+                                           [this](PanelHandle h) { return !mRegistry.Get(h)->IsDetached(); });
             
-            if (it != mPanels.end())
+            if (it != mRegistry.GetOrder().end())
             {
-                SetActivePanel(it->get());
+                SetActivePanel(mRegistry.Get(*it));
             }
         }
     }
@@ -168,6 +319,7 @@ namespace tg
         if (!panel || !panel->IsDetached()) return;
         
         panel->SetDetached(false);
+        MarkSessionDirty();
         
         if (!mActivePanel)
         {
@@ -177,6 +329,7 @@ namespace tg
 
     void TabManager::RenderTabBar()
     {
+        TG_PROFILE_FUNCTION()
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(1, 0));
         ImGui::PushStyleColor(ImGuiCol_Button, mInactiveTabColor);
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, mHoveredTabColor);
@@ -186,10 +339,11 @@ namespace tg
         float totalTabWidth = availSize.x;
         if (mShowAddButton) totalTabWidth -= 30; 
         
+        const std::vector<PanelHandle>& order = mRegistry.GetOrder();
         int attachedCount = 0;
-        for (const auto& panel : mPanels)
+        for (PanelHandle handle : order)
         {
-            if (panel && !panel->IsDetached())
+            if (!mRegistry.Get(handle)->IsDetached())
                 attachedCount++;
         }
         
@@ -198,13 +352,15 @@ namespace tg
             float tabWidth = std::min(200.0f, totalTabWidth / attachedCount);
             
             float currentX = 0;
-            for (auto& panel : mPanels)
+            for (size_t orderIndex = 0; orderIndex < order.size(); ++orderIndex)
             {
-                if (!panel || panel->IsDetached()) continue;
+                const PanelHandle handle = order[orderIndex];
+                Panel* panel = mRegistry.Get(handle);
+                if (panel->IsDetached()) continue;
                 
                 ImGui::PushID(panel->GetUniqueID().c_str());
                 
-                bool isActive = (mActivePanel == panel.get());
+                bool isActive = (mActivePanel == panel);
                 
                 ImGui::SetCursorPosX(currentX);
                 
@@ -219,23 +375,28 @@ namespace tg
                 float closeButtonWidth = hasCloseButton ? 20.0f : 0.0f;
                 
                 // Tab button
-                std::string tabLabel = panel->GetIcon().empty() ? 
-                    panel->GetName() : 
-                    panel->GetIcon() + " " + panel->GetName();
+                FrameString tabLabel(panel->GetIcon().size() + 1 + panel->GetName().size());
+                if (!panel->GetIcon().empty())
+                {
+                    tabLabel.Append(panel->GetIcon()).Append(' ');
+                }
+                tabLabel.Append(panel->GetName());
+                FontLibrary::Get().RequestGlyphs(tabLabel);
                     
-                bool clicked = ImGui::Button(tabLabel.c_str(), 
+                bool clicked = ImGui::Button(tabLabel.CStr(), 
                     ImVec2(actualTabWidth - closeButtonWidth - 2, mTabBarHeight));
                 
                 if (clicked)
                 {
-                    SetActivePanel(panel.get());
+                    // May construct the panel, which replaces the placeholder object
+                    SetActivePanel(panel);
+                    panel = mRegistry.Get(handle);
                 }
                 
                 // Drag source for tab reordering
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None))
                 {
-                    Panel* draggedPanel = panel.get();
-                    ImGui::SetDragDropPayload("TAB_PANEL", &draggedPanel, sizeof(Panel*));
+                    ImGui::SetDragDropPayload("TAB_PANEL", &handle, sizeof(PanelHandle));
                     ImGui::Text("%s", panel->GetName().c_str());
                     ImGui::EndDragDropSource();
                 }
@@ -245,19 +406,12 @@ namespace tg
                 {
                     if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("TAB_PANEL"))
                     {
-                        Panel* droppedPanel = *(Panel**)payload->Data;
-                        if (droppedPanel && droppedPanel != panel.get())
+                        const PanelHandle droppedHandle = *static_cast<const PanelHandle*>(payload->Data);
+                        if (droppedHandle != handle)
                         {
-                            // Find and swap panels
-                            auto dragIt = std::find_if(mPanels.begin(), mPanels.end(),
-                                [droppedPanel](const auto& p) { return p.get() == droppedPanel; });
-                            auto dropIt = std::find_if(mPanels.begin(), mPanels.end(),
-                                [&panel](const auto& p) { return p == panel; });
-                            
-                            if (dragIt != mPanels.end() && dropIt != mPanels.end())
-                            {
-                                std::swap(*dragIt, *dropIt);
-                            }
+                            // Stale handles (panel closed mid-drag) are ignored by the registry
+                            mRegistry.Swap(droppedHandle, handle);
+                            MarkSessionDirty();
                         }
                     }
                     ImGui::EndDragDropTarget();
@@ -273,11 +427,11 @@ namespace tg
                     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
                     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.7f, 0.2f, 0.2f, 0.5f));
                     
-                    if (ImGui::Button(("X##close" + panel->GetUniqueID()).c_str(), 
+                    // Already inside the panel's ID scope
+                    if (ImGui::Button("X##close", 
                         ImVec2(closeButtonWidth - 2, mTabBarHeight)))
                     {
-                        panel->SetOpen(false);
-                        RemovePanel(panel.get());
+                        mPendingCloses.push_back(handle);
                     }
                     
                     ImGui::PopStyleColor(2);
@@ -291,7 +445,7 @@ namespace tg
                     {
                         if (ImGui::MenuItem("Detach"))
                         {
-                            DetachPanel(panel.get());
+                            DetachPanel(panel);
                         }
                     }
                     
@@ -299,25 +453,18 @@ namespace tg
                     {
                         if (ImGui::MenuItem("Close"))
                         {
-                            panel->SetOpen(false);
-                            RemovePanel(panel.get());
+                            mPendingCloses.push_back(handle);
                         }
                     }
                     
                     if (ImGui::MenuItem("Close Others"))
                     {
                         // Close all other panels
-                        for (auto it = mPanels.begin(); it != mPanels.end();)
+                        for (PanelHandle other : order)
                         {
-                            if ((*it).get() != panel.get() && ((*it)->GetFlags() & PanelFlags::CanClose))
+                            if (other != handle && (mRegistry.Get(other)->GetFlags() & PanelFlags::CanClose))
                             {
-                                (*it)->SetOpen(false);
-                                (*it)->OnDetach();
-                                it = mPanels.erase(it);
-                            }
-                            else
-                            {
-                                ++it;
+                                mPendingCloses.push_back(other);
                             }
                         }
                     }
@@ -347,10 +494,7 @@ namespace tg
                 
                 if (ImGui::BeginPopup("AddPanelMenu"))
                 {
-                    // This should be customized by the application
-                    ImGui::Text("Add Panel Menu");
-                    ImGui::Separator();
-                    ImGui::Text("Override this in your application");
+                    RenderAddPanelMenu();
                     ImGui::EndPopup();
                 }
             }
@@ -365,15 +509,19 @@ namespace tg
         ImGui::PopStyleVar();
         
         ImGui::Separator();
+        
+        FlushPendingCloses();
     }
 
     void TabManager::RenderDetachedWindows()
     {
-        std::vector<Panel*> panelsToRemove;
-        
-        for (auto& panel : mPanels)
+        TG_PROFILE_FUNCTION()
+        for (PanelHandle handle : mRegistry.GetOrder())
         {
-            if (!panel || !panel->IsDetached() || !panel->IsOpen()) continue;
+            Panel* panel = mRegistry.Get(handle);
+            if (!panel->IsDetached() || !panel->IsOpen()) continue;
+            panel = Materialize(panel);
+            panel->Restore();
             
             ImGuiWindowFlags windowFlags = 0;
             if (panel->GetFlags() & PanelFlags::MenuBar)
@@ -386,22 +534,32 @@ namespace tg
             }
             
             bool open = panel->IsOpen();
-            std::string windowTitle = panel->GetName();
+            FrameString windowTitle(panel->GetIcon().size() + panel->GetName().size() + panel->GetUniqueID().size() + 4);
             if (!panel->GetIcon().empty())
             {
-                windowTitle = panel->GetIcon() + " " + windowTitle;
+                windowTitle.Append(panel->GetIcon()).Append(' ');
             }
-            windowTitle += "###" + panel->GetUniqueID();
+            windowTitle.Append(panel->GetName());
+            FontLibrary::Get().RequestGlyphs(windowTitle);
+            windowTitle.Append("###").Append(panel->GetUniqueID());
             
             ImGui::SetNextWindowSize(panel->GetDetachedWindowSize(), ImGuiCond_FirstUseEver);
             
-            if (ImGui::Begin(windowTitle.c_str(), &open, windowFlags))
+            if (ImGui::Begin(windowTitle.CStr(), &open, windowFlags))
             {
+                const ImVec2 windowSize = ImGui::GetWindowSize();
+                const ImVec2& savedSize = panel->GetDetachedWindowSize();
+                if (windowSize.x != savedSize.x || windowSize.y != savedSize.y)
+                {
+                    panel->SetDetachedWindowSize(windowSize);
+                    MarkSessionDirty();
+                }
+                
                 // Add a small toolbar for window actions
                 ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.2f, 0.2f, 0.5f));
                 if (ImGui::Button("Attach"))
                 {
-                    AttachPanel(panel.get());
+                    AttachPanel(panel);
                 }
                 ImGui::SameLine();
                 ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Right-click for options");
@@ -413,7 +571,7 @@ namespace tg
                 {
                     if (ImGui::MenuItem("Attach to Main Window"))
                     {
-                        AttachPanel(panel.get());
+                        AttachPanel(panel);
                     }
                     ImGui::Separator();
                     if (panel->GetFlags() & PanelFlags::CanClose)
@@ -428,29 +586,40 @@ namespace tg
                 
                 // Render panel content
                 panel->OnRender();
+                panel->OnRenderOverlays();
             }
             ImGui::End();
             
-            panel->SetOpen(open);
             if (!open)
             {
-                panelsToRemove.push_back(panel.get());
+                mPendingCloses.push_back(handle);
             }
         }
         
         // Remove closed panels
-        for (auto* panel : panelsToRemove)
-        {
-            RemovePanel(panel);
-        }
-    
+        FlushPendingCloses();
     }
 
     void TabManager::RenderTabContent()
     {
+        TG_PROFILE_FUNCTION()
         if (mActivePanel && !mActivePanel->IsDetached())
         {
-            mActivePanel->OnRender();
+            mActivePanel->Restore();
+            if (mActivePanel->GetFlags() & PanelFlags::Retained)
+            {
+                RetainedView& view = mActivePanel->GetRetainedView();
+                if (!view.DrawCached(mActivePanel->ConsumeInvalidation()))
+                {
+                    mActivePanel->OnRender();
+                    view.EndLive();
+                }
+            }
+            else
+            {
+                mActivePanel->OnRender();
+            }
+            mActivePanel->OnRenderOverlays();
         }
         else
         {
@@ -465,4 +634,263 @@ namespace tg
     void TabManager::HandleTabDragDrop()
     {
     }
+
+    void TabManager::RenderAddPanelMenu()
+    {
+        const std::vector<PanelType>& types = PanelFactory::Get().GetTypes();
+        if (types.empty())
+        {
+            ImGui::TextDisabled("No panel types registered");
+            return;
+        }
+
+        for (const PanelType& type : types)
+        {
+            FrameString label(type.icon.size() + 1 + type.displayName.size());
+            if (!type.icon.empty())
+            {
+                label.Append(type.icon).Append(' ');
+            }
+            label.Append(type.displayName);
+            FontLibrary::Get().RequestGlyphs(label);
+
+            if (ImGui::MenuItem(label.CStr()))
+            {
+                SetActivePanel(mRegistry.Get(OpenPanel(type.typeId)));
+            }
+        }
+    }
+
+    Panel* TabManager::Materialize(Panel* panel)
+    {
+        auto* pending = dynamic_cast<PendingPanel*>(panel);
+        if (!pending) return panel;
+
+        TG_PROFILE_FUNCTION()
+        TG_MEMORY_TAG(Panels)
+        std::shared_ptr<Panel> created = PanelFactory::Get().Create(pending->GetTypeId(), pending->GetName());
+        if (!created) return panel;
+
+        created->SetDetached(pending->IsDetached());
+        created->SetDetachedWindowSize(pending->GetDetachedWindowSize());
+        created->OnAttach();
+        if (!pending->mState.empty())
+        {
+            // Saved state goes through the same path as waking from hibernation.
+            created->mHibernatedState = std::move(pending->mState);
+            created->mIsHibernated = true;
+            created->Restore();
+        }
+
+        const bool wasActive = (mActivePanel == pending);
+        mRegistry.Replace(pending->GetHandle(), created); // destroys pending
+        if (wasActive)
+        {
+            mActivePanel = created.get();
+        }
+
+        TG(CoreLog, Info, "Constructed panel: {} ({})", created->GetName(), created->GetTypeId())
+        return created.get();
+    }
+
+    PanelHandle TabManager::AddPendingPanel(const PanelType& type, const std::string& name, std::vector<uint8_t> state)
+    {
+        const PanelHandle handle = mRegistry.Add(std::make_shared<PendingPanel>(name, type, std::move(state)));
+        if (!handle.IsValid())
+        {
+            TG(CoreLog, Warn, "A panel named '{}' is already open", name)
+            return {};
+        }
+        MarkSessionDirty();
+        return handle;
+    }
+
+    bool TabManager::LoadSession()
+    {
+        if (!mSessionConfig.enabled) return false;
+
+        TG_PROFILE_FUNCTION()
+        Timer timer;
+        MappedFile file;
+        std::vector<uint8_t> prefetched;
+        std::span<const uint8_t> bytes;
+        if (std::exchange(mSessionPrefetched, false))
+        {
+            prefetched = std::move(mPrefetchedSession);
+            if (prefetched.empty()) return false;
+            bytes = prefetched;
+        }
+        else
+        {
+            if (!file.Open(mSessionConfig.path)) return false;
+            bytes = {file.GetData(), file.GetSize()};
+        }
+
+        BinaryReader reader(bytes);
+        if (reader.Read<uint32_t>() != kSessionMagic || reader.Read<uint32_t>() != kSessionVersion)
+        {
+            TG(CoreLog, Warn, "Ignoring session {}: unknown format", mSessionConfig.path)
+            return false;
+        }
+
+        const uint32_t panelCount = reader.Read<uint32_t>();
+        const uint32_t activeIndex = reader.Read<uint32_t>();
+        PanelHandle activeHandle;
+        for (uint32_t i = 0; i < panelCount; ++i)
+        {
+            const std::string typeId = reader.ReadString();
+            const std::string name = reader.ReadString();
+            const bool detached = reader.Read<uint8_t>() != 0;
+            const float width = reader.Read<float>();
+            const float height = reader.Read<float>();
+            const std::span<const uint8_t> state = reader.ReadBytes();
+            if (!reader.IsValid())
+            {
+                TG(CoreLog, Warn, "Session {} is truncated after {} panels", mSessionConfig.path, i)
+                break;
+            }
+
+            const PanelType* type = PanelFactory::Get().Find(typeId);
+            if (!type)
+            {
+                TG(CoreLog, Warn, "Session panel '{}' has unknown type {}; skipped", name, typeId)
+                continue;
+            }
+
+            const PanelHandle handle = AddPendingPanel(*type, name, {state.begin(), state.end()});
+            if (Panel* panel = mRegistry.Get(handle))
+            {
+                panel->SetDetached(detached);
+                panel->SetDetachedWindowSize(ImVec2(width, height));
+                if (i == activeIndex) activeHandle = handle;
+            }
+        }
+
+        if (!activeHandle.IsValid())
+        {
+            auto it = std::ranges::find_if(mRegistry.GetOrder(),
+                                           [this](PanelHandle h) { return !mRegistry.Get(h)->IsDetached(); });
+            if (it != mRegistry.GetOrder().end()) activeHandle = *it;
+        }
+        SetActivePanel(mRegistry.Get(activeHandle));
+        mSessionDirty = false;
+
+        TG(CoreLog, Info, "Restored session {}: {} panels in {:.2f} ms", mSessionConfig.path, mRegistry.Size(),
+           timer.GetElapsedMilliseconds())
+        return !mRegistry.Empty();
+    }
+
+    void TabManager::PrefetchSession()
+    {
+        TG_PROFILE_FUNCTION()
+        const SessionConfig config = SessionConfig::FromCommandLine();
+        MappedFile file;
+        if (config.enabled && file.Open(config.path))
+        {
+            mPrefetchedSession.assign(file.GetData(), file.GetData() + file.GetSize());
+        }
+        mSessionPrefetched = true;
+    }
+
+    void TabManager::SaveSession()
+    {
+        if (!mSessionConfig.enabled) return;
+
+        TG_PROFILE_FUNCTION()
+        mSessionWriter.Post(SerializeSession());
+        mSessionDirty = false;
+    }
+
+    std::vector<uint8_t> TabManager::SerializeSession() const
+    {
+        // Panels added directly with AddPanel() have no type to recreate them from.
+        uint32_t panelCount = 0;
+        uint32_t activeIndex = UINT32_MAX;
+        for (PanelHandle handle : mRegistry.GetOrder())
+        {
+            const Panel* panel = mRegistry.Get(handle);
+            if (panel->GetTypeId().empty()) continue;
+            if (panel == mActivePanel) activeIndex = panelCount;
+            ++panelCount;
+        }
+
+        BinaryWriter writer;
+        writer.Write(kSessionMagic);
+        writer.Write(kSessionVersion);
+        writer.Write(panelCount);
+        writer.Write(activeIndex);
+
+        for (PanelHandle handle : mRegistry.GetOrder())
+        {
+            const Panel* panel = mRegistry.Get(handle);
+            if (panel->GetTypeId().empty()) continue;
+
+            writer.WriteString(panel->GetTypeId());
+            writer.WriteString(panel->GetName());
+            writer.Write(static_cast<uint8_t>(panel->IsDetached()));
+            writer.Write(panel->GetDetachedWindowSize().x);
+            writer.Write(panel->GetDetachedWindowSize().y);
+
+            // Tabs that were never shown or are hibernated already hold their state as bytes.
+            if (const auto* pending = dynamic_cast<const PendingPanel*>(panel))
+            {
+                writer.WriteBytes(pending->mState);
+            }
+            else if (panel->IsHibernated())
+            {
+                writer.WriteBytes(panel->mHibernatedState);
+            }
+            else
+            {
+                BinaryWriter state;
+                panel->OnSaveState(state);
+                writer.WriteBytes(state.GetBuffer());
+            }
+        }
+        return writer.TakeBuffer();
+    }
+
+    std::string TabManager::MakeUniqueName(const std::string& baseName) const
+    {
+        if (!mRegistry.Find(baseName).IsValid()) return baseName;
+
+        for (int suffix = 2;; ++suffix)
+        {
+            std::string name = baseName + " " + std::to_string(suffix);
+            if (!mRegistry.Find(name).IsValid()) return name;
+        }
+    }
+
+    bool TabManager::IsVisible(const Panel* panel) const
+    {
+        return panel->IsDetached() ? panel->IsOpen() : panel == mActivePanel;
+    }
+
+    void TabManager::HibernateIdlePanels()
+    {
+        if (mLifecycle.hibernateAfterSeconds <= 0.0f) return;
+
+        // Runs inside the frame so released GPU resources go through the render side.
+        for (PanelHandle handle : mRegistry.GetOrder())
+        {
+            Panel* panel = mRegistry.Get(handle);
+            if (!panel->IsHibernated() && !IsVisible(panel) && panel->mIdleSeconds >= mLifecycle.hibernateAfterSeconds)
+            {
+                panel->Hibernate();
+            }
+        }
+    }
+
+    void TabManager::FlushPendingCloses()
+    {
+        for (PanelHandle handle : mPendingCloses)
+        {
+            if (Panel* panel = mRegistry.Get(handle))
+            {
+                panel->SetOpen(false);
+                RemovePanel(handle);
+            }
+        }
+        mPendingCloses.clear();
+    }
 }
@@ -1,17 +1,43 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "Layer.h"
+#include "Startup.h"
+#include "Debug/InputScript.h"
 
 
 namespace tg
 {
+    struct CommandLineArgs
+    {
+        int count = 0;
+        char** args = nullptr;
+
+        [[nodiscard]] bool HasFlag(std::string_view flag) const;
+        // Accepts both "--flag value" and "--flag=value".
+        [[nodiscard]] const char* GetValue(std::string_view flag) const;
+    };
+
+    // One frame of a --frames run.
+    struct FrameSample
+    {
+        float cpuMs = 0.0f;       // excluding the swap
+        uint64_t allocations = 0; // main-thread operator new calls; 0 without TG_TRACK_ALLOCATIONS
+        uint32_t drawCalls = 0;
+        uint32_t vertices = 0;
+    };
+
     class App
     {
     public:
         App();
-        ~App();
+        virtual ~App();
 
+        // The last startup phase ("Layers"): push the app's layers here.
         virtual void OnInit(){}
         virtual void OnShutdown();
 
@@ -20,21 +46,59 @@ namespace tg
         void PopLayer(Layer* layer);
         void PopOverlay(Layer* layer);
         void RenderImGui();
+        // Drains the EventQueue through the layers, highest priority / topmost first.
+        // Returns how many events were dispatched.
+        size_t DispatchEvents();
 
         void Run();
+        void Close();
 
         inline class Window& GetWindow() const{return *mWindow;}
+        // Add phases from the derived constructor; they run at the start of Run().
+        StartupSequence& GetStartup() { return mStartup; }
+        [[nodiscard]] uint64_t GetFrameIndex() const { return mFrameIndex; }
+        // Filled when run with --frames; still valid after Run() returns.
+        [[nodiscard]] const std::vector<FrameSample>& GetFrameSamples() const { return mFrameSamples; }
+
+        // Receives the "command" lines of a --replay-input script, before that frame's ImGui frame begins.
+        void SetInputCommandHandler(InputScript::CommandHandler handler) { mInputCommandHandler = std::move(handler); }
         static inline App& Get() { return *sInstance; }
+
+        static void SetCommandLineArgs(const CommandLineArgs& args) { sCommandLineArgs = args; }
+        static const CommandLineArgs& GetCommandLineArgs() { return sCommandLineArgs; }
+    private:
+        // Main-thread operator new calls made by the last frame; asserts on any with --strict-allocations.
+        void CheckFrameAllocations(uint64_t allocations);
+        // Sleeps until input, posted main-thread work or the next timer deadline.
+        void WaitForWork();
+        void LogBenchmarkSummary() const;
     private:
         std::unique_ptr<class Window> mWindow;
 
         LayerStack mLayerStack;
+        StartupSequence mStartup;
+        float mContentScale = 1.0f; // primary monitor, for the fonts phase
         class ImGuiLayer* mImGuiLayer;
         Timer mFrameTimer;
         TimeStep mTimeStep;
         float mLastFrameTime = 0.0f;
 
+        uint64_t mFrameIndex = 0;
+        uint64_t mMaxFrames = 0; // 0 = run until the window closes
+        std::vector<FrameSample> mFrameSamples;
+
+        // --replay-input <script> feeds recorded input to ImGui; --record-input <script>
+        // writes what this run received when it exits.
+        std::unique_ptr<InputScript> mInputReplay;
+        std::unique_ptr<InputScript> mInputRecording;
+        std::string mInputRecordingPath;
+        InputScript::CommandHandler mInputCommandHandler;
+        bool mStrictAllocations = false;
+        bool mIdleWait = false;
+        uint32_t mQuietFrames = 0; // frames since the last event, timer or dispatched task
+
         static App* sInstance;
+        static CommandLineArgs sCommandLineArgs;
     };
 
     
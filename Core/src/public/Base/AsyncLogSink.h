@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "spdlog/sinks/sink.h"
+
+#include "Base/BoundedQueue.h"
+#include "Base/Log.h"
+
+namespace tg
+{
+    class AsyncLogSink;
+
+    // The thread behind every AsyncLogSink. Messages wait in a BoundedQueue until the writer
+    // drains them in batches into the real sinks; files are flushed on a timer, after an
+    // error-level message, and on Flush()/Stop(). A full queue is handled per LogConfig::overflow.
+    class AsyncLogWriter
+    {
+    public:
+        explicit AsyncLogWriter(const LogConfig& config);
+        ~AsyncLogWriter();
+
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        void Push(AsyncLogSink* sink, const spdlog::details::log_msg& msg);
+        // Blocks until everything pushed before the call is written and flushed.
+        void Flush();
+        // Writes what is still queued, then joins the thread.
+        void Stop();
+
+        [[nodiscard]] uint64_t GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+    private:
+        friend class AsyncLogSink;
+
+        // Fixed size so pushing never allocates, about 1 KiB each. Longer messages are cut at
+        // kMaxPayload and end in kTruncatedMarker.
+        struct Record
+        {
+            static constexpr size_t kMaxPayload = 944;
+            static constexpr std::string_view kTruncatedMarker = " [truncated]";
+
+            AsyncLogSink* sink = nullptr;
+            spdlog::log_clock::time_point time;
+            spdlog::source_loc source;
+            spdlog::string_view_t loggerName;
+            size_t threadId = 0;
+            spdlog::level::level_enum level = spdlog::level::info;
+            uint16_t size = 0;
+            char payload[kMaxPayload];
+        };
+
+        // Retries until the record is queued; gives up only once the writer is gone.
+        void PushBlocking(const Record& record);
+        void Register(AsyncLogSink* sink);
+        void Unregister(AsyncLogSink* sink);
+        void WriterMain();
+        void Write(const Record& record) const;
+        void FlushTargets();
+        void Wake();
+
+    private:
+        LogConfig mConfig;
+        BoundedQueue<Record> mQueue;
+        std::atomic<uint64_t> mDropped{0};
+
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mFlushed;
+        std::vector<AsyncLogSink*> mSinks;
+        std::atomic<bool> mSleeping{false};
+        std::atomic<bool> mStopRequested{false};
+        std::atomic<uint64_t> mFlushRequested{0};
+        uint64_t mFlushCompleted = 0; // guarded by mMutex
+        std::thread mThread;
+    };
+
+    // Logger-facing end: copies each message into the writer's queue and returns. The
+    // wrapped sinks are only ever called from the writer thread.
+    class AsyncLogSink final : public spdlog::sinks::sink
+    {
+    public:
+        AsyncLogSink(std::shared_ptr<AsyncLogWriter> writer, std::vector<spdlog::sink_ptr> targets);
+        ~AsyncLogSink() override;
+
+        void log(const spdlog::details::log_msg& msg) override { mWriter->Push(this, msg); }
+        void flush() override { mWriter->Flush(); }
+        void set_pattern(const std::string& pattern) override;
+        void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    private:
+        friend class AsyncLogWriter;
+
+        std::shared_ptr<AsyncLogWriter> mWriter;
+        std::vector<spdlog::sink_ptr> mTargets;
+    };
+}
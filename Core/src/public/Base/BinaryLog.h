@@ -0,0 +1,234 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "spdlog/common.h"
+#include "spdlog/fmt/fmt.h"
+
+namespace tg
+{
+    // Everything about a log call that is known at compile time. The TG macros declare one
+    // as a function-local static constexpr, so it is constant-initialized and a record only
+    // has to carry its address; the writer emits the site to the file the first time it
+    // sees it.
+    struct LogSite
+    {
+        const char* logger;
+        const char* file;
+        uint32_t line;
+        spdlog::level::level_enum level;
+        const char* format;
+    };
+
+    // Tags in front of each argument, in the thread rings and in .tgbl files alike.
+    enum class LogArgType : uint8_t
+    {
+        Int,     // int64
+        UInt,    // uint64
+        Float,   // double
+        Bool,    // uint8
+        Char,    // char
+        String,  // uint32 length + bytes
+        Pointer, // uint64
+    };
+
+    namespace detail
+    {
+        // Arguments that are not numbers, chars, pointers or strings are formatted on the
+        // calling thread and stored as strings, so any type the text path takes works here.
+        template<typename T>
+        decltype(auto) CaptureLogArg(const T& value)
+        {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                return std::string_view(value);
+            else if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>)
+                return value;
+            else
+                return fmt::format("{}", value);
+        }
+
+        template<typename T>
+        constexpr size_t EncodedLogArgSize(const T& value)
+        {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                return 1 + sizeof(uint32_t) + std::string_view(value).size();
+            else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>)
+                return 2;
+            else
+                return 1 + sizeof(uint64_t);
+        }
+
+        template<typename T>
+        void PutLogValue(uint8_t*& out, const T& value)
+        {
+            std::memcpy(out, &value, sizeof(T));
+            out += sizeof(T);
+        }
+
+        template<typename T>
+        void EncodeLogArg(uint8_t*& out, const T& value)
+        {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            {
+                const std::string_view text(value);
+                *out++ = static_cast<uint8_t>(LogArgType::String);
+                PutLogValue(out, static_cast<uint32_t>(text.size()));
+                std::memcpy(out, text.data(), text.size());
+                out += text.size();
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::Bool);
+                *out++ = value ? 1 : 0;
+            }
+            else if constexpr (std::is_same_v<T, char>)
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::Char);
+                *out++ = static_cast<uint8_t>(value);
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::Float);
+                PutLogValue(out, static_cast<double>(value));
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::Pointer);
+                PutLogValue(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+            else if constexpr (std::is_signed_v<T>)
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::Int);
+                PutLogValue(out, static_cast<int64_t>(value));
+            }
+            else
+            {
+                *out++ = static_cast<uint8_t>(LogArgType::UInt);
+                PutLogValue(out, static_cast<uint64_t>(value));
+            }
+        }
+
+        // Single-producer byte ring owned by one logging thread and drained by the binary
+        // log writer. Records never wrap: one that does not fit before the end is preceded
+        // by a padding marker and starts over at offset 0.
+        struct LogThreadRing
+        {
+            struct RecordHeader
+            {
+                uint32_t size;     // whole record, header included
+                uint32_t argBytes;
+                const LogSite* site;
+                uint64_t timeNs;
+            };
+            static constexpr uint32_t kPaddingBit = 0x8000'0000u;
+
+            LogThreadRing(size_t capacity, uint64_t threadId);
+
+            // Null when the writer has fallen this far behind; the caller drops the record.
+            uint8_t* Reserve(size_t size)
+            {
+                const size_t pos = head.load(std::memory_order_relaxed);
+                const size_t offset = pos & mask;
+                const size_t contiguous = mask + 1 - offset;
+                const size_t needed = contiguous < size ? contiguous + size : size;
+                if (pos + needed - cachedTail > mask + 1)
+                {
+                    cachedTail = tail.load(std::memory_order_acquire);
+                    if (pos + needed - cachedTail > mask + 1) return nullptr;
+                }
+
+                if (contiguous < size)
+                {
+                    const uint32_t padding = static_cast<uint32_t>(contiguous) | kPaddingBit;
+                    std::memcpy(data.get() + offset, &padding, sizeof(padding));
+                    reserved = pos + contiguous;
+                    return data.get();
+                }
+                reserved = pos;
+                return data.get() + offset;
+            }
+
+            void Commit(size_t size) { head.store(reserved + size, std::memory_order_release); }
+
+            std::unique_ptr<uint8_t[]> data;
+            size_t mask;
+            uint64_t threadId;
+            size_t cachedTail = 0; // producer's last look at tail
+            size_t reserved = 0;
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<bool> retired{false}; // owning thread has exited
+            alignas(64) std::atomic<size_t> head{0};
+            alignas(64) std::atomic<size_t> tail{0};
+        };
+    }
+
+    // Deferred-format logging. A call copies its site pointer, a timestamp and its raw
+    // arguments into a ring owned by the calling thread; no formatting, no locks, no
+    // allocation for plain arguments. A writer thread moves the records into a .tgbl file,
+    // which LogDecoder renders to text afterwards. Enabled with LogConfig::binary.
+    class BinaryLog
+    {
+    public:
+        static constexpr uint32_t kMagic = 0x4C42'4754; // "TGBL"
+        static constexpr uint32_t kVersion = 1;
+
+        // File records, each starting with this tag.
+        enum class RecordKind : uint8_t
+        {
+            Site = 1,    // uint32 id, uint8 level, logger, file, uint32 line, format
+            Message = 2, // uint32 site id, uint64 time ns, uint64 thread id, uint32 arg bytes, args
+            Dropped = 3, // uint64 total records dropped so far
+        };
+
+        // Starts the writer; records are kept in memory until Open().
+        static void Start(size_t ringBytes, float flushIntervalSeconds);
+        static void Open(const std::string& path);
+        // Writes out every ring and closes the file.
+        static void Stop();
+
+        [[nodiscard]] static bool IsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+        [[nodiscard]] static uint64_t GetDroppedCount();
+
+        template<typename... Args>
+        static void Write(const LogSite& site, const Args&... args)
+        {
+            WriteCaptured(site, detail::CaptureLogArg(args)...);
+        }
+
+    private:
+        template<typename... Args>
+        static void WriteCaptured(const LogSite& site, const Args&... args)
+        {
+            using Header = detail::LogThreadRing::RecordHeader;
+            const size_t argBytes = (size_t{0} + ... + detail::EncodedLogArgSize(args));
+            const size_t size = (sizeof(Header) + argBytes + 7) & ~size_t{7};
+
+            detail::LogThreadRing* ring = tRing ? tRing : AcquireThreadRing();
+            uint8_t* out = size <= ring->mask / 2 ? ring->Reserve(size) : nullptr;
+            if (!out)
+            {
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            const Header header{ static_cast<uint32_t>(size), static_cast<uint32_t>(argBytes), &site,
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count()) };
+            std::memcpy(out, &header, sizeof(header));
+            out += sizeof(header);
+            (detail::EncodeLogArg(out, args), ...);
+            ring->Commit(size);
+        }
+
+        static detail::LogThreadRing* AcquireThreadRing();
+
+    private:
+        inline static std::atomic<bool> sEnabled{false};
+        inline static thread_local detail::LogThreadRing* tRing = nullptr;
+    };
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "spdlog/common.h"
+
+#include "Base/BinaryStream.h"
+#include "Base/MappedFile.h"
+
+namespace tg
+{
+    struct BinaryLogSite
+    {
+        std::string logger;
+        std::string file;
+        uint32_t line = 0;
+        spdlog::level::level_enum level = spdlog::level::info;
+        std::string format;
+    };
+
+    struct BinaryLogEntry
+    {
+        const BinaryLogSite* site = nullptr;
+        int64_t wallTimeNs = 0; // since the Unix epoch
+        uint64_t threadId = 0;
+        std::string message;
+    };
+
+    // Reads a .tgbl file written by BinaryLog and formats its messages. Used by LogDecoder;
+    // kept apart from BinaryLog so the tool does not pull in the writer.
+    class BinaryLogReader
+    {
+    public:
+        bool Open(const std::string& path);
+
+        // False at the end of the file, or at a record cut short by a crash mid-write.
+        bool Next(BinaryLogEntry& entry);
+
+        // Records the writing process could not fit in its rings, as of the last one read.
+        [[nodiscard]] uint64_t GetDroppedCount() const { return mDropped; }
+        [[nodiscard]] bool IsTruncated() const { return mTruncated; }
+
+        // "[time] [logger] [level] [file:line] message", like the text logs plus the level.
+        [[nodiscard]] static std::string FormatLine(const BinaryLogEntry& entry);
+
+    private:
+        [[nodiscard]] static std::string Render(const std::string& format, std::span<const uint8_t> args);
+
+    private:
+        MappedFile mFile;
+        std::optional<BinaryReader> mReader;
+        std::vector<BinaryLogSite> mSites;
+        uint64_t mSteadyOriginNs = 0;
+        int64_t mWallOriginNs = 0;
+        uint64_t mDropped = 0;
+        bool mTruncated = false;
+    };
+}
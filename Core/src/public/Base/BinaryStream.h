@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tg
+{
+    // Appends plain values and length-prefixed strings to a byte buffer, in host byte order.
+    // Meant for state that is read back by the same build (hibernated panels, caches).
+    class BinaryWriter
+    {
+    public:
+        template<typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+            mBuffer.insert(mBuffer.end(), bytes, bytes + sizeof(T));
+        }
+
+        void WriteString(std::string_view text)
+        {
+            Write(static_cast<uint32_t>(text.size()));
+            mBuffer.insert(mBuffer.end(), text.begin(), text.end());
+        }
+
+        void WriteBytes(std::span<const uint8_t> bytes)
+        {
+            Write(static_cast<uint32_t>(bytes.size()));
+            mBuffer.insert(mBuffer.end(), bytes.begin(), bytes.end());
+        }
+
+        [[nodiscard]] const std::vector<uint8_t>& GetBuffer() const { return mBuffer; }
+        std::vector<uint8_t> TakeBuffer() { return std::move(mBuffer); }
+
+    private:
+        std::vector<uint8_t> mBuffer;
+    };
+
+    // Reads what BinaryWriter wrote. Reading past the end fails the reader instead of
+    // throwing; values read after that are zero/empty, so check IsValid() once at the end.
+    class BinaryReader
+    {
+    public:
+        explicit BinaryReader(std::span<const uint8_t> data) : mData(data) {}
+
+        template<typename T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{};
+            if (Require(sizeof(T)))
+            {
+                std::memcpy(&value, mData.data() + mOffset, sizeof(T));
+                mOffset += sizeof(T);
+            }
+            return value;
+        }
+
+        std::string ReadString()
+        {
+            const uint32_t size = Read<uint32_t>();
+            if (!Require(size)) return {};
+
+            std::string text(reinterpret_cast<const char*>(mData.data() + mOffset), size);
+            mOffset += size;
+            return text;
+        }
+
+        // View into the reader's data; valid as long as that is.
+        std::span<const uint8_t> ReadBytes()
+        {
+            const uint32_t size = Read<uint32_t>();
+            if (!Require(size)) return {};
+
+            std::span<const uint8_t> bytes = mData.subspan(mOffset, size);
+            mOffset += size;
+            return bytes;
+        }
+
+        [[nodiscard]] bool IsValid() const { return mValid; }
+        [[nodiscard]] bool IsAtEnd() const { return mOffset == mData.size(); }
+
+    private:
+        bool Require(size_t size)
+        {
+            mValid = mValid && size <= mData.size() - mOffset;
+            return mValid;
+        }
+
+    private:
+        std::span<const uint8_t> mData;
+        size_t mOffset = 0;
+        bool mValid = true;
+    };
+}
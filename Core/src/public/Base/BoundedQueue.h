@@ -0,0 +1,114 @@
+﻿#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tg
+{
+    // Fixed-capacity lock-free queue for any number of producers and consumers (Vyukov's
+    // bounded MPMC design). Push and pop are one CAS each and never allocate; a full queue
+    // fails the push instead of blocking, so the caller picks the overflow policy.
+    template<typename T>
+    class BoundedQueue
+    {
+    public:
+        // Rounded up to a power of two.
+        explicit BoundedQueue(size_t capacity)
+        {
+            capacity = std::bit_ceil(capacity < 2 ? size_t{2} : capacity);
+            mCells = std::make_unique<Cell[]>(capacity);
+            mMask = capacity - 1;
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                mCells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // Each cell's sequence says whose turn it is: equal to a producer's position when the
+        // cell is free for it, position + 1 once it holds that producer's item.
+        template<typename U>
+        bool TryPush(U&& item)
+        {
+            size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = mCells[pos & mMask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.data = std::forward<U>(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = mEnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // False when empty, or when the oldest item is claimed by a producer still writing it.
+        bool TryPop(T& out)
+        {
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = mCells[pos & mMask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        out = std::move(cell.data);
+                        cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = mDequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Approximate while other threads push or pop.
+        [[nodiscard]] size_t GetSize() const
+        {
+            const size_t enqueued = mEnqueuePos.load(std::memory_order_acquire);
+            const size_t dequeued = mDequeuePos.load(std::memory_order_acquire);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        [[nodiscard]] size_t GetCapacity() const { return mMask + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> mCells;
+        size_t mMask;
+        alignas(64) std::atomic<size_t> mEnqueuePos{0};
+        alignas(64) std::atomic<size_t> mDequeuePos{0};
+    };
+}
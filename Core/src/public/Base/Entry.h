@@ -1,14 +1,36 @@
 ﻿#pragma once
+#include <exception>
+#include <memory>
+
 #include "App.h"
 #include "Log.h"
+#include "Debug/Profiler.h"
+#include "Jobs/JobSystem.h"
 
 
 int main(int argc, char** argv)
 {
-    tg::Log::Init();
-    auto app = CreateApp();
-    app->Run();
+    tg::App::SetCommandLineArgs({ argc, argv });
+    tg::Log::Init(tg::LogConfig::FromCommandLine());
+    tg::Profiler::Init();
+    tg::JobSystem::Get().Init();
+    // Destroyed before the services below shut down: detaching the layers saves the
+    // session and joins the render thread, and both still log and schedule work.
+    std::unique_ptr<tg::App> app(CreateApp());
+    int exitCode = 0;
+    try
+    {
+        app->Run();
+    }
+    catch (const std::exception& e)
+    {
+        TG(CoreLog, Error, "Unhandled exception: {}", e.what())
+        exitCode = 1;
+    }
+    app.reset();
 
+    tg::JobSystem::Get().Shutdown();
+    tg::Profiler::Shutdown();
     tg::Log::Shutdown();
-    return 0;
+    return exitCode;
 } 
\ No newline at end of file
@@ -0,0 +1,72 @@
+﻿#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+
+namespace tg
+{
+    struct WindowCloseEvent {};
+    struct WindowResizeEvent { uint32_t width = 0; uint32_t height = 0; };
+    struct FramebufferResizeEvent { uint32_t width = 0; uint32_t height = 0; };
+    struct WindowFocusEvent { bool focused = false; };
+    struct WindowContentScaleEvent { float x = 1.0f; float y = 1.0f; };
+
+    struct KeyPressedEvent { int key = 0; int mods = 0; bool repeat = false; };
+    struct KeyReleasedEvent { int key = 0; int mods = 0; };
+    struct KeyTypedEvent { uint32_t codepoint = 0; };
+
+    struct MouseButtonPressedEvent { int button = 0; int mods = 0; };
+    struct MouseButtonReleasedEvent { int button = 0; int mods = 0; };
+    struct MouseMovedEvent { float x = 0.0f; float y = 0.0f; };
+    struct MouseScrolledEvent { float xOffset = 0.0f; float yOffset = 0.0f; };
+
+    // For background threads to signal the main thread; meaning of id/payload is up to the sender.
+    struct UserEvent { uint32_t id = 0; uint64_t payload = 0; };
+
+    // Plain values only, so events can be queued across threads without allocating.
+    using EventData = std::variant<
+        WindowCloseEvent, WindowResizeEvent, FramebufferResizeEvent, WindowFocusEvent, WindowContentScaleEvent,
+        KeyPressedEvent, KeyReleasedEvent, KeyTypedEvent,
+        MouseButtonPressedEvent, MouseButtonReleasedEvent, MouseMovedEvent, MouseScrolledEvent,
+        UserEvent>;
+
+    static_assert(std::is_trivially_copyable_v<EventData>);
+
+    struct Event
+    {
+        EventData data;
+        bool handled = false;
+
+        template<typename T>
+        [[nodiscard]] bool Is() const { return std::holds_alternative<T>(data); }
+
+        template<typename T>
+        [[nodiscard]] const T* As() const { return std::get_if<T>(&data); }
+    };
+
+    // Routes an event to the handler for its type:
+    //
+    //  EventDispatcher dispatcher(event);
+    //  dispatcher.Dispatch<KeyPressedEvent>([this](const KeyPressedEvent& e) { return OnKey(e); });
+    //  return event.handled;
+    //
+    // A handler returns true to stop the event from reaching lower layers.
+    class EventDispatcher
+    {
+    public:
+        explicit EventDispatcher(Event& event) : mEvent(event) {}
+
+        template<typename T, typename F>
+        bool Dispatch(F&& handler)
+        {
+            const T* data = mEvent.As<T>();
+            if (!data) return false;
+
+            mEvent.handled |= handler(*data);
+            return true;
+        }
+
+    private:
+        Event& mEvent;
+    };
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Base/BoundedQueue.h"
+#include "Base/Event.h"
+
+namespace tg
+{
+    // Bounded lock-free queue of events. Any thread may Push(); only the main thread
+    // drains it, once per frame, before the layers update. When the queue is full the
+    // event is dropped and counted rather than blocking the producer.
+    class EventQueue
+    {
+    public:
+        static constexpr size_t kDefaultCapacity = 4096;
+
+        static EventQueue& Get();
+
+        explicit EventQueue(size_t capacity = kDefaultCapacity) : mQueue(capacity) {}
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        bool Push(const EventData& data)
+        {
+            if (mQueue.TryPush(data)) return true;
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Calls fn(Event&) for each queued event. Events pushed while draining wait for the
+        // next frame, so a handler that pushes cannot keep the loop going.
+        template<typename F>
+        size_t Drain(F&& fn)
+        {
+            const size_t end = mQueue.GetSize();
+            size_t count = 0;
+            Event event;
+            while (count != end && mQueue.TryPop(event.data))
+            {
+                event.handled = false;
+                fn(event);
+                ++count;
+            }
+            return count;
+        }
+
+        [[nodiscard]] uint64_t GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+    private:
+        BoundedQueue<EventData> mQueue;
+        std::atomic<uint64_t> mDropped{0};
+    };
+}
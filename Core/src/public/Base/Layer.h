@@ -1,5 +1,8 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "Event.h"
 #include "Time.h"
 
 namespace tg
@@ -18,16 +21,21 @@ namespace tg
         virtual void OnDetach() {}
         virtual void OnUpdate(TimeStep ts) {}
         virtual void OnImGuiRender() {}
-        //TODO:virtual bool OnEvent(Event& event) {return false;}
+        // Return true to stop the event from reaching the layers below.
+        virtual bool OnEvent(Event& event) { return false; }
 
-        void SetActive(const bool active) { mIsActive = active; }
+        void SetActive(const bool active) { mIsActive = active; ++sStateGeneration; }
         [[nodiscard]] bool IsActive() const { return mIsActive; }
 
-        void SetVisible(const bool visible) { mIsVisible = visible; }
+        void SetVisible(const bool visible) { mIsVisible = visible; ++sStateGeneration; }
         [[nodiscard]] bool IsVisible() const { return mIsVisible; }
 
-        void SetEventPriority(const int priority) { mEventPriority = priority; }
+        // Higher priorities see events first; equal priorities go top of the stack down.
+        void SetEventPriority(const int priority) { mEventPriority = priority; ++sStateGeneration; }
         [[nodiscard]] int GetEventPriority() const { return mEventPriority; }
+
+        // Bumped by the setters above so LayerStack knows when its cached lists are stale.
+        [[nodiscard]] static uint32_t GetStateGeneration() { return sStateGeneration; }
         
     protected:
         bool mIsActive = true;
@@ -35,6 +43,7 @@ namespace tg
         int mEventPriority = 0;
     private:
         std::string mName;
+        static inline uint32_t sStateGeneration = 0;
     };
 
     class LayerStack
@@ -49,9 +58,15 @@ namespace tg
         void PopOverlay(Layer* overlayPtr);
 
 
-        // Note: These iterators will iterate over all layers, including disabled ones.
-        // The App loop will need to check IsActive().
-        //TODO: Create custom iterators that skip disabled layers.
+        // Cached views, rebuilt only after the stack or a layer's state changes.
+        // Active layers in stack order, for updates.
+        [[nodiscard]] const std::vector<Layer*>& GetActiveLayers();
+        // Active and visible layers in stack order, for rendering.
+        [[nodiscard]] const std::vector<Layer*>& GetVisibleLayers();
+        // Active and visible layers in event order: priority, then top of the stack first.
+        [[nodiscard]] const std::vector<Layer*>& GetEventLayers();
+
+        // These iterate over all layers, including disabled ones.
         using LayerIterator = std::vector<Layer*>::iterator;
         using ConstLayerIterator = std::vector<Layer*>::const_iterator;
 
@@ -71,10 +86,19 @@ namespace tg
         void Clear() {
             mLayers.clear();
             mLayerInsertIndex = 0;
+            mCacheValid = false;
         }
+    private:
+        void RefreshCache();
     private:
         std::vector<Layer*> mLayers;
         unsigned int mLayerInsertIndex = 0;
+
+        std::vector<Layer*> mActiveLayers;
+        std::vector<Layer*> mVisibleLayers;
+        std::vector<Layer*> mEventLayers;
+        uint32_t mCacheGeneration = 0;
+        bool mCacheValid = false;
     };
 
 }
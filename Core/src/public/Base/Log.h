@@ -2,14 +2,61 @@
 #include "spdlog/spdlog.h"
 #include "spdlog/fmt/ostr.h"
 
+#include "Base/BinaryLog.h"
+
 namespace tg 
 {
+    // What happens to a message below error level when the queue is full. Errors and
+    // above always wait for room and are never evicted.
+    enum class LogOverflowPolicy : uint8_t
+    {
+        Block,      // the caller waits for room; nothing is lost
+        DropOldest, // the oldest queued message below error level makes room
+        DropNewest, // the new message is discarded
+    };
+
+    struct LogConfig
+    {
+        // Sinks run on a writer thread; the calling thread only formats the message text
+        // and copies it into a bounded queue.
+        bool async = true;
+        size_t queueCapacity = 4096; // messages, about 1 KiB each
+        LogOverflowPolicy overflow = LogOverflowPolicy::Block;
+        // Files are flushed at this interval, and right away after an error.
+        float flushIntervalSeconds = 1.0f;
+
+        // TG calls go to logs/Log.tgbl as raw arguments instead (see BinaryLog); warnings and
+        // errors are still written as text too. Each logging thread gets a ring of this size.
+        bool binary = false;
+        size_t binaryRingBytes = 256 * 1024;
+
+        // Recent lines of both loggers kept in memory for LogPanel; 0 turns it off.
+        size_t viewerLines = 256 * 1024;
+
+        // Overridable with --sync-log, --log-queue <n>, --log-overflow block|drop-oldest|drop-newest,
+        // --log-flush-ms <ms>, --binary-log, --binary-log-ring <bytes> and --log-view-lines <n>.
+        static LogConfig FromCommandLine();
+    };
+
+    class LogRing;
+
     class Log
     {
     public:
-        static void Init();
+        // Console output starts immediately; file output is buffered until OpenFiles().
+        static void Init(const LogConfig& config = LogConfig());
+        // Creates logs/ and opens the log files, writing out what was logged so far.
+        // Does file IO, so App runs it as a worker startup phase.
+        static void OpenFiles();
+        // Drains the async queue and flushes every sink.
         static void Shutdown();
 
+        // Messages lost to a full queue (async mode, drop policies only) or a full binary ring.
+        [[nodiscard]] static uint64_t GetDroppedCount();
+
+        // Null when LogConfig::viewerLines is 0.
+        [[nodiscard]] static LogRing* GetRing();
+
         inline static std::shared_ptr<spdlog::logger>& GetCoreLogger() { return sCoreLogger; }
         inline static std::shared_ptr<spdlog::logger>& GetLayerLogger() { return sLayerLogger; }
 
@@ -20,18 +67,67 @@ namespace tg
     };
 }
 
+// Levels below TG_LOG_MIN_LEVEL compile to nothing, arguments included.
+#define TG_LOG_LEVEL_TRACE 0
+#define TG_LOG_LEVEL_INFO 2
+#define TG_LOG_LEVEL_WARN 3
+#define TG_LOG_LEVEL_ERROR 4
+#define TG_LOG_LEVEL_FATAL 5
+
+#ifndef TG_LOG_MIN_LEVEL
+#define TG_LOG_MIN_LEVEL TG_LOG_LEVEL_TRACE
+#endif
+
+#define TG_LOG_BINARY_(name, lvl, format, ...) \
+    static constexpr tg::LogSite tgLogSite{name, __FILE__, __LINE__, lvl, format}; \
+    tg::BinaryLog::Write(tgLogSite __VA_OPT__(,) __VA_ARGS__);
+
+#define TG_LOG_(logger, name, lvl, ...) \
+    do { \
+        if (tg::BinaryLog::IsEnabled()) \
+        { \
+            TG_LOG_BINARY_(name, lvl, __VA_ARGS__) \
+            if (lvl < spdlog::level::warn) break; \
+        } \
+        (tg::Log::logger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, lvl, __VA_ARGS__); \
+    } while (false)
+
+#define TG_LOG_DISABLED_(...) ((void)0)
+
 //engine logger macros
-#define TG_CoreLog_Trace(...) (tg::Log::GetCoreLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::info, __VA_ARGS__);
-#define TG_CoreLog_Info(...) (tg::Log::GetCoreLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::info, __VA_ARGS__);
-#define TG_CoreLog_Warn(...) (tg::Log::GetCoreLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::warn, __VA_ARGS__);
-#define TG_CoreLog_Error(...) (tg::Log::GetCoreLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::err, __VA_ARGS__);
-#define TG_CoreLog_Fatal(...) (tg::Log::GetCoreLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::critical, __VA_ARGS__);
-
-//game logger macros
-#define TG_LayerLog_Trace(...) (tg::Log::GetLayerLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::trace, __VA_ARGS__);
-#define TG_LayerLog_Info(...) (tg::Log::GetLayerLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::info, __VA_ARGS__);
-#define TG_LayerLog_Warn(...) (tg::Log::GetLayerLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::warn, __VA_ARGS__);
-#define TG_LayerLog_Error(...) (tg::Log::GetLayerLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::err, __VA_ARGS__);
-#define TG_LayerLog_Fatal(...) (tg::Log::GetLayerLogger())->log(spdlog::source_loc{__FILE__, __LINE__, tg::Log::GetFunctionName(__func__)}, spdlog::level::critical, __VA_ARGS__);
+#if TG_LOG_MIN_LEVEL <= TG_LOG_LEVEL_TRACE
+#define TG_CoreLog_Trace(...) TG_LOG_(GetCoreLogger, "Core", spdlog::level::trace, __VA_ARGS__);
+#define TG_LayerLog_Trace(...) TG_LOG_(GetLayerLogger, "Layer", spdlog::level::trace, __VA_ARGS__);
+#else
+#define TG_CoreLog_Trace(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#define TG_LayerLog_Trace(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#endif
+
+#if TG_LOG_MIN_LEVEL <= TG_LOG_LEVEL_INFO
+#define TG_CoreLog_Info(...) TG_LOG_(GetCoreLogger, "Core", spdlog::level::info, __VA_ARGS__);
+#define TG_LayerLog_Info(...) TG_LOG_(GetLayerLogger, "Layer", spdlog::level::info, __VA_ARGS__);
+#else
+#define TG_CoreLog_Info(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#define TG_LayerLog_Info(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#endif
+
+#if TG_LOG_MIN_LEVEL <= TG_LOG_LEVEL_WARN
+#define TG_CoreLog_Warn(...) TG_LOG_(GetCoreLogger, "Core", spdlog::level::warn, __VA_ARGS__);
+#define TG_LayerLog_Warn(...) TG_LOG_(GetLayerLogger, "Layer", spdlog::level::warn, __VA_ARGS__);
+#else
+#define TG_CoreLog_Warn(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#define TG_LayerLog_Warn(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#endif
+
+#if TG_LOG_MIN_LEVEL <= TG_LOG_LEVEL_ERROR
+#define TG_CoreLog_Error(...) TG_LOG_(GetCoreLogger, "Core", spdlog::level::err, __VA_ARGS__);
+#define TG_LayerLog_Error(...) TG_LOG_(GetLayerLogger, "Layer", spdlog::level::err, __VA_ARGS__);
+#else
+#define TG_CoreLog_Error(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#define TG_LayerLog_Error(...) TG_LOG_DISABLED_(__VA_ARGS__);
+#endif
+
+#define TG_CoreLog_Fatal(...) TG_LOG_(GetCoreLogger, "Core", spdlog::level::critical, __VA_ARGS__);
+#define TG_LayerLog_Fatal(...) TG_LOG_(GetLayerLogger, "Layer", spdlog::level::critical, __VA_ARGS__);
 
 #define TG(module, lvl, ...) TG_##module##_##lvl(__VA_ARGS__);
\ No newline at end of file
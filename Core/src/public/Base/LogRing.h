@@ -0,0 +1,113 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "spdlog/sinks/sink.h"
+
+namespace tg
+{
+    // One line as read back from a LogRing.
+    struct LogLine
+    {
+        static constexpr size_t kMaxText = 224;
+
+        uint64_t index = 0;
+        int64_t timeNs = 0; // system clock, since the Unix epoch
+        const char* file = nullptr; // __FILE__ of the call site, may be null
+        uint32_t line = 0;
+        spdlog::level::level_enum level = spdlog::level::info;
+        uint8_t logger = 0;
+        uint16_t size = 0;
+        char text[kMaxText];
+
+        [[nodiscard]] std::string_view GetText() const { return {text, size}; }
+    };
+
+    // Fixed-memory history of recent log lines for in-app viewing. Lines live in fixed-size
+    // slots indexed by a running line number; a full ring overwrites its oldest line, and
+    // text longer than LogLine::kMaxText is cut. Writers never block: each claims a slot with
+    // one fetch_add and publishes it through the slot's sequence number, which readers check
+    // before and after copying (a seqlock), so a line overwritten mid-read is reported as gone.
+    class LogRing
+    {
+    public:
+        // Rounded up to a power of two. Memory is capacity * 256 bytes of zeroed pages, which the
+        // OS only backs once lines reach them.
+        explicit LogRing(size_t capacity);
+
+        LogRing(const LogRing&) = delete;
+        LogRing& operator=(const LogRing&) = delete;
+
+        // Ids for LogLine::logger; call before logging starts.
+        uint8_t AddLogger(std::string name);
+        [[nodiscard]] const std::vector<std::string>& GetLoggerNames() const { return mLoggerNames; }
+
+        void Push(uint8_t logger, const spdlog::details::log_msg& msg);
+
+        // False if the line has not been written yet or was already overwritten.
+        bool Read(uint64_t index, LogLine& out) const;
+
+        // Indices of the lines still held are [GetFirstIndex(), GetEndIndex()).
+        [[nodiscard]] uint64_t GetEndIndex() const { return mHead.load(std::memory_order_acquire); }
+        [[nodiscard]] uint64_t GetFirstIndex() const
+        {
+            const uint64_t end = GetEndIndex();
+            return end > mMask + 1 ? end - (mMask + 1) : 0;
+        }
+        [[nodiscard]] size_t GetCapacity() const { return mMask + 1; }
+
+    private:
+        static constexpr size_t kTextWords = LogLine::kMaxText / sizeof(uint64_t);
+
+        // Plain words accessed through std::atomic_ref, so the array can come from calloc.
+        // Everything but the sequence is relaxed: a racing reader sees torn data instead of
+        // undefined behaviour, and the sequence check rejects it.
+        struct Slot
+        {
+            uint64_t sequence; // 2 * index + 1 while writing, 2 * index + 2 once written
+            uint64_t timeNs;
+            uint64_t file;
+            uint64_t meta;     // level | logger << 8 | size << 16 | line << 32
+            uint64_t text[kTextWords];
+        };
+        static_assert(sizeof(Slot) == 256);
+
+        struct FreeDeleter
+        {
+            // Constructors rather than a member initializer or default argument: GCC cannot
+            // use those of a nested class while the enclosing one is incomplete (mSlots below).
+            FreeDeleter() : bytes(0) {}
+            explicit FreeDeleter(size_t size) : bytes(size) {}
+            void operator()(Slot* slots) const;
+
+            size_t bytes;
+        };
+
+    private:
+        std::unique_ptr<Slot[], FreeDeleter> mSlots;
+        size_t mMask;
+        std::vector<std::string> mLoggerNames;
+        alignas(64) std::atomic<uint64_t> mHead{0};
+    };
+
+    // Feeds one logger into a LogRing; several sinks can share a ring.
+    class LogRingSink final : public spdlog::sinks::sink
+    {
+    public:
+        LogRingSink(std::shared_ptr<LogRing> ring, uint8_t logger)
+            : mRing(std::move(ring)), mLogger(logger) {}
+
+        void log(const spdlog::details::log_msg& msg) override { mRing->Push(mLogger, msg); }
+        void flush() override {}
+        // Lines are stored unformatted; LogPanel lays them out itself.
+        void set_pattern(const std::string&) override {}
+        void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+    private:
+        std::shared_ptr<LogRing> mRing;
+        uint8_t mLogger;
+    };
+}
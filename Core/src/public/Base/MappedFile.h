@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tg
+{
+    // Read-only memory mapping of a whole file. Unmapped on destruction.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        [[nodiscard]] bool IsOpen() const { return mData != nullptr; }
+        [[nodiscard]] const uint8_t* GetData() const { return static_cast<const uint8_t*>(mData); }
+        [[nodiscard]] size_t GetSize() const { return mSize; }
+
+    private:
+        void* mData = nullptr;
+        size_t mSize = 0;
+#ifdef _WIN32
+        void* mFile = nullptr;
+        void* mMapping = nullptr;
+#endif
+    };
+}
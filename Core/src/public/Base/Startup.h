@@ -0,0 +1,67 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Jobs/JobSystem.h"
+
+namespace tg
+{
+    enum class StartupThread : uint8_t
+    {
+        Main,   // GLFW, GL and ImGui context work
+        Worker, // file IO, font baking; runs on the JobSystem
+    };
+
+    // Startup work declared as named phases with dependencies, so independent phases
+    // overlap: worker phases are scheduled as soon as what they depend on is done, while
+    // the main thread runs its phases in declaration order and only blocks on a worker
+    // phase it actually needs. App declares the core phases (log files, platform, fonts,
+    // window, ImGui, layers); derived apps add theirs in their constructor.
+    class StartupSequence
+    {
+    public:
+        // Dependencies are phase names and may refer to phases declared later. A main-thread
+        // phase can only depend on main-thread phases declared before it.
+        void Add(std::string name, StartupThread thread, std::function<void()> fn,
+                 std::initializer_list<std::string_view> dependsOn = {});
+        void AddDependency(std::string_view phase, std::string_view dependsOn);
+
+        // Runs every phase and returns once all have finished.
+        void Run();
+
+        // Per-phase start, end and wait times relative to process start, to the core log.
+        void LogReport(uint64_t firstFrameNs) const;
+
+        // Steady-clock time of static initialization, the earliest point startup can be measured from.
+        [[nodiscard]] static uint64_t GetProcessStartNs();
+
+    private:
+        struct Phase
+        {
+            std::string name;
+            StartupThread thread = StartupThread::Main;
+            std::function<void()> fn;
+            std::vector<std::string> dependencyNames;
+            std::vector<size_t> dependencies;
+
+            JobHandle job;
+            bool scheduled = false;
+            uint64_t startNs = 0;
+            uint64_t endNs = 0;
+            uint64_t waitNs = 0; // main thread blocked on worker phases before starting
+        };
+
+        [[nodiscard]] size_t Find(std::string_view name) const;
+        void ScheduleReadyWorkers();
+        void RunPhase(Phase& phase);
+
+    private:
+        std::vector<Phase> mPhases;
+        uint64_t mRunStartNs = 0;
+        uint64_t mRunEndNs = 0;
+    };
+}
@@ -0,0 +1,100 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tg
+{
+    // Slot in the timer pool plus its generation; a handle to a fired or cancelled timer
+    // stays invalid after the slot is reused.
+    struct TimerHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        [[nodiscard]] bool IsValid() const { return index != UINT32_MAX; }
+        bool operator==(const TimerHandle&) const = default;
+    };
+
+    // Main-thread timers for UI state that expires (typing indicators, online status,
+    // debounced receipts, reconnect backoff). Backed by a hierarchical timing wheel:
+    // four levels of 256 slots at 1 ms resolution, so insert, reschedule and cancel are
+    // O(1) and only the timers that are due (or due to move down a level) are touched.
+    // Times are steady-clock nanoseconds, the same clock as Profiler::NowNs().
+    //
+    // App advances it once per frame, before OnUpdate, and sleeps until GetNextDeadlineNs()
+    // when the window is idle. Other threads reach it through MainThreadDispatcher.
+    class TimerService
+    {
+    public:
+        static constexpr uint64_t kTickNs = 1'000'000;
+
+        static TimerService& Get();
+
+        TimerService();
+
+        TimerService(const TimerService&) = delete;
+        TimerService& operator=(const TimerService&) = delete;
+
+        // Callbacks never run early; they run in the first Advance() at or after the deadline.
+        TimerHandle Schedule(std::chrono::nanoseconds delay, std::function<void()> fn);
+        TimerHandle ScheduleAt(uint64_t deadlineNs, std::function<void()> fn);
+        TimerHandle ScheduleRepeating(std::chrono::nanoseconds interval, std::function<void()> fn);
+        // Moves a live timer's deadline, keeping its callback and handle (debouncing).
+        bool Reschedule(TimerHandle handle, std::chrono::nanoseconds delay);
+        // Safe from inside any callback, including the timer's own.
+        bool Cancel(TimerHandle handle);
+
+        [[nodiscard]] bool IsActive(TimerHandle handle) const;
+        [[nodiscard]] size_t GetActiveCount() const { return mActiveCount; }
+
+        // Runs every timer due at nowNs. Returns how many fired.
+        uint32_t Advance(uint64_t nowNs);
+        // When the next Advance() can have work: exact for timers due within 256 ms, the
+        // cascade time of the enclosing slot for later ones. UINT64_MAX with no timers.
+        [[nodiscard]] uint64_t GetNextDeadlineNs() const;
+
+    private:
+        static constexpr int kLevels = 4;
+        static constexpr int kSlotBits = 8;
+        static constexpr uint32_t kSlots = 1u << kSlotBits;
+        static constexpr uint32_t kSlotMask = kSlots - 1;
+        static constexpr uint32_t kNil = UINT32_MAX;
+        static constexpr uint16_t kNoList = UINT16_MAX;
+        static constexpr uint16_t kFiring = UINT16_MAX - 1;
+
+        struct Node
+        {
+            std::function<void()> fn;
+            uint64_t deadlineTick = 0;
+            uint64_t intervalTicks = 0; // 0 = one-shot
+            uint32_t prev = kNil;
+            uint32_t next = kNil; // also links the free list
+            uint32_t generation = 1;
+            uint16_t list = kNoList; // level * kSlots + slot while queued
+        };
+
+        TimerHandle Add(uint64_t deadlineTick, uint64_t intervalTicks, std::function<void()> fn);
+        void Release(uint32_t index);
+        void Link(uint32_t index);
+        void Unlink(uint32_t index);
+        [[nodiscard]] const Node* Resolve(TimerHandle handle) const;
+
+        void ProcessTick(uint64_t tick);
+        void Cascade(int level, uint32_t slot);
+        void Fire(uint32_t index);
+        [[nodiscard]] uint64_t FindNextTick() const;
+
+    private:
+        std::vector<Node> mNodes;
+        uint32_t mFreeHead = kNil;
+        size_t mActiveCount = 0;
+
+        uint64_t mCurrentTick = 0; // last tick processed
+        uint64_t mTargetTick = 0;  // the tick the running Advance() catches up to
+        uint32_t mHeads[kLevels * kSlots];
+        uint64_t mOccupied[kLevels][kSlots / 64] = {};
+        uint32_t mFiredThisAdvance = 0;
+    };
+}
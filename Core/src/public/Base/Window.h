@@ -34,9 +34,19 @@ namespace tg
 
         void Init();
         void ProcessEvents();
+        // Blocks until input arrives, Wake() is called or the timeout passes.
+        void WaitEvents(double timeoutSeconds);
+        // Any thread: makes a pending WaitEvents() return.
+        static void Wake();
         void SwapBuffers();
+        void RequestClose();
 
         [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] bool IsIconified() const;
+        [[nodiscard]] bool IsHeadless() const { return mConfig.mode == Mode::Headless; }
+        [[nodiscard]] bool IsVSync() const { return mConfig.vsync == VSync::On; }
+        // False for the headless null renderer: ImGui frames are built but nothing is drawn.
+        [[nodiscard]] bool HasRenderContext() const { return mHasRenderContext; }
         [[nodiscard]] uint32_t GetWidth() const { return mConfig.dimensions.width; }
         [[nodiscard]] uint32_t GetHeight() const { return mConfig.dimensions.height; }
         [[nodiscard]] inline void* GetNativeWindow() const { return mWindow; }
@@ -45,11 +55,20 @@ namespace tg
 
         static Window* Create(const WindowConfig& config = WindowConfig());
 
+        // GLFW initialization on its own, so startup can query the monitor before any
+        // window exists. Init() calls it too; repeated calls do nothing.
+        static void InitPlatform(Mode mode);
+        // Content scale of the primary monitor, 1 without one (headless).
+        [[nodiscard]] static float GetPrimaryContentScale();
+
     private:
+        void InitHeadless();
+        void InitContext();
         void Shutdown();
     private:
         GLFWwindow* mWindow = nullptr;
         WindowConfig mConfig;
+        bool mHasRenderContext = false;
 
     };
 
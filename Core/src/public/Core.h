@@ -2,4 +2,11 @@
 
 #include "Base/App.h"
 #include "Base/Log.h"
+#include "Base/Startup.h"
+#include "Base/TimerService.h"
+#include "Debug/MemoryOverlay.h"
+#include "Debug/Profiler.h"
+#include "Debug/ProfilerOverlay.h"
 #include "ImGui/ImGuiLayer.h"
+#include "Jobs/JobSystem.h"
+#include "Jobs/MainThreadDispatcher.h"
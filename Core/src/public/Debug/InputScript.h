@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tg
+{
+    enum class InputScriptEventType : uint8_t
+    {
+        MousePos,
+        MouseButton,
+        MouseWheel,
+        Key,
+        Text,
+        Focus,
+        // Not input: a line of text for the app's command handler (open a tab, add an account...).
+        Command,
+    };
+
+    struct InputScriptEvent
+    {
+        uint64_t frame = 0;
+        InputScriptEventType type = InputScriptEventType::MousePos;
+        float x = 0.0f;    // MousePos position, MouseWheel offsets
+        float y = 0.0f;
+        int code = 0;      // MouseButton button, Key ImGuiKey, Text codepoint
+        bool down = false; // MouseButton, Key, Focus
+        std::string command;
+    };
+
+    // ImGui input keyed by App frame index, recorded from a live session or written by hand,
+    // so a run can be replayed exactly. One event per line: "<frame> <event> <args>"
+    //
+    //   12 mouse 412 233
+    //   12 button 0 down
+    //   20 wheel 0 -1
+    //   25 key Enter down
+    //   25 text 104
+    //   30 focus 1
+    //   40 command detach Telegram
+    //
+    // Lines starting with '#' are comments. Replayed frames run on a fixed 60 Hz ImGui clock
+    // (see ImGuiLayer::SetFixedDeltaTime), so clicks and double-clicks land as recorded.
+    class InputScript
+    {
+    public:
+        using CommandHandler = std::function<void(std::string_view command)>;
+
+        static constexpr float kFrameSeconds = 1.0f / 60.0f;
+
+        // Errors are logged with their line number.
+        bool Load(const std::string& path);
+        bool Save(const std::string& path) const;
+
+        // Frames must not go backwards.
+        void Add(InputScriptEvent event);
+        [[nodiscard]] const std::vector<InputScriptEvent>& GetEvents() const { return mEvents; }
+        [[nodiscard]] bool IsEmpty() const { return mEvents.empty(); }
+        // Frame of the last event; 0 when empty.
+        [[nodiscard]] uint64_t GetLastFrame() const { return mEvents.empty() ? 0 : mEvents.back().frame; }
+
+        // Recording: appends the input ImGui processed in this frame's NewFrame(). Call
+        // after NewFrame() and before the next one.
+        void CaptureFrame(uint64_t frame);
+
+        // Replay: queues this frame's input into ImGui and passes its commands to the handler.
+        // Call before NewFrame(), with increasing frames.
+        void ReplayFrame(uint64_t frame, const CommandHandler& handler);
+
+    private:
+        std::vector<InputScriptEvent> mEvents; // sorted by frame
+        size_t mReplayPos = 0;
+    };
+}
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+namespace tg
+{
+    // Window listing heap use per MemoryTag: live bytes, high-water mark and allocation
+    // rate. Shows a note instead when built without TG_TRACK_ALLOCATIONS.
+    class MemoryOverlay
+    {
+    public:
+        static void Render(bool* open);
+    };
+}
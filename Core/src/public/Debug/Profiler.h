@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace tg
+{
+    enum class TraceFormat : uint8_t { ChromeJson, Perfetto };
+
+    struct TraceCaptureConfig
+    {
+        float durationSeconds = 10.0f; // <= 0 records until EndCapture()
+        TraceFormat format = TraceFormat::ChromeJson;
+        std::string outputDir{ "traces" };
+    };
+
+    // Records instrumented scopes into per-thread buffers while a capture is running.
+    // A writer thread drains those buffers in the background and streams them to a
+    // Chrome JSON (chrome://tracing, ui.perfetto.dev) or Perfetto protobuf trace file.
+    class Profiler
+    {
+    public:
+        static void Init();
+        static void Shutdown();
+
+        static void BeginCapture(const TraceCaptureConfig& config = TraceCaptureConfig());
+        static void EndCapture();
+        [[nodiscard]] static bool IsCapturing() { return sCapturing.load(std::memory_order_relaxed); }
+        [[nodiscard]] static const std::string& GetLastCapturePath();
+
+        // Called once per frame by App: starts signal-requested captures and stops expired ones.
+        static void OnFrameEnd();
+
+        static void SetThreadName(const char* name);
+        static void RecordScope(const char* name, uint64_t startNs, uint64_t endNs);
+
+        // Latest value is kept for the overlay; while capturing it is also written as a counter track.
+        static void SetCounter(std::string_view name, double value);
+        static void ForEachCounter(const std::function<void(const char* name, double value)>& fn);
+
+        [[nodiscard]] static uint64_t NowNs();
+
+    private:
+        static std::atomic<bool> sCapturing;
+    };
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name)
+        : mName(name), mStartNs(Profiler::IsCapturing() ? Profiler::NowNs() : 0) {}
+
+        ~ProfileScope()
+        {
+            if (mStartNs != 0 && Profiler::IsCapturing())
+            {
+                Profiler::RecordScope(mName, mStartNs, Profiler::NowNs());
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* mName;
+        uint64_t mStartNs;
+    };
+}
+
+#define TG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define TG_PROFILE_CONCAT(a, b) TG_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(_MSC_VER)
+    #define TG_PROFILE_FUNCTION_NAME __FUNCTION__
+#else
+    #define TG_PROFILE_FUNCTION_NAME __PRETTY_FUNCTION__
+#endif
+
+#ifndef TG_DISABLE_PROFILING
+    // `name` must outlive the capture (string literal or static storage).
+    #define TG_PROFILE_SCOPE(name) ::tg::ProfileScope TG_PROFILE_CONCAT(tgProfileScope, __LINE__)(name);
+    #define TG_PROFILE_FUNCTION() TG_PROFILE_SCOPE(TG_PROFILE_FUNCTION_NAME)
+#else
+    #define TG_PROFILE_SCOPE(name)
+    #define TG_PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+namespace tg
+{
+    // Small always-on-top window listing the profiler counters (CPU frame time,
+    // per-viewport GPU time, ...) grouped by their "Group/" prefix.
+    class ProfilerOverlay
+    {
+    public:
+        static void Render(bool* open);
+    };
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+#include <imgui.h>
+
+namespace tg
+{
+    // Deep copy of an ImDrawData that stays valid after the next ImGui::NewFrame().
+    // Draw lists are owned by the snapshot and their buffers are reused between
+    // captures, so a steady-state Capture() does not allocate.
+    class DrawDataSnapshot
+    {
+    public:
+        DrawDataSnapshot() = default;
+        ~DrawDataSnapshot();
+
+        DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+        DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+        void Capture(const ImDrawData* source);
+        void Clear();
+
+        [[nodiscard]] ImDrawData* GetDrawData() { return mDrawData.Valid ? &mDrawData : nullptr; }
+
+    private:
+        ImDrawData mDrawData;
+        ImVector<ImDrawList*> mOwnedLists;
+    };
+}
@@ -0,0 +1,110 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <imgui.h>
+
+namespace tg
+{
+    // Pages glyphs into an already built atlas as text needs them, instead of baking
+    // every CJK/emoji range up front.
+    //
+    //  - Request(): main thread, while building the frame. Queues codepoints the font lacks.
+    //  - A worker rasterizes them from the primary font or the first fallback font that has them.
+    //  - ApplyCompleted(): before ImGui::NewFrame(). Packs finished bitmaps into free atlas rows,
+    //    growing the texture a page at a time, and adds the glyphs to the font.
+    //  - QueueUploads(): after ImGui::NewFrame(). Sends only the touched rows to the GPU, from
+    //    the main viewport's draw data so it also works with the render thread.
+    class DynamicGlyphs
+    {
+    public:
+        DynamicGlyphs() = default;
+        ~DynamicGlyphs();
+
+        DynamicGlyphs(const DynamicGlyphs&) = delete;
+        DynamicGlyphs& operator=(const DynamicGlyphs&) = delete;
+
+        void Start(ImFont* font, const std::string& fontPath, const std::vector<std::string>& fallbackPaths);
+        void Stop();
+
+        void Request(std::string_view utf8);
+        void ApplyCompleted();
+        void QueueUploads();
+
+        // Bumped whenever glyphs were added, so cached renderings of text can be dropped.
+        [[nodiscard]] uint32_t GetGeneration() const { return mGeneration; }
+        [[nodiscard]] int GetLoadedCount() const { return mLoadedCount; }
+
+    private:
+        struct RasterizedGlyph
+        {
+            uint32_t codepoint = 0;
+            bool found = false;
+            int width = 0;
+            int height = 0;
+            float x0 = 0.0f;
+            float y0 = 0.0f;
+            float advanceX = 0.0f;
+            std::vector<uint8_t> alpha;
+        };
+
+        struct Upload
+        {
+            std::vector<unsigned int> pixels;
+            ImTextureID texture{};
+            int width = 0;
+            int height = 0;
+            int y = 0;
+            int rows = 0;
+            bool resize = false;
+        };
+
+        struct FontSource;
+
+        void WorkerMain();
+        bool Pack(int width, int height, int& outX, int& outY);
+        void Grow(int minHeight);
+        static void UploadCallback(const ImDrawList* parentList, const ImDrawCmd* cmd);
+
+    private:
+        static constexpr int kPageHeight = 128;
+        static constexpr int kMaxTextureHeight = 8192;
+        // Uploads can be queued on consecutive frames; three slots cover the frame that is
+        // being built plus up to two still in flight on the render thread.
+        static constexpr int kUploadSlots = 3;
+
+        ImFont* mFont = nullptr;
+        std::vector<uint64_t> mRequested; // one bit per codepoint
+
+        // Shelf packer over the rows added for dynamic glyphs.
+        int mShelfX = 0;
+        int mShelfY = -1;
+        int mShelfHeight = 0;
+        int mDirtyY0 = 0;
+        int mDirtyY1 = 0;
+        bool mResized = false;
+
+        Upload mUploads[kUploadSlots];
+        int mNextUpload = 0;
+
+        uint32_t mGeneration = 0;
+        int mLoadedCount = 0;
+        int mMissingCount = 0;
+
+        // Worker state
+        std::vector<FontSource*> mSources;
+        float mSizePixels = 0.0f;
+        float mAscent = 0.0f;
+        std::deque<uint32_t> mPending;
+        std::vector<RasterizedGlyph> mCompleted;
+        bool mStopRequested = false;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::thread mThread;
+    };
+}
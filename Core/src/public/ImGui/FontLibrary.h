@@ -0,0 +1,82 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <imgui.h>
+
+#include "ImGui/DynamicGlyphs.h"
+
+namespace tg
+{
+    struct FontLibraryConfig
+    {
+        // The first file that exists is used; ImGui's built-in font if none does.
+        std::vector<std::string> fontPaths;
+        float sizePixels = 18.0f;
+        // Zero-terminated range pairs as for AddFontFromFileTTF. Null means ImGui's default ranges.
+        const ImWchar* glyphRanges = nullptr;
+        std::string cacheDir = "cache/fonts";
+        bool useCache = true;
+
+        // Searched, in order, for codepoints the main font lacks (CJK, symbols, emoji).
+        std::vector<std::string> fallbackFontPaths;
+        bool dynamicGlyphs = true;
+
+        // Platform font locations, overridable with --font <path>, TG_FONT, --font-size <px>,
+        // --no-font-cache and --no-dynamic-glyphs.
+        static FontLibraryConfig FromCommandLine();
+    };
+
+    // Loads the UI font into the current ImGui context. The baked atlas (RGBA32 texture,
+    // white pixel / line UVs and glyph metrics) is cached on disk, keyed by font file,
+    // size, DPI scale, glyph ranges and ImGui version, so later launches map the cache
+    // instead of rasterizing the font again.
+    class FontLibrary
+    {
+    public:
+        static FontLibrary& Get();
+
+        void SetConfig(const FontLibraryConfig& config) { mConfig = config; }
+        [[nodiscard]] const FontLibraryConfig& GetConfig() const { return mConfig; }
+
+        // Bakes the atlas (or loads it from the cache) into a standalone ImFontAtlas. Needs no
+        // ImGui context, so startup runs it on a worker while the window comes up; pass
+        // GetPreparedAtlas() to ImGui::CreateContext() to use it.
+        void Prepare(float dpiScale);
+        [[nodiscard]] ImFontAtlas* GetPreparedAtlas() const { return mPreparedAtlas.get(); }
+
+        // Leaves io.Fonts with its texture data ready, so the renderer only has to upload it.
+        // Uses the prepared atlas when it is io.Fonts and was baked for the same scale.
+        ImFont* LoadDefaultFont(float dpiScale);
+        void Shutdown() { mDynamicGlyphs.Stop(); }
+
+        // Call with any text that may contain glyphs outside the baked ranges; they show up
+        // a frame or two later. Cheap for text whose glyphs were seen before.
+        void RequestGlyphs(std::string_view utf8) { mDynamicGlyphs.Request(utf8); }
+        // Around ImGui::NewFrame(): glyph tables may only change before it, uploads are queued after.
+        void BeginFrame() { mDynamicGlyphs.ApplyCompleted(); }
+        void QueueTextureUploads() { mDynamicGlyphs.QueueUploads(); }
+        [[nodiscard]] uint32_t GetGlyphGeneration() const { return mDynamicGlyphs.GetGeneration(); }
+
+        [[nodiscard]] const std::string& GetFontPath() const { return mFontPath; }
+        [[nodiscard]] bool WasLoadedFromCache() const { return mLoadedFromCache; }
+
+    private:
+        ImFont* LoadAtlas(ImFontAtlas* atlas, float dpiScale);
+        bool LoadCache(const std::string& cachePath, uint64_t key, ImFontAtlas* atlas, ImFontConfig& config, double& bakeMs);
+        void WriteCache(const std::string& cachePath, uint64_t key, ImFontAtlas* atlas, const ImFont* font, double bakeMs) const;
+
+    private:
+        FontLibraryConfig mConfig;
+        std::string mFontPath;
+        bool mLoadedFromCache = false;
+        DynamicGlyphs mDynamicGlyphs;
+
+        // Outlives the ImGui context that borrows it; freed with the library.
+        std::unique_ptr<ImFontAtlas> mPreparedAtlas;
+        ImFont* mPreparedFont = nullptr;
+        float mPreparedScale = 0.0f;
+    };
+}
@@ -1,8 +1,19 @@
 ﻿#pragma once
+#include <cstdint>
 #include "Base/Layer.h"
 
 namespace tg
 {
+    // Totals over every viewport's ImDrawData for the last rendered frame.
+    struct ImGuiFrameStats
+    {
+        uint32_t viewports = 0;
+        uint32_t drawLists = 0;
+        uint32_t drawCalls = 0;
+        uint32_t vertices = 0;
+        uint32_t indices = 0;
+    };
+
     class ImGuiLayer : public Layer
     {
     public:
@@ -14,7 +25,22 @@ namespace tg
 
         void AllowInputEvents(bool allowEvents);
 
+        // Overrides the measured frame time ImGui sees (double-click and key-repeat timing);
+        // 0 uses real time. Set while replaying an InputScript.
+        void SetFixedDeltaTime(float seconds) { mFixedDeltaTime = seconds; }
+
+        [[nodiscard]] const ImGuiFrameStats& GetFrameStats() const { return mFrameStats; }
+        // When true the layer swaps buffers itself and App must not call Window::SwapBuffers.
+        [[nodiscard]] virtual bool PresentsOnRenderThread() const { return false; }
+
         static ImGuiLayer* Create();
-    
+
+    protected:
+        // Call right after ImGui::Render().
+        void CollectFrameStats();
+
+    protected:
+        ImGuiFrameStats mFrameStats;
+        float mFixedDeltaTime = 0.0f;
     };
 }
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include <imgui.h>
+
+namespace tg
+{
+    // Caches what a window region drew into an offscreen texture and, while nothing
+    // could have changed it, draws that texture as a single quad instead of the widgets.
+    //
+    //  if (!view.DrawCached(dirty))
+    //  {
+    //      RenderWidgets();
+    //      view.EndLive();
+    //  }
+    //
+    // The cache is dropped on: dirty (model change), mouse/keyboard input inside the
+    // region, an active item, an open popup, or a size change. It is recaptured after
+    // a few quiet live frames, so hover states settle before they are frozen.
+    class RetainedView
+    {
+    public:
+        RetainedView() = default;
+        ~RetainedView();
+
+        RetainedView(const RetainedView&) = delete;
+        RetainedView& operator=(const RetainedView&) = delete;
+
+        // Call inside the window whose content is cached, before any content is submitted.
+        // Returns true if the cached texture was drawn; the caller must skip its widgets.
+        bool DrawCached(bool contentDirty);
+        // Call after the widgets, still inside the same window.
+        void EndLive();
+
+        void Invalidate();
+        // Drops the offscreen texture as well; it is recreated on the next capture. Outside
+        // a frame, while the render thread owns the context, it is freed in the next frame.
+        void Release();
+        [[nodiscard]] bool IsCached() const { return mCached; }
+
+        // Set by the renderer; without a GL renderer every frame is rendered live.
+        static void SetSupported(bool supported) { sSupported = supported; }
+        static bool IsSupported() { return sSupported; }
+        // Frees what Release() left for the next frame. Called by the ImGui layer once per
+        // frame and on detach, once the render thread has stopped.
+        static void ReleaseOrphans();
+
+    private:
+        struct Shared;
+
+        static void RenderCapture(const ImDrawList* parentList, const ImDrawCmd* cmd);
+        static void ReleaseCapture(const ImDrawList* parentList, const ImDrawCmd* cmd);
+        static void ReleaseShared(Shared* shared);
+
+        static constexpr int kSettleFrames = 3;
+
+        Shared* mShared = nullptr;
+        ImVec2 mSize = ImVec2(0, 0);
+        ImVec2 mContentSize = ImVec2(0, 0);
+        uint32_t mGeneration = 0;
+        uint32_t mGlyphGeneration = 0;
+        int mQuietFrames = 0;
+        bool mCached = false;
+        bool mLiveQuiet = false;
+
+        static bool sSupported;
+        static std::vector<Shared*> sOrphans;
+    };
+}
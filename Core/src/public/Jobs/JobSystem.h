@@ -0,0 +1,134 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Jobs/MainThreadDispatcher.h"
+
+namespace tg
+{
+    // Lanes are served strictly in order. Low (bulk) jobs never occupy every worker, so a
+    // High job submitted behind a pile of indexing work starts as soon as it is queued.
+    enum class JobPriority : uint8_t
+    {
+        High,   // latency-sensitive: UI prefetch, decoding what is about to be shown
+        Normal,
+        Low,    // bulk: indexing, warming caches
+    };
+
+    struct Job;
+
+    // Shared reference to a scheduled job; use it to wait or to chain work after it.
+    class JobHandle
+    {
+    public:
+        JobHandle() = default;
+
+        [[nodiscard]] bool IsValid() const { return mJob != nullptr; }
+        // Invalid handles count as done.
+        [[nodiscard]] bool IsDone() const;
+
+    private:
+        friend class JobSystem;
+        explicit JobHandle(std::shared_ptr<Job> job) : mJob(std::move(job)) {}
+
+        std::shared_ptr<Job> mJob;
+    };
+
+    // Work-stealing thread pool. Every worker has its own deque per lane: it pushes and pops
+    // at the back (newest first, cache-warm), idle workers steal from the front of the
+    // others. Jobs submitted from outside the pool go through a shared queue per lane.
+    //
+    //  JobHandle parse = jobs.Schedule([&] { Parse(); });
+    //  JobHandle index = jobs.Then(parse, [&] { Index(); }, JobPriority::Low);
+    //  jobs.RunOnMainThread([&] { Show(); });  // applied on the main thread, next frame
+    class JobSystem
+    {
+    public:
+        static JobSystem& Get();
+
+        // workerCount 0: one per hardware thread minus the main thread, or --job-workers <n>.
+        // At least two are started, so one is always free of Low work.
+        void Init(uint32_t workerCount = 0);
+        // Waits for running jobs; queued ones are dropped.
+        void Shutdown();
+
+        JobHandle Schedule(std::function<void()> work, JobPriority priority = JobPriority::Normal);
+        // Runs once every dependency has finished.
+        JobHandle Schedule(std::function<void()> work, JobPriority priority, std::span<const JobHandle> dependencies);
+        JobHandle Then(const JobHandle& dependency, std::function<void()> work, JobPriority priority = JobPriority::Normal);
+
+        // Splits [0, count) into batches of at most batchSize and runs fn(begin, end) on each.
+        // The returned handle finishes after the last batch.
+        JobHandle ParallelFor(size_t count, size_t batchSize, std::function<void(size_t begin, size_t end)> fn,
+                              JobPriority priority = JobPriority::Normal);
+
+        // Runs queued jobs on the calling thread until the handle is done. After Shutdown() it
+        // returns for a job that was dropped, which stays not done.
+        void Wait(const JobHandle& handle);
+
+        // Hand-off back to the main thread through MainThreadDispatcher: fn runs in the next
+        // frame's dispatch, or later if that frame's budget is used up.
+        void RunOnMainThread(std::function<void()> fn, DispatchPriority priority = DispatchPriority::Normal)
+        {
+            MainThreadDispatcher::Get().Post(std::move(fn), priority);
+        }
+
+        // Per-worker utilization over the last interval, as profiler counters.
+        void PublishStats();
+
+        [[nodiscard]] uint32_t GetWorkerCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+        [[nodiscard]] bool IsRunning() const { return !mWorkers.empty(); }
+
+    private:
+        static constexpr int kLaneCount = 3;
+        using JobRef = std::shared_ptr<Job>;
+
+        struct Lanes
+        {
+            std::mutex mutex;
+            std::deque<JobRef> queues[kLaneCount];
+        };
+
+        struct Worker
+        {
+            Lanes lanes;
+            std::thread thread;
+            std::string name;
+            std::string counterName;
+            std::atomic<uint64_t> busyNs{0};
+            uint64_t lastBusyNs = 0;
+        };
+
+        void WorkerMain(uint32_t index);
+        void Enqueue(JobRef job);
+        void Release(const JobRef& job);
+        JobRef TryPop(int workerIndex);
+        JobRef TryPopLane(int workerIndex, int lane);
+        void Execute(const JobRef& job, int workerIndex);
+        bool HasRunnableWork() const;
+
+    private:
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+        Lanes mInjected;
+
+        // Queued job counts; guarded by mSleepMutex when raised so sleeping workers never miss one.
+        std::atomic<uint32_t> mQueued[kLaneCount]{};
+        std::atomic<uint32_t> mLowRunning{0};
+        uint32_t mMaxLowRunning = 1;
+        bool mStopRequested = false;
+        std::mutex mSleepMutex;
+        std::condition_variable mWake;
+
+        uint64_t mLastStatsNs = 0;
+    };
+}
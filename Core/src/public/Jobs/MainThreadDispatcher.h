@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace tg
+{
+    enum class DispatchPriority : uint8_t
+    {
+        Critical, // runs in the next drain whatever the budget
+        High,     // what the user is looking at
+        Normal,
+        Low,      // prefetched or off-screen results
+    };
+
+    // Queue of work that must run on the main thread (applying background results to UI
+    // models). App drains it once per frame between OnUpdate and RenderImGui, for at most
+    // the time budget; whatever does not fit waits for the next frame. Lanes are drained in
+    // priority order, and a task that has waited kMaxWaitFrames runs regardless of budget,
+    // so low lanes cannot starve.
+    class MainThreadDispatcher
+    {
+    public:
+        static constexpr uint32_t kMaxWaitFrames = 60;
+
+        static MainThreadDispatcher& Get();
+
+        // Any thread.
+        void Post(std::function<void()> task, DispatchPriority priority = DispatchPriority::Normal);
+
+        // Overridable with --dispatch-budget-us <microseconds>. Budgets <= 0 are ignored; cast
+        // to the unsigned clock they would mean no limit at all.
+        void SetBudget(std::chrono::microseconds budget)
+        {
+            if (budget.count() > 0) mBudget = budget;
+        }
+        [[nodiscard]] std::chrono::microseconds GetBudget() const { return mBudget; }
+
+        // Called after every Post(), from the posting thread, so an idle main loop wakes up.
+        void SetWakeHandler(void (*handler)()) { mWakeHandler.store(handler); }
+
+        // Main thread, once per frame. Returns how many tasks ran.
+        uint32_t Drain();
+
+        [[nodiscard]] size_t GetBacklog() const { return mBacklog; }
+
+    private:
+        static constexpr int kLaneCount = 4;
+
+        struct Task
+        {
+            std::function<void()> fn;
+            uint64_t postedFrame = 0;
+        };
+
+    private:
+        std::mutex mMutex;
+        std::deque<Task> mIncoming[kLaneCount];
+        uint64_t mFrame = 0; // bumped by Drain under mMutex
+        std::atomic<void (*)()> mWakeHandler{nullptr};
+
+        // Main thread only
+        std::deque<Task> mPending[kLaneCount];
+        std::chrono::microseconds mBudget{2000};
+        size_t mBacklog = 0;
+    };
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace tg
+{
+    // What a heap allocation is charged to: the innermost TG_MEMORY_TAG scope on the
+    // allocating thread, or Untagged. ImGui's allocations are always ImGui.
+    enum class MemoryTag : uint8_t
+    {
+        Untagged,
+        ImGui,
+        Panels,
+        Chats,
+        Messages,
+        Textures, // GL textures, reported by size
+        Logs,
+        Count
+    };
+
+    [[nodiscard]] const char* GetMemoryTagName(MemoryTag tag);
+
+    struct MemoryTagStats
+    {
+        int64_t liveBytes = 0;
+        int64_t peakBytes = 0;        // since start or the last ResetPeaks()
+        uint64_t allocations = 0;     // cumulative, for rates
+        uint64_t allocatedBytes = 0;  // cumulative, for rates
+    };
+
+    // Counts global operator new calls when built with TG_TRACK_ALLOCATIONS (Debug), and
+    // charges every heap block (operator new and ImGui's allocator) to a MemoryTag with a
+    // small header in front of it. Blocks must be freed by the module that allocated them.
+    // ImGui is not included in the operator new counts. Without the define every count
+    // stays zero and TG_MEMORY_TAG compiles to nothing.
+    class AllocationTracker
+    {
+    public:
+        [[nodiscard]] static constexpr bool IsEnabled()
+        {
+#ifdef TG_TRACK_ALLOCATIONS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Allocations made by the calling thread since it started.
+        [[nodiscard]] static uint64_t GetThreadAllocationCount();
+        [[nodiscard]] static uint64_t GetTotalAllocationCount();
+
+        [[nodiscard]] static MemoryTagStats GetTagStats(MemoryTag tag);
+        // All tags together; its peak is the process high-water mark, not the sum of peaks.
+        [[nodiscard]] static MemoryTagStats GetTotalStats();
+        static void ResetPeaks();
+
+        // Memory the hooks cannot see (calloc, GL objects): bytes > 0 when it is allocated,
+        // the same amount negated when it is released. Inline and empty without the define.
+#ifdef TG_TRACK_ALLOCATIONS
+        static void RecordExternal(MemoryTag tag, int64_t bytes);
+#else
+        static void RecordExternal(MemoryTag, int64_t) {}
+#endif
+    };
+
+#ifdef TG_TRACK_ALLOCATIONS
+    class MemoryTagScope
+    {
+    public:
+        explicit MemoryTagScope(MemoryTag tag);
+        ~MemoryTagScope();
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+    private:
+        MemoryTag mPrevious;
+    };
+#endif
+}
+
+#define TG_MEMORY_CONCAT_IMPL(a, b) a##b
+#define TG_MEMORY_CONCAT(a, b) TG_MEMORY_CONCAT_IMPL(a, b)
+
+#ifdef TG_TRACK_ALLOCATIONS
+    #define TG_MEMORY_TAG(tag) ::tg::MemoryTagScope TG_MEMORY_CONCAT(tgMemoryTag, __LINE__)(::tg::MemoryTag::tag);
+#else
+    #define TG_MEMORY_TAG(tag)
+#endif
@@ -0,0 +1,121 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include "spdlog/fmt/fmt.h"
+#include "Memory/FrameArena.h"
+
+namespace tg
+{
+    // String builder over storage it does not own. Always zero-terminated; text that does
+    // not fit is cut off (at a UTF-8 boundary) instead of allocating.
+    class StringBuilder
+    {
+    public:
+        StringBuilder(const StringBuilder&) = delete;
+        StringBuilder& operator=(const StringBuilder&) = delete;
+
+        StringBuilder& Append(std::string_view text)
+        {
+            size_t count = std::min(text.size(), mCapacity - mSize);
+            if (count < text.size())
+            {
+                while (count > 0 && (static_cast<unsigned char>(text[count]) & 0xC0) == 0x80) --count;
+                mTruncated = true;
+            }
+            std::memcpy(mData + mSize, text.data(), count);
+            mSize += count;
+            mData[mSize] = '\0';
+            return *this;
+        }
+
+        StringBuilder& Append(char c)
+        {
+            return Append(std::string_view(&c, 1));
+        }
+
+        template<typename... Args>
+        StringBuilder& AppendFormat(fmt::format_string<Args...> format, Args&&... args)
+        {
+            const auto result = fmt::format_to_n(mData + mSize, mCapacity - mSize, format, std::forward<Args>(args)...);
+            size_t written = std::min(static_cast<size_t>(result.size), mCapacity - mSize);
+            if (written < static_cast<size_t>(result.size))
+            {
+                // The cut may fall inside a code point: drop its lead byte and whatever of it
+                // was written.
+                const char* text = mData + mSize;
+                size_t start = written;
+                while (start > 0 && written - start < 4 && (static_cast<unsigned char>(text[start - 1]) & 0xC0) == 0x80) --start;
+                if (start > 0)
+                {
+                    const unsigned char lead = static_cast<unsigned char>(text[start - 1]);
+                    const size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+                    if (start - 1 + length > written) written = start - 1;
+                }
+                mTruncated = true;
+            }
+            mSize += written;
+            mData[mSize] = '\0';
+            return *this;
+        }
+
+        void Clear()
+        {
+            mSize = 0;
+            mTruncated = false;
+            mData[0] = '\0';
+        }
+
+        [[nodiscard]] const char* CStr() const { return mData; }
+        [[nodiscard]] std::string_view GetView() const { return {mData, mSize}; }
+        [[nodiscard]] size_t GetSize() const { return mSize; }
+        [[nodiscard]] size_t GetCapacity() const { return mCapacity; }
+        [[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+        [[nodiscard]] bool IsTruncated() const { return mTruncated; }
+
+        operator std::string_view() const { return GetView(); }
+
+    protected:
+        // capacity includes the terminator.
+        StringBuilder(char* data, size_t capacity)
+            : mData(data), mCapacity(capacity - 1)
+        {
+            mData[0] = '\0';
+        }
+
+    private:
+        char* mData;
+        size_t mCapacity;
+        size_t mSize = 0;
+        bool mTruncated = false;
+    };
+
+    // Builder with inline storage, for labels and IDs built on the stack.
+    template<size_t N>
+    class FixedString : public StringBuilder
+    {
+        static_assert(N > 1);
+
+    public:
+        FixedString() : StringBuilder(mStorage, N) {}
+
+        explicit FixedString(std::string_view text) : FixedString()
+        {
+            Append(text);
+        }
+
+    private:
+        char mStorage[N];
+    };
+
+    // Builder whose storage comes from the frame arena. Valid until the next frame starts.
+    class FrameString : public StringBuilder
+    {
+    public:
+        explicit FrameString(size_t capacity, FrameArena& arena = FrameArena::Get())
+            : StringBuilder(arena.AllocateArray<char>(capacity + 1), capacity + 1) {}
+    };
+}
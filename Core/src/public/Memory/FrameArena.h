@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace tg
+{
+    // Bump allocator for data that only lives until the end of the frame (labels, sorted
+    // views, scratch arrays). Reset by App at the top of every frame; nothing is destroyed,
+    // so only trivially destructible types go in here. Main thread only.
+    //
+    // When a frame needs more than the capacity, the extra comes from overflow blocks and
+    // the next Reset() replaces everything with one block big enough for that frame, so a
+    // steady-state frame never touches the global heap.
+    class FrameArena
+    {
+    public:
+        static constexpr size_t kDefaultCapacity = 256 * 1024;
+
+        static FrameArena& Get();
+
+        explicit FrameArena(size_t capacity = kDefaultCapacity);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        [[nodiscard]] void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        [[nodiscard]] T* AllocateArray(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Invalidates everything handed out since the previous Reset().
+        void Reset();
+
+        [[nodiscard]] size_t GetUsed() const { return mOffset + mOverflowUsed; }
+        [[nodiscard]] size_t GetCapacity() const { return mCapacity; }
+        [[nodiscard]] size_t GetPeak() const { return mPeak; }
+
+    private:
+        void* AllocateOverflow(size_t size, size_t alignment);
+
+    private:
+        struct Block
+        {
+            std::byte* data = nullptr;
+            size_t size = 0;
+        };
+
+        std::byte* mBuffer = nullptr;
+        size_t mCapacity = 0;
+        size_t mOffset = 0;
+        size_t mPeak = 0;
+
+        std::vector<Block> mOverflow;
+        size_t mOverflowOffset = 0; // into mOverflow.back()
+        size_t mOverflowUsed = 0;
+    };
+}
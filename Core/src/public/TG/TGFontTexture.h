@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <imgui.h>
+
+namespace tg
+{
+    // GL side of incremental font atlas updates. Must run on the thread that owns the
+    // main GL context; the texture name (and so the atlas TexID) never changes.
+    class TGFontTexture
+    {
+    public:
+        // resize: respecify the whole texture as width x height from pixels.
+        // Otherwise: replace rows [y, y + rows) from pixels (tightly packed RGBA32 rows).
+        static void Upload(ImTextureID texture, int width, int height, int y, int rows, const void* pixels, bool resize);
+    };
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace tg
+{
+    // GL_TIME_ELAPSED queries per ImGui viewport. Each viewport owns a small ring of
+    // query objects created in its own GL context (queries are not shared between
+    // contexts). Results are read back one or more frames later and only once
+    // GL_QUERY_RESULT_AVAILABLE is set, so the CPU never waits on the GPU.
+    class TGGpuTimer
+    {
+    public:
+        struct ViewportStats
+        {
+            std::string counterName;
+            double lastMs = 0.0;
+            double averageMs = 0.0;
+            uint64_t measuredFrames = 0;
+            uint64_t skippedFrames = 0; // ring slot still in flight, frame not timed
+        };
+
+        TGGpuTimer() = default;
+        ~TGGpuTimer() = default;
+
+        TGGpuTimer(const TGGpuTimer&) = delete;
+        TGGpuTimer& operator=(const TGGpuTimer&) = delete;
+
+        // Begin/End must be called with the viewport's context current.
+        void Begin(uint32_t viewportID, bool isMainViewport);
+        void End(uint32_t viewportID);
+
+        // Releases queries of the current context's viewport.
+        void Release(uint32_t viewportID);
+        // Forgets a viewport whose context is being destroyed (its queries die with it).
+        void Forget(uint32_t viewportID);
+
+        // Reports per-viewport and total GPU time to the profiler counters.
+        void Publish();
+
+        [[nodiscard]] const std::unordered_map<uint32_t, ViewportStats>& GetStats() const { return mStats; }
+
+    private:
+        static constexpr uint32_t kQueryCount = 2;
+
+        struct QueryRing
+        {
+            uint32_t queries[kQueryCount] = {};
+            bool pending[kQueryCount] = {};
+            uint32_t writeIndex = 0;
+            bool active = false;
+            bool initialized = false;
+        };
+
+        void Collect(uint32_t viewportID, QueryRing& ring);
+
+        std::unordered_map<uint32_t, QueryRing> mRings;
+        std::unordered_map<uint32_t, ViewportStats> mStats;
+    };
+}
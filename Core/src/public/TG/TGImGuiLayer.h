@@ -1,5 +1,9 @@
 ﻿#pragma once
+#include <memory>
+
 #include "ImGui/ImGuiLayer.h"
+#include "TG/TGGpuTimer.h"
+#include "TG/TGRenderThread.h"
 
 #ifndef IMGUI_IMPL_API
 #define IMGUI_IMPL_API
@@ -24,7 +28,21 @@ namespace tg
         virtual void OnAttach() override;
         virtual void OnDetach() override;
         virtual void OnImGuiRender() override;
+
+        [[nodiscard]] bool PresentsOnRenderThread() const override { return mRenderThread != nullptr; }
+
+        [[nodiscard]] const TGGpuTimer& GetGpuTimer() const { return mGpuTimer; }
+    private:
+        void RenderMainViewport(ImDrawData* drawData);
+        void StopRenderThread();
+
+        static void RenderWindowTimed(ImGuiViewport* viewport, void* renderArg);
+        static void DestroyWindowTimed(ImGuiViewport* viewport);
+
     private:
         float mTime = 0.0f;
+        bool mHasRenderer = true;
+        TGGpuTimer mGpuTimer;
+        std::unique_ptr<TGRenderThread> mRenderThread;
     };
 }
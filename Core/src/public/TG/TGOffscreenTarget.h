@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <cstdint>
+#include <imgui.h>
+
+namespace tg
+{
+    // GL framebuffer + color texture that ImGui draw data can be rendered into.
+    // Every call must happen on the thread that owns the main GL context.
+    class TGOffscreenTarget
+    {
+    public:
+        TGOffscreenTarget() = default;
+        ~TGOffscreenTarget() = default;
+
+        TGOffscreenTarget(const TGOffscreenTarget&) = delete;
+        TGOffscreenTarget& operator=(const TGOffscreenTarget&) = delete;
+
+        // Resizes the target to DisplaySize * FramebufferScale, clears it and renders drawData.
+        // Restores the previously bound framebuffer and viewport.
+        void Render(ImDrawData* drawData, const ImVec4& clearColor);
+        void Release();
+
+        [[nodiscard]] ImTextureID GetTextureID() const { return (ImTextureID)(intptr_t)mTexture; }
+
+    private:
+        void Resize(int width, int height);
+
+    private:
+        uint32_t mFramebuffer = 0;
+        uint32_t mTexture = 0;
+        int mWidth = 0;
+        int mHeight = 0;
+    };
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "ImGui/DrawDataSnapshot.h"
+
+struct GLFWwindow;
+
+namespace tg
+{
+    // Owns the window's GL context on a dedicated thread. The main thread submits a
+    // deep copy of each frame's ImDrawData into one of two snapshots, so building
+    // frame N+1 overlaps GL submission and present (including the vsync wait) of frame N.
+    class TGRenderThread
+    {
+    public:
+        using RenderFn = std::function<void(ImDrawData*)>;
+
+        TGRenderThread(GLFWwindow* window, int swapInterval, RenderFn render);
+        ~TGRenderThread();
+
+        TGRenderThread(const TGRenderThread&) = delete;
+        TGRenderThread& operator=(const TGRenderThread&) = delete;
+
+        // The caller must release the context (glfwMakeContextCurrent(nullptr)) before Start().
+        void Start();
+        // Renders any pending frame, then gives the context back (not current on any thread).
+        void Stop();
+
+        // Main thread. Blocks only if the render thread is still reading the snapshot we need.
+        void Submit(const ImDrawData* drawData);
+
+    private:
+        void ThreadMain();
+
+    private:
+        GLFWwindow* mWindow;
+        int mSwapInterval;
+        RenderFn mRender;
+
+        DrawDataSnapshot mSnapshots[2];
+        int mWriteIndex = 0;
+        int mPendingIndex = -1;
+        int mRenderingIndex = -1;
+        bool mStopRequested = false;
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::thread mThread;
+    };
+}
@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "spdlog/common.h"
+
+#include "UI/Panel.h"
+
+namespace tg
+{
+    struct LogLine;
+
+    // Recent lines of the core and layer loggers, read from Log::GetRing(). Only the rows in
+    // view are read and laid out; the filter (minimum level, loggers, case-insensitive text)
+    // is applied by a scan that runs in OnUpdate() under a time budget, keeps up with new
+    // lines without rescanning, and only re-tests the current matches when the filter is
+    // narrowed.
+    class LogPanel : public Panel
+    {
+    public:
+        explicit LogPanel(const std::string& name = "Log");
+
+        void OnRender() override;
+        void OnUpdate(TimeStep ts) override;
+
+        // Filter settings only; the lines come from the ring.
+        void OnSaveState(BinaryWriter& writer) const override;
+        void OnRestore(BinaryReader& reader) override;
+        bool CanHibernate() const override { return true; }
+        void OnHibernate() override;
+
+    private:
+        struct Filter
+        {
+            spdlog::level::level_enum minLevel = spdlog::level::trace;
+            uint32_t loggerMask = UINT32_MAX;
+            std::string text; // lower case
+
+            // Everything this matches, `previous` matched too.
+            [[nodiscard]] bool Narrows(const Filter& previous) const;
+            [[nodiscard]] bool Matches(const LogLine& line) const;
+        };
+
+        void SetFilter(Filter filter);
+        void Scan(uint64_t budgetNs);
+        void RenderToolbar();
+        void RenderLines();
+
+    private:
+        Filter mFilter;
+        // Indices of matching lines, oldest first.
+        std::deque<uint64_t> mMatches;
+        // Previous matches still to re-test after the filter was narrowed; they all precede mScanned.
+        std::vector<uint64_t> mCandidates;
+        size_t mCandidatePos = 0;
+        // Next ring index the filter has not seen.
+        uint64_t mScanned = 0;
+        uint64_t mClearedBefore = 0;
+
+        char mSearchBuffer[256] = {};
+        bool mAutoScroll = true;
+    };
+}
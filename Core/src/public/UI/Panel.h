@@ -1,8 +1,16 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <imgui.h>
 
+#include "Base/BinaryStream.h"
+#include "Base/Time.h"
+#include "ImGui/RetainedView.h"
+#include "UI/PanelRegistry.h"
+
 namespace tg
 {
     enum class PanelFlags
@@ -12,6 +20,10 @@ namespace tg
         CanDetach = 1 << 1,
         NoScrollbar = 1 << 2,
         MenuBar = 1 << 3,
+        // Tab content is cached offscreen and redrawn only when invalidated. OnRender()
+        // is skipped while cached, so anything that must run every frame (own windows,
+        // popups) belongs in OnRenderOverlays().
+        Retained = 1 << 4,
     };
 
     inline PanelFlags operator|(PanelFlags a, PanelFlags b)
@@ -36,11 +48,26 @@ namespace tg
         virtual ~Panel() = default;
 
         virtual void OnRender() = 0;
+        virtual void OnRenderOverlays() {}
         virtual void OnAttach() {}
         virtual void OnDetach() {}
         
         virtual void OnFocus() {}
         virtual void OnLostFocus() {}
+        
+        // Every frame while visible; at TabManager's background rate otherwise, with the
+        // time since the previous call. Not called while hibernated.
+        virtual void OnUpdate(TimeStep ts) {}
+        
+        // What the panel needs to rebuild itself, for the session file and hibernation.
+        // OnRestore() gets the same bytes back, possibly in a later run.
+        virtual void OnSaveState(BinaryWriter& writer) const {}
+        virtual void OnRestore(BinaryReader& reader) {}
+        
+        // Hibernation: after a long time in the background the state is saved and the panel
+        // releases everything heavy; it is restored before the panel is shown again.
+        virtual bool CanHibernate() const { return false; }
+        virtual void OnHibernate() {}
 
         void SetFlags(PanelFlags flags) { mFlags = flags; }
         PanelFlags GetFlags() const { return mFlags; }
@@ -49,6 +76,14 @@ namespace tg
         const std::string& GetIcon() const { return mIcon; }
         const std::string& GetUniqueID() const { return mUniqueID; }
         
+        // PanelFactory type this panel was created from; empty for panels built directly.
+        const std::string& GetTypeId() const { return mTypeId; }
+        void SetTypeId(const std::string& typeId) { mTypeId = typeId; }
+        
+        // Set by the registry while the panel is registered, invalid otherwise.
+        PanelHandle GetHandle() const { return mHandle; }
+        void SetHandle(PanelHandle handle) { mHandle = handle; }
+        
         bool IsOpen() const { return mIsOpen; }
         void SetOpen(bool open) { mIsOpen = open; }
         
@@ -58,6 +93,17 @@ namespace tg
         bool IsDetached() const { return mIsDetached; }
         void SetDetached(bool detached) { mIsDetached = detached; }
         
+        bool IsHibernated() const { return mIsHibernated; }
+        void Hibernate();
+        void Restore();
+        
+        // Model changed: drop the retained image so the next frame renders live.
+        void Invalidate() { mContentDirty = true; }
+        bool ConsumeInvalidation() { return std::exchange(mContentDirty, false); }
+        // State written by OnSaveState() changed; the session is saved shortly after.
+        void RequestSave() { mSaveRequested = true; }
+        RetainedView& GetRetainedView() { return mRetainedView; }
+
         void SetDetachedWindowSize(const ImVec2& size) { mDetachedWindowSize = size; }
         const ImVec2& GetDetachedWindowSize() const { return mDetachedWindowSize; }
         
@@ -65,16 +111,30 @@ namespace tg
         std::string mName;
         std::string mIcon;
         std::string mUniqueID;
+        std::string mTypeId;
         uint32_t mID;
+        PanelHandle mHandle;
         
         bool mIsOpen = true;
         bool mIsFocused = false;
         bool mIsDetached = false;
+        bool mContentDirty = false;
         
         PanelFlags mFlags = PanelFlags::CanClose | PanelFlags::CanDetach;
         ImVec2 mDetachedWindowSize = ImVec2(400, 600);
         
     private:
+        friend class TabManager;
+        
+        RetainedView mRetainedView;
+        
+        // Lifecycle state driven by TabManager
+        float mIdleSeconds = 0.0f;
+        float mPendingUpdateSeconds = 0.0f;
+        bool mIsHibernated = false;
+        bool mSaveRequested = false;
+        std::vector<uint8_t> mHibernatedState;
+        
         static uint32_t sNextID;
         
     };
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tg
+{
+    class Panel;
+
+    struct PanelType
+    {
+        std::string typeId;      // stable, used in saved layouts
+        std::string displayName; // menus and the default tab name
+        std::string icon;
+        std::function<std::shared_ptr<Panel>(const std::string& name)> create;
+    };
+
+    // Panel types the application knows how to build. TabManager opens tabs by type ID and
+    // only calls create() once a tab is first shown, so hidden tabs cost a name and an icon.
+    class PanelFactory
+    {
+    public:
+        static PanelFactory& Get();
+
+        // Replaces an existing type with the same ID.
+        void Register(PanelType type);
+
+        template<typename T>
+        void Register(std::string typeId, std::string displayName, std::string icon = "")
+        {
+            Register({std::move(typeId), std::move(displayName), std::move(icon),
+                      [](const std::string& name) { return std::make_shared<T>(name); }});
+        }
+
+        [[nodiscard]] const PanelType* Find(std::string_view typeId) const;
+        [[nodiscard]] const std::vector<PanelType>& GetTypes() const { return mTypes; }
+
+        // Null for unknown types.
+        [[nodiscard]] std::shared_ptr<Panel> Create(std::string_view typeId, const std::string& name) const;
+
+    private:
+        std::vector<PanelType> mTypes;
+    };
+}
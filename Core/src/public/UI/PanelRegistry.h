@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tg
+{
+    class Panel;
+
+    // Index into the registry's slot array plus the slot's generation at insertion time.
+    // A handle to a removed panel stays invalid even after its slot is reused.
+    struct PanelHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        [[nodiscard]] bool IsValid() const { return index != UINT32_MAX; }
+        bool operator==(const PanelHandle&) const = default;
+    };
+
+    // Owns the open panels. Lookup by handle is an array access, lookup by name one hash
+    // probe; tab order is a separate vector of handles, so reordering never touches the slots.
+    class PanelRegistry
+    {
+    public:
+        // Invalid handle if a panel with the same name is already registered.
+        PanelHandle Add(std::shared_ptr<Panel> panel);
+        bool Remove(PanelHandle handle);
+        // Swaps in a different panel object under the same handle and tab position.
+        bool Replace(PanelHandle handle, std::shared_ptr<Panel> panel);
+        void Clear();
+
+        [[nodiscard]] Panel* Get(PanelHandle handle) const;
+        [[nodiscard]] std::shared_ptr<Panel> GetShared(PanelHandle handle) const;
+        [[nodiscard]] PanelHandle Find(std::string_view name) const;
+
+        // Tab display order.
+        [[nodiscard]] const std::vector<PanelHandle>& GetOrder() const { return mOrder; }
+        [[nodiscard]] size_t GetOrderIndex(PanelHandle handle) const;
+        void Swap(PanelHandle a, PanelHandle b);
+
+        [[nodiscard]] size_t Size() const { return mOrder.size(); }
+        [[nodiscard]] bool Empty() const { return mOrder.empty(); }
+
+    private:
+        struct Slot
+        {
+            std::shared_ptr<Panel> panel;
+            uint32_t generation = 1;
+            uint32_t orderIndex = 0;
+        };
+
+        struct NameHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+        };
+
+        [[nodiscard]] const Slot* Resolve(PanelHandle handle) const;
+
+    private:
+        std::vector<Slot> mSlots;
+        std::vector<uint32_t> mFreeSlots;
+        std::vector<PanelHandle> mOrder;
+        std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> mByName;
+    };
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tg
+{
+    struct SessionConfig
+    {
+        std::string path = "session.tgs";
+        bool enabled = true;
+        // Quiet time after the last change before the session is written.
+        float saveDelaySeconds = 1.0f;
+
+        // Overridable with --session <path> and --no-session.
+        static SessionConfig FromCommandLine();
+    };
+
+    // Writes session snapshots on a background thread, atomically (temp file + rename).
+    // Only the newest snapshot matters: one posted while an older one is still waiting
+    // replaces it.
+    class SessionWriter
+    {
+    public:
+        SessionWriter() = default;
+        ~SessionWriter();
+
+        SessionWriter(const SessionWriter&) = delete;
+        SessionWriter& operator=(const SessionWriter&) = delete;
+
+        void Start(const std::string& path);
+        void Post(std::vector<uint8_t> snapshot);
+        // Writes a snapshot that is still pending, then joins the thread.
+        void Stop();
+
+        static bool WriteFile(const std::string& path, const std::vector<uint8_t>& bytes);
+
+    private:
+        void WorkerMain();
+
+    private:
+        std::string mPath;
+        std::vector<uint8_t> mPending;
+        bool mHasPending = false;
+        bool mStopRequested = false;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::thread mThread;
+    };
+}
@@ -1,11 +1,28 @@
 ﻿#pragma once
 #include "Panel.h"
+#include "PanelRegistry.h"
+#include "SessionWriter.h"
+#include <cstdint>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <algorithm>
 
 namespace tg
 {
+    struct PanelType;
+
+    struct TabLifecycleConfig
+    {
+        // OnUpdate() rate for panels that are not visible; <= 0 stops background updates.
+        float backgroundUpdateHz = 2.0f;
+        // Background time after which panels that support it hibernate; <= 0 disables it.
+        float hibernateAfterSeconds = 300.0f;
+
+        // Overridable with --background-update-hz <hz> and --hibernate-after <seconds>.
+        static TabLifecycleConfig FromCommandLine();
+    };
+
     class TabManager
     {
     public:
@@ -17,13 +34,37 @@ namespace tg
         
         void Init();
         void Shutdown();
+        // From the layer's OnUpdate: ticks visible panels every frame and the rest at the background rate.
+        void Update(TimeStep ts);
         void Render();
         
+        void SetLifecycleConfig(const TabLifecycleConfig& config) { mLifecycle = config; }
+        const TabLifecycleConfig& GetLifecycleConfig() const { return mLifecycle; }
+        
+        // Session file: tab order, active tab, detached state and size, and each panel's
+        // OnSaveState() bytes. Load after the panel types are registered and before the
+        // first frame; only the active tab is constructed. Changes are saved by Update()
+        // once they settle, and on Shutdown().
+        bool LoadSession();
+        // Reads the session file into memory for the next LoadSession(). Any thread, before
+        // Init(); startup runs it on a worker so the file read overlaps window creation.
+        void PrefetchSession();
+        void SaveSession();
+        void MarkSessionDirty() { mSessionDirty = true; mSecondsSinceChange = 0.0f; }
+        
         void AddPanel(std::shared_ptr<Panel> panel);
+        // Opens a tab of a PanelFactory type. The panel is only constructed when the tab is
+        // first shown; state (e.g. from a saved layout) then goes to its OnRestore().
+        // An empty name picks the type's display name, numbered if already taken.
+        PanelHandle OpenPanel(std::string_view typeId, const std::string& name = "", std::vector<uint8_t> state = {});
         void RemovePanel(const std::string& panelName);
         void RemovePanel(Panel* panel);
+        void RemovePanel(PanelHandle handle);
         
         std::shared_ptr<Panel> GetPanel(const std::string& panelName);
+        std::shared_ptr<Panel> GetPanel(PanelHandle handle) const { return mRegistry.GetShared(handle); }
+        PanelHandle FindPanel(std::string_view panelName) const { return mRegistry.Find(panelName); }
+        const PanelRegistry& GetRegistry() const { return mRegistry; }
         void SetActivePanel(const std::string& panelName);
         void SetActivePanel(Panel* panel);
         
@@ -38,11 +79,30 @@ namespace tg
         void RenderDetachedWindows();
         void RenderTabContent();
         void HandleTabDragDrop();
+        void FlushPendingCloses();
+        bool IsVisible(const Panel* panel) const;
+        // Builds the real panel behind a tab opened with OpenPanel(); returns the panel to use.
+        Panel* Materialize(Panel* panel);
+        PanelHandle AddPendingPanel(const PanelType& type, const std::string& name, std::vector<uint8_t> state);
+        std::vector<uint8_t> SerializeSession() const;
+        std::string MakeUniqueName(const std::string& baseName) const;
+        void RenderAddPanelMenu();
+        void HibernateIdlePanels();
 
     private:
-        std::vector<std::shared_ptr<Panel>> mPanels;
+        PanelRegistry mRegistry;
+        // Closes requested while iterating the tab order, applied after the loop.
+        std::vector<PanelHandle> mPendingCloses;
         Panel* mActivePanel = nullptr;
         Panel* mDraggingTab = nullptr;
+        TabLifecycleConfig mLifecycle;
+        
+        SessionConfig mSessionConfig;
+        SessionWriter mSessionWriter;
+        bool mSessionDirty = false;
+        float mSecondsSinceChange = 0.0f;
+        std::vector<uint8_t> mPrefetchedSession;
+        bool mSessionPrefetched = false;
         
         float mTabBarHeight = 25.0f;
         ImVec4 mActiveTabColor = ImVec4(0.26f, 0.59f, 0.98f, 1.0f);
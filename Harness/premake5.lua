@@ -0,0 +1,58 @@
+project "Harness"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    staticruntime "off"
+
+    targetdir ("%{wks.location}/build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir    ("%{wks.location}/build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+    files {
+        "src/public/**.h",
+        "src/private/**.cpp",
+        "scripts/**.tgin",
+
+        -- The Runtime app without its entry point; Harness has its own main()
+        "%{wks.location}/Runtime/src/public/**.h",
+        "%{wks.location}/Runtime/src/private/RuntimeLayer.cpp",
+        "%{wks.location}/Runtime/src/private/Panels/**.cpp"
+    }
+
+    includedirs {
+        "src/public/",
+        "src/private/",
+        "%{wks.location}/Core/src/public",
+        "%{wks.location}/Runtime/src/public"
+    }
+
+    links { "Core" }
+    dependson { "Core" }
+
+    IncludeDependencies()
+
+    filter "system:windows"
+        systemversion "latest"
+
+        postbuildcommands {
+            '{COPY} "%{wks.location}/Core/tplibs/tdlib/bin/tdjson.dll" "%{cfg.targetdir}"',
+            '{COPY} "%{wks.location}/Core/tplibs/tdlib/bin/libcrypto-3-x64.dll" "%{cfg.targetdir}"',
+            '{COPY} "%{wks.location}/Core/tplibs/tdlib/bin/libssl-3-x64.dll" "%{cfg.targetdir}"',
+            '{COPY} "%{wks.location}/Core/tplibs/tdlib/bin/zlib1.dll" "%{cfg.targetdir}"',
+            '{COPY} "%{wks.location}/Core/tplibs/glfw/lib/glfw3.dll" "%{cfg.targetdir}"'
+        }
+
+    filter "system:linux"
+        links { "glfw", "GL", "pthread", "dl" }
+
+    filter "configurations:Debug"
+        defines { "_DEBUG" }
+        runtime "Debug"
+        symbols "On"
+        ProcessDependencies("Debug")
+
+    filter "configurations:Release"
+        defines { "_RELEASE" }
+        runtime "Release"
+        optimize "Full"
+        symbols "Off"
+        ProcessDependencies("Release")
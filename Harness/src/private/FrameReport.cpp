@@ -0,0 +1,154 @@
+﻿#include "FrameReport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string_view>
+
+namespace tg::harness
+{
+    namespace
+    {
+        // CPU time varies between runs of the same build; the rest is deterministic for a
+        // given script and only drifts when the UI changes.
+        constexpr double kCpuTolerancePercent = 25.0;
+        constexpr double kAllocationTolerancePercent = 10.0;
+        constexpr double kGeometryTolerancePercent = 2.0;
+
+        template<typename T>
+        double Percentile(std::vector<T> values, double p)
+        {
+            std::ranges::sort(values);
+            return static_cast<double>(values[std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size())))]);
+        }
+
+        template<typename T>
+        void AddMeanAndMax(std::vector<FrameMetric>& metrics, const std::string& name, const std::vector<T>& values, double tolerancePercent)
+        {
+            double total = 0.0;
+            for (const T value : values) total += static_cast<double>(value);
+            metrics.push_back({ name + "_mean", total / static_cast<double>(values.size()), tolerancePercent });
+            metrics.push_back({ name + "_max", static_cast<double>(std::ranges::max(values)), tolerancePercent });
+        }
+
+        template<typename T>
+        bool ParseNumber(std::string_view token, T& value)
+        {
+            const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+            return ec == std::errc() && ptr == token.data() + token.size();
+        }
+    }
+
+    std::vector<FrameMetric> Summarize(std::span<const FrameSample> samples, bool allocationsTracked)
+    {
+        std::vector<FrameMetric> metrics;
+        if (samples.empty()) return metrics;
+
+        std::vector<float> cpuMs;
+        std::vector<uint64_t> allocations;
+        std::vector<uint32_t> drawCalls;
+        std::vector<uint32_t> vertices;
+        for (const FrameSample& sample : samples)
+        {
+            cpuMs.push_back(sample.cpuMs);
+            allocations.push_back(sample.allocations);
+            drawCalls.push_back(sample.drawCalls);
+            vertices.push_back(sample.vertices);
+        }
+
+        metrics.push_back({ "frames", static_cast<double>(samples.size()) });
+        metrics.push_back({ "cpu_ms_p50", Percentile(cpuMs, 0.5), kCpuTolerancePercent });
+        metrics.push_back({ "cpu_ms_p95", Percentile(cpuMs, 0.95), kCpuTolerancePercent });
+        metrics.push_back({ "cpu_ms_max", static_cast<double>(std::ranges::max(cpuMs)) });
+        if (allocationsTracked)
+        {
+            AddMeanAndMax(metrics, "allocations", allocations, kAllocationTolerancePercent);
+        }
+        AddMeanAndMax(metrics, "draw_calls", drawCalls, kGeometryTolerancePercent);
+        AddMeanAndMax(metrics, "vertices", vertices, kGeometryTolerancePercent);
+        return metrics;
+    }
+
+    bool WriteFrameCsv(const std::string& path, std::span<const FrameSample> samples)
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+
+        out << "frame,cpu_ms,allocations,draw_calls,vertices\n";
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const FrameSample& sample = samples[i];
+            out << i << ',' << sample.cpuMs << ',' << sample.allocations << ',' << sample.drawCalls << ',' << sample.vertices << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool Baseline::Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        mEntries.clear();
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::string_view view(line);
+            if (!view.empty() && view.back() == '\r') view.remove_suffix(1);
+            if (view.empty() || view.front() == '#') continue;
+
+            // <name> <value> <tolerance>[%]
+            const size_t nameEnd = view.find(' ');
+            const size_t valueEnd = nameEnd == std::string_view::npos ? nameEnd : view.find(' ', nameEnd + 1);
+            if (valueEnd == std::string_view::npos) return false;
+
+            Entry entry;
+            entry.name = view.substr(0, nameEnd);
+            std::string_view tolerance = view.substr(valueEnd + 1);
+            entry.relative = tolerance.ends_with('%');
+            if (entry.relative) tolerance.remove_suffix(1);
+            if (!ParseNumber(view.substr(nameEnd + 1, valueEnd - nameEnd - 1), entry.value) ||
+                !ParseNumber(tolerance, entry.tolerance))
+            {
+                return false;
+            }
+            mEntries.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    bool Baseline::Save(const std::string& path, const std::vector<FrameMetric>& metrics)
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+
+        out << "# <metric> <value> <tolerance, absolute or with %>; a metric fails above value + tolerance\n";
+        for (const FrameMetric& metric : metrics)
+        {
+            if (metric.defaultTolerancePercent < 0.0) continue;
+            out << metric.name << ' ' << metric.value << ' ' << metric.defaultTolerancePercent << "%\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool Baseline::Compare(const std::vector<FrameMetric>& metrics, std::FILE* out) const
+    {
+        bool passed = true;
+        std::fprintf(out, "%-18s %14s %14s %14s  %s\n", "Metric", "Baseline", "Limit", "Current", "Result");
+        for (const Entry& entry : mEntries)
+        {
+            const auto metric = std::ranges::find(metrics, entry.name, &FrameMetric::name);
+            const double limit = entry.relative ? entry.value * (1.0 + entry.tolerance / 100.0) : entry.value + entry.tolerance;
+            if (metric == metrics.end())
+            {
+                std::fprintf(out, "%-18s %14.3f %14.3f %14s  skipped\n", entry.name.c_str(), entry.value, limit, "-");
+                continue;
+            }
+
+            const bool regressed = metric->value > limit;
+            passed &= !regressed;
+            std::fprintf(out, "%-18s %14.3f %14.3f %14.3f  %s\n", entry.name.c_str(), entry.value, limit, metric->value,
+                         regressed ? "REGRESSED" : "ok");
+        }
+        return passed;
+    }
+}
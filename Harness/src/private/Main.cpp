@@ -0,0 +1,285 @@
+﻿#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Base/App.h"
+#include "Base/Log.h"
+#include "Debug/InputScript.h"
+#include "Debug/Profiler.h"
+#include "FrameReport.h"
+#include "Jobs/JobSystem.h"
+#include "Memory/AllocationTracker.h"
+#include "Panels/TGPanel.h"
+#include "RuntimeLayer.h"
+#include "SelfChecks.h"
+#include "UI/TabManager.h"
+
+// Runs the Runtime app headless through an input script on a fixed 60 Hz clock and reports
+// per-frame CPU time, allocations, draw calls and vertices. With --baseline the summary is
+// checked against a stored run and the exit code is 1 on a regression, for CI.
+//   Harness --script <path> [--frames <n>] [--warmup <n>] [--baseline <path>]
+//           [--write-baseline <path>] [--csv <path>] [app flags...]
+//   Harness --self-check          Core checks only, without the app; exit code 1 on a failure
+//
+// Besides input, scripts drive the app through commands:
+//   open <type> [name]            activate <panel>        close <panel>
+//   detach <panel>                attach <panel>
+//   account <panel> <phone> [synthetic chats]
+//   chat <panel> <phone> <chat index>
+//   search <panel> [text]
+namespace
+{
+    constexpr uint64_t kDefaultWarmupFrames = 60;
+    // Frames run after the script's last event so its effects are measured too.
+    constexpr uint64_t kSettleFrames = 120;
+
+    struct Options
+    {
+        const char* scriptPath = nullptr;
+        uint64_t frames = 0;
+        uint64_t warmupFrames = kDefaultWarmupFrames;
+        const char* baselinePath = nullptr;
+        const char* writeBaselinePath = nullptr;
+        const char* csvPath = nullptr;
+        bool selfCheck = false;
+    };
+
+    template<typename T>
+    bool ParseNumber(std::string_view text, T& value)
+    {
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && ptr == text.data() + text.size();
+    }
+
+    // Unknown arguments are left for the app (--render-thread, --log-level...).
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (arg == "--self-check")
+            {
+                options.selfCheck = true;
+                continue;
+            }
+
+            const bool known = arg == "--script" || arg == "--frames" || arg == "--warmup" || arg == "--baseline" ||
+                               arg == "--write-baseline" || arg == "--csv";
+            if (!known) continue;
+
+            const char* value = i + 1 < argc ? argv[++i] : nullptr;
+            bool valid = true;
+            if (!value) valid = false;
+            else if (arg == "--script") options.scriptPath = value;
+            else if (arg == "--baseline") options.baselinePath = value;
+            else if (arg == "--write-baseline") options.writeBaselinePath = value;
+            else if (arg == "--csv") options.csvPath = value;
+            else if (arg == "--frames") valid = ParseNumber(std::string_view(value), options.frames) && options.frames > 0;
+            else valid = ParseNumber(std::string_view(value), options.warmupFrames);
+
+            if (!valid)
+            {
+                std::fprintf(stderr, "Bad argument '%s'\n", arg.data());
+                return false;
+            }
+        }
+        if (!options.scriptPath && !options.selfCheck)
+        {
+            std::fprintf(stderr, "Missing --script <path>\n");
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view NextToken(std::string_view& line)
+    {
+        const size_t start = line.find_first_not_of(' ');
+        if (start == std::string_view::npos)
+        {
+            line = {};
+            return {};
+        }
+        line.remove_prefix(start);
+        const size_t end = std::min(line.find(' '), line.size());
+        const std::string_view token = line.substr(0, end);
+        line.remove_prefix(end);
+        return token;
+    }
+
+    tg::TGPanel* FindTelegramPanel(std::string_view name)
+    {
+        // Tabs that were never shown are still placeholders; activate them a frame earlier.
+        auto* panel = dynamic_cast<tg::TGPanel*>(tg::TabManager::Get().GetPanel(std::string(name)).get());
+        if (!panel)
+        {
+            TG(LayerLog, Warn, "Harness: no constructed Telegram panel named '{}'", name)
+        }
+        return panel;
+    }
+
+    void RunCommand(std::string_view command)
+    {
+        tg::TabManager& tabs = tg::TabManager::Get();
+        std::string_view rest = command;
+        const std::string_view verb = NextToken(rest);
+        const std::string name(NextToken(rest));
+        tg::Panel* panel = tabs.GetPanel(name).get();
+
+        if (verb == "open")
+        {
+            tabs.OpenPanel(name, std::string(NextToken(rest)));
+        }
+        else if (verb == "activate" && panel)
+        {
+            tabs.SetActivePanel(panel);
+        }
+        else if (verb == "close" && panel)
+        {
+            tabs.RemovePanel(panel);
+        }
+        else if (verb == "detach" && panel)
+        {
+            tabs.DetachPanel(panel);
+        }
+        else if (verb == "attach" && panel)
+        {
+            tabs.AttachPanel(panel);
+        }
+        else if (verb == "account" || verb == "chat")
+        {
+            tg::TGPanel* telegram = FindTelegramPanel(name);
+            const std::string phone(NextToken(rest));
+            size_t number = 0;
+            if (!telegram || phone.empty() || (!rest.empty() && !ParseNumber(NextToken(rest), number)))
+            {
+                TG(LayerLog, Warn, "Harness: bad command '{}'", command)
+                return;
+            }
+
+            tg::TelegramAccount* account = telegram->AddAccount(phone);
+            if (verb == "account")
+            {
+                account->AddSyntheticChats(number);
+            }
+            else if (number < account->GetChats().size())
+            {
+                telegram->OpenChatWindow(phone, account->GetChats()[number]);
+            }
+        }
+        else if (verb == "search")
+        {
+            if (tg::TGPanel* telegram = FindTelegramPanel(name))
+            {
+                const size_t start = rest.find_first_not_of(' ');
+                telegram->SetSearchText(start == std::string_view::npos ? std::string_view() : rest.substr(start));
+            }
+        }
+        else
+        {
+            TG(LayerLog, Warn, "Harness: unknown command or panel in '{}'", command)
+        }
+    }
+
+    class HarnessApp : public tg::App
+    {
+    public:
+        void OnInit() override
+        {
+            PushLayer(new RuntimeLayer());
+            SetInputCommandHandler(RunCommand);
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (options.selfCheck) return tg::harness::RunSelfChecks(stdout) ? 0 : 1;
+
+    tg::App::SetCommandLineArgs({ argc, argv });
+    tg::Log::Init(tg::LogConfig::FromCommandLine());
+
+    if (options.frames == 0)
+    {
+        tg::InputScript script;
+        if (!script.Load(options.scriptPath))
+        {
+            tg::Log::Shutdown();
+            return 2;
+        }
+        options.frames = script.GetLastFrame() + 1 + kSettleFrames;
+    }
+    if (options.warmupFrames >= options.frames)
+    {
+        std::fprintf(stderr, "--warmup must be below the frame count (%llu)\n", static_cast<unsigned long long>(options.frames));
+        tg::Log::Shutdown();
+        return 2;
+    }
+
+    // The app reads its own flags; it takes the first occurrence, so the caller's win.
+    const std::string frames = std::to_string(options.frames);
+    std::vector<char*> appArgs(argv, argv + argc);
+    const char* forced[] = { "--headless", "--no-session", "--replay-input", options.scriptPath, "--frames", frames.c_str() };
+    for (const char* arg : forced) appArgs.push_back(const_cast<char*>(arg));
+    tg::App::SetCommandLineArgs({ static_cast<int>(appArgs.size()), appArgs.data() });
+
+    tg::Profiler::Init();
+    tg::JobSystem::Get().Init();
+
+    std::vector<tg::FrameSample> samples;
+    {
+        HarnessApp app;
+        app.Run();
+        samples = app.GetFrameSamples();
+    }
+
+    tg::JobSystem::Get().Shutdown();
+    tg::Profiler::Shutdown();
+    tg::Log::Shutdown();
+
+    if (samples.size() <= options.warmupFrames)
+    {
+        std::fprintf(stderr, "The app ran %zu frames, not enough to measure past the warm-up\n", samples.size());
+        return 2;
+    }
+    if (options.csvPath && !tg::harness::WriteFrameCsv(options.csvPath, samples))
+    {
+        std::fprintf(stderr, "Could not write '%s'\n", options.csvPath);
+        return 2;
+    }
+
+    const std::span<const tg::FrameSample> measured = std::span(samples).subspan(options.warmupFrames);
+    const std::vector<tg::harness::FrameMetric> metrics = tg::harness::Summarize(measured, tg::AllocationTracker::IsEnabled());
+    for (const tg::harness::FrameMetric& metric : metrics)
+    {
+        std::printf("%-18s %14.3f\n", metric.name.c_str(), metric.value);
+    }
+
+    if (options.writeBaselinePath)
+    {
+        if (!tg::harness::Baseline::Save(options.writeBaselinePath, metrics))
+        {
+            std::fprintf(stderr, "Could not write '%s'\n", options.writeBaselinePath);
+            return 2;
+        }
+        std::printf("Wrote baseline '%s'\n", options.writeBaselinePath);
+    }
+
+    if (options.baselinePath)
+    {
+        tg::harness::Baseline baseline;
+        if (!baseline.Load(options.baselinePath))
+        {
+            std::fprintf(stderr, "Could not read baseline '%s'\n", options.baselinePath);
+            return 2;
+        }
+        std::printf("\n");
+        if (!baseline.Compare(metrics, stdout)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+﻿#include "SelfChecks.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include "Base/TimerService.h"
+#include "Debug/Profiler.h"
+
+namespace tg::harness
+{
+    namespace
+    {
+        using namespace std::chrono_literals;
+
+        // A 1 ms repeating timer across a 10 s sleep fires once, then keeps its period.
+        bool RepeatingTimerSkipsMissedIntervals()
+        {
+            TimerService timers;
+            uint32_t fired = 0;
+            timers.ScheduleRepeating(1ms, [&fired] { ++fired; });
+
+            const uint64_t startNs = Profiler::NowNs();
+            const uint64_t wakeNs = startNs + std::chrono::nanoseconds(10s).count();
+            if (timers.Advance(wakeNs) != 1 || fired != 1) return false;
+            if (timers.Advance(wakeNs) != 0) return false;
+            return timers.Advance(wakeNs + 2 * TimerService::kTickNs) == 1 && fired == 2;
+        }
+
+        struct Check
+        {
+            const char* name;
+            bool (*run)();
+        };
+
+        constexpr Check kChecks[] = {
+            { "timers/repeating_skips_missed", &RepeatingTimerSkipsMissedIntervals },
+        };
+    }
+
+    bool RunSelfChecks(std::FILE* out)
+    {
+        bool passed = true;
+        for (const Check& check : kChecks)
+        {
+            const bool ok = check.run();
+            passed &= ok;
+            std::fprintf(out, "%-36s %s\n", check.name, ok ? "ok" : "FAILED");
+        }
+        return passed;
+    }
+}
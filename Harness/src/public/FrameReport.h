@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Base/App.h"
+
+namespace tg::harness
+{
+    struct FrameMetric
+    {
+        std::string name;
+        double value = 0.0;
+        // Written into new baselines; negative means the metric is only reported.
+        double defaultTolerancePercent = -1.0;
+    };
+
+    // Per-run figures over the frames after the warm-up: CPU time percentiles, and the
+    // mean and peak of allocations (tracked builds only), draw calls and vertices.
+    std::vector<FrameMetric> Summarize(std::span<const FrameSample> samples, bool allocationsTracked);
+
+    // frame,cpu_ms,allocations,draw_calls,vertices; one row per frame, warm-up included.
+    bool WriteFrameCsv(const std::string& path, std::span<const FrameSample> samples);
+
+    // Stored results of a known-good run, one "<metric> <value> <tolerance>" line each, where
+    // the tolerance is relative ("25%") or absolute ("3"). A metric regresses when the new
+    // value is above value + tolerance; metrics missing from either side are skipped.
+    class Baseline
+    {
+    public:
+        bool Load(const std::string& path);
+        static bool Save(const std::string& path, const std::vector<FrameMetric>& metrics);
+
+        // Prints one row per baseline metric; false if any regressed.
+        bool Compare(const std::vector<FrameMetric>& metrics, std::FILE* out) const;
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            double value = 0.0;
+            double tolerance = 0.0;
+            bool relative = false;
+        };
+
+        std::vector<Entry> mEntries;
+    };
+}
@@ -0,0 +1,9 @@
+﻿#pragma once
+#include <cstdio>
+
+namespace tg::harness
+{
+    // Deterministic checks of Core behavior the frame metrics cannot see (timer catch-up
+    // after a long sleep). Prints one row per check; false if any failed.
+    bool RunSelfChecks(std::FILE* out);
+}
@@ -0,0 +1,293 @@
+﻿#include "Panels/AccountRegistry.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "Base/App.h"
+#include "Base/Log.h"
+#include "Debug/Profiler.h"
+#include "Memory/FixedString.h"
+#include "Panels/TGModel.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace tg
+{
+    namespace
+    {
+        constexpr std::string_view kStoreExtension = ".tgac";
+
+        // Store directories already prepared by this run.
+        std::vector<std::string> sPreparedStores;
+
+        uint32_t GetProcessID()
+        {
+#ifdef _WIN32
+            return static_cast<uint32_t>(_getpid());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        // Each running instance offloads into its own subdirectory, so clearing it never
+        // touches the tables of another instance sharing the store.
+        std::string GetRunStoreDir(const std::string& storeDir)
+        {
+            FixedString<32> name;
+            name.AppendFormat("run-{}", GetProcessID());
+            return (std::filesystem::path(storeDir) / name.CStr()).string();
+        }
+
+        // Creates this run's directory, and empties it the first time: nothing has been
+        // offloaded yet, so any table already there was left by a run that crashed and
+        // had the same process ID.
+        void PrepareStore(const std::string& dir)
+        {
+            if (std::ranges::find(sPreparedStores, dir) != sPreparedStores.end()) return;
+            sPreparedStores.push_back(dir);
+
+            std::error_code error;
+            std::filesystem::create_directories(dir, error);
+            size_t removed = 0;
+            for (const auto& entry : std::filesystem::directory_iterator(dir, error))
+            {
+                if (entry.path().extension() == kStoreExtension && std::filesystem::remove(entry.path(), error))
+                {
+                    ++removed;
+                }
+            }
+            if (removed > 0)
+            {
+                TG(LayerLog, Info, "Removed {} stale account tables from {}", removed, dir)
+            }
+        }
+    }
+
+    AccountResidencyConfig AccountResidencyConfig::FromCommandLine()
+    {
+        AccountResidencyConfig config;
+        const CommandLineArgs& args = App::GetCommandLineArgs();
+        if (const char* text = args.GetValue("--offload-accounts-after"))
+        {
+            const char* end = text + std::strlen(text);
+            float seconds = 0.0f;
+            const auto [ptr, ec] = std::from_chars(text, end, seconds);
+            if (ec == std::errc() && ptr == end)
+            {
+                config.offloadAfterSeconds = seconds;
+            }
+            else
+            {
+                TG(LayerLog, Warn, "Ignoring --offload-accounts-after '{}': expected seconds, keeping {}",
+                   text, config.offloadAfterSeconds)
+            }
+        }
+        if (const char* dir = args.GetValue("--account-store"))
+        {
+            config.storeDir = dir;
+        }
+        return config;
+    }
+
+    AccountId AccountRegistry::Add(std::unique_ptr<TelegramAccount> account)
+    {
+        if (!account || mByPhone.contains(account->GetPhoneNumber())) return {};
+
+        uint32_t index;
+        if (!mFreeSlots.empty())
+        {
+            index = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(mSlots.size());
+            mSlots.emplace_back();
+        }
+
+        Slot& slot = mSlots[index];
+        const AccountId id{index, slot.generation};
+        slot.orderIndex = static_cast<uint32_t>(mOrder.size());
+        slot.lastUsedNs = Profiler::NowNs();
+        mOrder.push_back(id);
+        mByPhone.emplace(account->GetPhoneNumber(), index);
+        slot.account = std::move(account);
+        return id;
+    }
+
+    bool AccountRegistry::Remove(AccountId id)
+    {
+        if (!Resolve(id)) return false;
+
+        Slot& slot = mSlots[id.index];
+        mByPhone.erase(slot.account->GetPhoneNumber());
+
+        mOrder.erase(mOrder.begin() + slot.orderIndex);
+        for (size_t i = slot.orderIndex; i < mOrder.size(); ++i)
+        {
+            mSlots[mOrder[i].index].orderIndex = static_cast<uint32_t>(i);
+        }
+
+        slot.account.reset();
+        ++slot.generation;
+        mFreeSlots.push_back(id.index);
+        return true;
+    }
+
+    void AccountRegistry::Clear()
+    {
+        std::vector<Slot>().swap(mSlots);
+        std::vector<uint32_t>().swap(mFreeSlots);
+        std::vector<AccountId>().swap(mOrder);
+        decltype(mByPhone)().swap(mByPhone);
+    }
+
+    TelegramAccount* AccountRegistry::Get(AccountId id) const
+    {
+        const Slot* slot = Resolve(id);
+        return slot ? slot->account.get() : nullptr;
+    }
+
+    void AccountRegistry::SetResidency(const AccountResidencyConfig& config, std::string_view ownerName)
+    {
+        mResidency = config;
+        mStoreDir = GetRunStoreDir(config.storeDir);
+        mStoreCreated = false;
+
+        // Only characters that are safe in a file name on every platform.
+        mOwnerName.clear();
+        for (const char c : ownerName)
+        {
+            const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+            mOwnerName += safe ? c : '_';
+        }
+    }
+
+    TelegramAccount* AccountRegistry::Use(AccountId id)
+    {
+        if (!Resolve(id)) return nullptr;
+
+        Slot& slot = mSlots[id.index];
+        slot.lastUsedNs = Profiler::NowNs();
+        TelegramAccount& account = *slot.account;
+        if (!account.IsResident())
+        {
+            const uint64_t startNs = slot.lastUsedNs;
+            account.Rehydrate();
+            const double ms = static_cast<double>(Profiler::NowNs() - startNs) / 1e6;
+            TG(LayerLog, Info, "Rehydrated account {} ({} chats) in {:.2f} ms", account.GetPhoneNumber(), account.GetChatCount(), ms)
+            PublishResidentCount();
+        }
+        return &account;
+    }
+
+    AccountId AccountRegistry::Find(std::string_view phoneNumber) const
+    {
+        auto it = mByPhone.find(phoneNumber);
+        if (it == mByPhone.end()) return {};
+
+        return {it->second, mSlots[it->second].generation};
+    }
+
+    size_t AccountRegistry::GetOrderIndex(AccountId id) const
+    {
+        const Slot* slot = Resolve(id);
+        return slot ? slot->orderIndex : mOrder.size();
+    }
+
+    int AccountRegistry::GetTotalUnread() const
+    {
+        int total = 0;
+        for (const AccountId id : mOrder)
+        {
+            total += mSlots[id.index].account->GetUnreadCount();
+        }
+        return total;
+    }
+
+    size_t AccountRegistry::Filter(std::string_view lowerQuery, std::span<AccountId> out) const
+    {
+        size_t count = 0;
+        for (const AccountId id : mOrder)
+        {
+            const TelegramAccount& account = *mSlots[id.index].account;
+            if (ContainsIgnoreCase(account.GetPhoneNumber(), lowerQuery) || ContainsIgnoreCase(account.GetDisplayName(), lowerQuery))
+            {
+                out[count++] = id;
+            }
+        }
+        return count;
+    }
+
+    bool AccountRegistry::OffloadIdle(AccountId keep)
+    {
+        if (mResidency.offloadAfterSeconds <= 0.0f) return false;
+
+        const uint64_t nowNs = Profiler::NowNs();
+        const uint64_t limitNs = static_cast<uint64_t>(static_cast<double>(mResidency.offloadAfterSeconds) * 1e9);
+        Slot* oldest = nullptr;
+        for (const AccountId id : mOrder)
+        {
+            Slot& slot = mSlots[id.index];
+            if (id == keep || !slot.account->IsResident() || nowNs - slot.lastUsedNs < limitNs) continue;
+            if (!oldest || slot.lastUsedNs < oldest->lastUsedNs) oldest = &slot;
+        }
+        if (!oldest) return false;
+
+        if (!mStoreCreated)
+        {
+            PrepareStore(mStoreDir);
+            mStoreCreated = true;
+        }
+
+        TelegramAccount& account = *oldest->account;
+        if (!account.Offload(GetStorePath(account), mResidency.summaryChats))
+        {
+            // Not again until it has been idle for another full period.
+            oldest->lastUsedNs = nowNs;
+            return false;
+        }
+        TG(LayerLog, Info, "Offloaded idle account {} ({} chats)", account.GetPhoneNumber(), account.GetChatCount())
+        PublishResidentCount();
+        return true;
+    }
+
+    size_t AccountRegistry::GetResidentCount() const
+    {
+        size_t count = 0;
+        for (const AccountId id : mOrder)
+        {
+            count += mSlots[id.index].account->IsResident() ? 1 : 0;
+        }
+        return count;
+    }
+
+    const AccountRegistry::Slot* AccountRegistry::Resolve(AccountId id) const
+    {
+        if (id.index >= mSlots.size()) return nullptr;
+
+        const Slot& slot = mSlots[id.index];
+        return (slot.generation == id.generation && slot.account) ? &slot : nullptr;
+    }
+
+    std::string AccountRegistry::GetStorePath(const TelegramAccount& account) const
+    {
+        FixedString<32> hash;
+        hash.AppendFormat("-{:016x}", std::hash<std::string>{}(account.GetPhoneNumber()));
+        std::string name = mOwnerName + hash.CStr();
+        name += kStoreExtension;
+        return (std::filesystem::path(mStoreDir) / name).string();
+    }
+
+    void AccountRegistry::PublishResidentCount() const
+    {
+        Profiler::SetCounter("Accounts/Resident", static_cast<double>(GetResidentCount()));
+    }
+}
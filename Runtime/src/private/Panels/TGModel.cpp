@@ -0,0 +1,304 @@
+﻿#include "Panels/TGModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <system_error>
+
+#include "Base/BinaryStream.h"
+#include "Base/Log.h"
+#include "Base/MappedFile.h"
+#include "Debug/Profiler.h"
+#include "Memory/AllocationTracker.h"
+#include "Memory/FixedString.h"
+#include "UI/SessionWriter.h"
+
+namespace tg
+{
+    namespace
+    {
+        constexpr const char* kSyntheticWords[] = {
+            "Alice", "Bob", "Work", "Group", "Family", "Project", "Team", "Gaming", "Book", "Club",
+            "Fitness", "News", "Channel", "Support", "Design", "Sales", "Travel", "Music", "Daily", "Updates"
+        };
+
+        // Initials and a color derived from the title.
+        void FillAvatar(ChatInfo& chat)
+        {
+            std::string avatarText;
+            std::istringstream iss(chat.title);
+            std::string word;
+            while (iss >> word && avatarText.length() < 2)
+            {
+                if (!word.empty())
+                    avatarText += word[0];
+            }
+            chat.avatarText = avatarText;
+
+            float hue = (float)(std::hash<std::string>{}(chat.title) % 360) / 360.0f;
+            float r = std::abs(std::sin(hue * 2.0f * 3.14159f));
+            float g = std::abs(std::sin((hue + 0.33f) * 2.0f * 3.14159f));
+            float b = std::abs(std::sin((hue + 0.67f) * 2.0f * 3.14159f));
+            chat.avatarColor = ImVec4(r * 0.7f + 0.3f, g * 0.7f + 0.3f, b * 0.7f + 0.3f, 1.0f);
+        }
+
+        constexpr uint32_t kChatTableMagic = 0x43414754; // "TGAC"
+        constexpr uint32_t kChatTableVersion = 1;
+
+        void WriteChat(BinaryWriter& writer, const ChatInfo& chat)
+        {
+            writer.Write(chat.chatId);
+            writer.WriteString(chat.title);
+            writer.WriteString(chat.lastMessage);
+            writer.WriteString(chat.lastMessageTime);
+            writer.Write(chat.unreadCount);
+            writer.Write(chat.isPinned);
+            writer.Write(chat.isOnline);
+            writer.Write(chat.avatarColor);
+            writer.WriteString(chat.avatarText);
+        }
+
+        ChatInfo ReadChat(BinaryReader& reader)
+        {
+            ChatInfo chat;
+            chat.chatId = reader.Read<int64_t>();
+            chat.title = reader.ReadString();
+            chat.lastMessage = reader.ReadString();
+            chat.lastMessageTime = reader.ReadString();
+            chat.unreadCount = reader.Read<int>();
+            chat.isPinned = reader.Read<bool>();
+            chat.isOnline = reader.Read<bool>();
+            chat.avatarColor = reader.Read<ImVec4>();
+            chat.avatarText = reader.ReadString();
+            return chat;
+        }
+    }
+
+    ////////////////////////////////////////////////////////
+    ///              TelegramAccount
+    ////////////////////////////////////////////////////////
+    TelegramAccount::TelegramAccount(const std::string& phoneNumber)
+    : mPhoneNumber(phoneNumber)
+    {
+        mDisplayName = "Account " + phoneNumber;
+        AddMockChats(); // For testing
+        mIsAuthorized = true; // Mock authorization
+    }
+
+    TelegramAccount::~TelegramAccount()
+    {
+        if (!IsResident())
+        {
+            std::error_code error;
+            std::filesystem::remove(mOffloadPath, error);
+        }
+    }
+
+    void TelegramAccount::AddMockChats()
+    {
+        if (!IsResident()) Rehydrate();
+        TG_MEMORY_TAG(Chats)
+        // Create mock data for testing
+        std::vector<std::pair<std::string, std::string>> mockChats = {
+            {"John Doe", "Hey, how are you?"},
+            {"Alice Smith", "Can we meet tomorrow?"},
+            {"Work Group", "Meeting at 3 PM"},
+            {"Family", "Don't forget dinner tonight!"},
+            {"Bob Johnson", "Thanks for your help!"},
+            {"Project Team", "New updates available"},
+            {"Sarah Connor", "I'll be back"},
+            {"Gaming Squad", "Ready for tonight's raid?"},
+            {"Book Club", "Next book: 1984"},
+            {"Fitness Group", "Morning workout at 6 AM"}
+        };
+        
+        for (size_t i = 0; i < mockChats.size(); ++i)
+        {
+            ChatInfo chat;
+            chat.chatId = static_cast<int64_t>(i + 1);
+            chat.title = mockChats[i].first;
+            chat.lastMessage = mockChats[i].second;
+            chat.lastMessageTime = (i < 3) ? "12:0" + std::to_string(i) : "Yesterday";
+            chat.unreadCount = (i % 3 == 0) ? (i + 1) : 0;
+            chat.isPinned = (i < 2);
+            chat.isOnline = (i % 2 == 0);
+            FillAvatar(chat);
+            
+            mUnreadCount += chat.unreadCount;
+            mChats.push_back(chat);
+        }
+    }
+
+    void TelegramAccount::AddSyntheticChats(size_t count)
+    {
+        if (!IsResident()) Rehydrate();
+        TG_MEMORY_TAG(Chats)
+        // Same phone, same chats, so runs against the data are comparable.
+        uint64_t state = std::hash<std::string>{}(mPhoneNumber) | 1;
+        const auto next = [&state]
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        mChats.reserve(mChats.size() + count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ChatInfo chat;
+            chat.chatId = static_cast<int64_t>(mChats.size() + 1);
+            chat.title = std::string(kSyntheticWords[next() % std::size(kSyntheticWords)]) + " " +
+                         kSyntheticWords[next() % std::size(kSyntheticWords)] + " " + std::to_string(i);
+            chat.lastMessage = std::string("Message about ") + kSyntheticWords[next() % std::size(kSyntheticWords)];
+            chat.lastMessageTime = "Yesterday";
+            chat.unreadCount = next() % 4 == 0 ? static_cast<int>(next() % 50) : 0;
+            chat.isPinned = next() % 25 == 0;
+            chat.isOnline = next() % 3 == 0;
+            FillAvatar(chat);
+
+            mUnreadCount += chat.unreadCount;
+            mChats.push_back(std::move(chat));
+        }
+    }
+
+    bool TelegramAccount::Offload(const std::string& path, size_t summaryChats)
+    {
+        if (!IsResident()) return true;
+
+        TG_PROFILE_FUNCTION()
+        BinaryWriter writer;
+        writer.Write(kChatTableMagic);
+        writer.Write(kChatTableVersion);
+        writer.Write(static_cast<uint32_t>(mChats.size()));
+        for (const ChatInfo& chat : mChats)
+        {
+            WriteChat(writer, chat);
+        }
+        if (!SessionWriter::WriteFile(path, writer.GetBuffer()))
+        {
+            TG(LayerLog, Warn, "Could not offload account {} to {}; keeping it resident", mPhoneNumber, path)
+            return false;
+        }
+
+        std::vector<const ChatInfo*> order(mChats.size());
+        for (size_t i = 0; i < mChats.size(); ++i) order[i] = &mChats[i];
+        SortChatList(order);
+        {
+            TG_MEMORY_TAG(Chats)
+            mTopChats.clear();
+            for (size_t i = 0; i < std::min(summaryChats, order.size()); ++i)
+            {
+                mTopChats.push_back(*order[i]);
+            }
+        }
+
+        mOffloadedChatCount = mChats.size();
+        std::vector<ChatInfo>().swap(mChats);
+        mOffloadPath = path;
+        return true;
+    }
+
+    bool TelegramAccount::Rehydrate()
+    {
+        if (IsResident()) return true;
+
+        TG_PROFILE_FUNCTION()
+        TG_MEMORY_TAG(Chats)
+        bool loaded = false;
+        {
+            MappedFile file;
+            if (file.Open(mOffloadPath))
+            {
+                BinaryReader reader({file.GetData(), file.GetSize()});
+                if (reader.Read<uint32_t>() == kChatTableMagic && reader.Read<uint32_t>() == kChatTableVersion)
+                {
+                    const uint32_t count = reader.Read<uint32_t>();
+                    mChats.reserve(count);
+                    for (uint32_t i = 0; i < count && reader.IsValid(); ++i)
+                    {
+                        mChats.push_back(ReadChat(reader));
+                    }
+                    loaded = reader.IsValid() && mChats.size() == count;
+                }
+            }
+        }
+
+        if (!loaded)
+        {
+            TG(LayerLog, Error, "Could not read the offloaded chats of {} from {}; only the summary is left",
+               mPhoneNumber, mOffloadPath)
+            mChats = std::move(mTopChats);
+            mUnreadCount = 0;
+            for (const ChatInfo& chat : mChats) mUnreadCount += chat.unreadCount;
+        }
+
+        std::error_code error;
+        std::filesystem::remove(mOffloadPath, error);
+        mOffloadPath.clear();
+        std::vector<ChatInfo>().swap(mTopChats);
+        mOffloadedChatCount = 0;
+        return loaded;
+    }
+
+    ////////////////////////////////////////////////////////
+    ///              Chat list
+    ////////////////////////////////////////////////////////
+    char ToLowerAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    void FoldSearchQuery(std::string_view query, StringBuilder& out)
+    {
+        out.Clear();
+        for (char c : query)
+        {
+            out.Append(ToLowerAscii(c));
+        }
+    }
+
+    bool ContainsIgnoreCase(std::string_view text, std::string_view lowerNeedle)
+    {
+        if (lowerNeedle.size() > text.size()) return false;
+        for (size_t start = 0; start + lowerNeedle.size() <= text.size(); ++start)
+        {
+            size_t i = 0;
+            while (i < lowerNeedle.size() && ToLowerAscii(text[start + i]) == lowerNeedle[i]) ++i;
+            if (i == lowerNeedle.size()) return true;
+        }
+        return false;
+    }
+
+    void SortChatList(std::span<const ChatInfo*> chats)
+    {
+        std::sort(chats.begin(), chats.end(),
+            [](const ChatInfo* a, const ChatInfo* b) {
+                if (a->isPinned != b->isPinned) return a->isPinned > b->isPinned;
+                return a->chatId < b->chatId;
+            });
+    }
+
+    size_t FilterChatList(std::span<const ChatInfo*> chats, std::string_view lowerQuery)
+    {
+        if (lowerQuery.empty()) return chats.size();
+
+        size_t kept = 0;
+        for (const ChatInfo* chat : chats)
+        {
+            if (ContainsIgnoreCase(chat->title, lowerQuery))
+            {
+                chats[kept++] = chat;
+            }
+        }
+        return kept;
+    }
+
+    float MeasureMessageWidth(const Message& message, float maxWidth)
+    {
+        const char* text = message.text.c_str();
+        return std::min(ImGui::CalcTextSize(text, text + message.text.size()).x + 16, maxWidth);
+    }
+}
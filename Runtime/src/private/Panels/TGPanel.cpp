@@ -1,77 +1,17 @@
 ﻿#include "Panels/TGPanel.h"
 
-#include <cmath>
-#include <sstream>
+#include <algorithm>
+#include <cstdio>
 
 #include "Base/Log.h"
+#include "Debug/Profiler.h"
+#include "ImGui/FontLibrary.h"
+#include "Memory/AllocationTracker.h"
+#include "Memory/FixedString.h"
 
 
 namespace tg
 {
-     ////////////////////////////////////////////////////////
-    ///              TelegramAccount
-    ////////////////////////////////////////////////////////
-    TelegramAccount::TelegramAccount(const std::string& phoneNumber)
-    : mPhoneNumber(phoneNumber)
-    {
-        mDisplayName = "Account " + phoneNumber;
-        AddMockChats(); // For testing
-        mIsAuthorized = true; // Mock authorization
-    }
-
-    TelegramAccount::~TelegramAccount()
-    {
-    }
-
-    void TelegramAccount::AddMockChats()
-    {
-        // Create mock data for testing
-        std::vector<std::pair<std::string, std::string>> mockChats = {
-            {"John Doe", "Hey, how are you?"},
-            {"Alice Smith", "Can we meet tomorrow?"},
-            {"Work Group", "Meeting at 3 PM"},
-            {"Family", "Don't forget dinner tonight!"},
-            {"Bob Johnson", "Thanks for your help!"},
-            {"Project Team", "New updates available"},
-            {"Sarah Connor", "I'll be back"},
-            {"Gaming Squad", "Ready for tonight's raid?"},
-            {"Book Club", "Next book: 1984"},
-            {"Fitness Group", "Morning workout at 6 AM"}
-        };
-        
-        for (size_t i = 0; i < mockChats.size(); ++i)
-        {
-            ChatInfo chat;
-            chat.chatId = static_cast<int64_t>(i + 1);
-            chat.title = mockChats[i].first;
-            chat.lastMessage = mockChats[i].second;
-            chat.lastMessageTime = (i < 3) ? "12:0" + std::to_string(i) : "Yesterday";
-            chat.unreadCount = (i % 3 == 0) ? (i + 1) : 0;
-            chat.isPinned = (i < 2);
-            chat.isOnline = (i % 2 == 0);
-            
-            // Generate avatar text (first letters)
-            std::string avatarText;
-            std::istringstream iss(chat.title);
-            std::string word;
-            while (iss >> word && avatarText.length() < 2)
-            {
-                if (!word.empty())
-                    avatarText += word[0];
-            }
-            chat.avatarText = avatarText;
-            
-            // Generate random-ish color based on name
-            float hue = (float)(std::hash<std::string>{}(chat.title) % 360) / 360.0f;
-            float r = std::abs(std::sin(hue * 2.0f * 3.14159f));
-            float g = std::abs(std::sin((hue + 0.33f) * 2.0f * 3.14159f));
-            float b = std::abs(std::sin((hue + 0.67f) * 2.0f * 3.14159f));
-            chat.avatarColor = ImVec4(r * 0.7f + 0.3f, g * 0.7f + 0.3f, b * 0.7f + 0.3f, 1.0f);
-            
-            mChats.push_back(chat);
-        }
-    }
-
     ////////////////////////////////////////////////////////
     ///               ChatWindow
     ////////////////////////////////////////////////////////
@@ -88,11 +28,14 @@ namespace tg
 
     void ChatWindow::Render()
     {
-        std::string windowTitle = mChatInfo.title + "###ChatWindow" + std::to_string(mChatInfo.chatId);
+        TG_PROFILE_FUNCTION()
+        FontLibrary::Get().RequestGlyphs(mChatInfo.title);
+        FrameString windowTitle(mChatInfo.title.size() + 40);
+        windowTitle.Append(mChatInfo.title).AppendFormat("###ChatWindow{}", mChatInfo.chatId);
         
         ImGui::SetNextWindowSize(ImVec2(400, 500), ImGuiCond_FirstUseEver);
         
-        if (!ImGui::Begin(windowTitle.c_str(), &mIsOpen))
+        if (!ImGui::Begin(windowTitle.CStr(), &mIsOpen))
         {
             ImGui::End();
             return;
@@ -164,6 +107,7 @@ namespace tg
             if (strlen(mInputBuffer.data()) > 0)
             {
                 // Add new message
+                TG_MEMORY_TAG(Messages)
                 Message newMsg;
                 newMsg.sender = "Me";
                 newMsg.text = mInputBuffer.data();
@@ -184,6 +128,7 @@ namespace tg
         {
             if (strlen(mInputBuffer.data()) > 0)
             {
+                TG_MEMORY_TAG(Messages)
                 Message newMsg;
                 newMsg.sender = "Me";
                 newMsg.text = mInputBuffer.data();
@@ -201,6 +146,7 @@ namespace tg
 
     void ChatWindow::LoadMockMessages()
     {
+        TG_MEMORY_TAG(Messages)
         mMessages = {
             {"Me", "Hi there!", "10:30", true},
             {mChatInfo.title, "Hello! How are you?", "10:31", false},
@@ -213,6 +159,7 @@ namespace tg
 
     void ChatWindow::DrawMessage(const Message& msg)
     {
+        FontLibrary::Get().RequestGlyphs(msg.text);
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(8, 4));
         
         float maxWidth = ImGui::GetContentRegionAvail().x * 0.75f;
@@ -220,8 +167,7 @@ namespace tg
         if (msg.isOutgoing)
         {
             // Right-aligned for outgoing messages
-            float textWidth = ImGui::CalcTextSize(msg.text.c_str()).x + 16;
-            float actualWidth = std::min(textWidth, maxWidth);
+            float actualWidth = MeasureMessageWidth(msg, maxWidth);
             ImGui::SetCursorPosX(ImGui::GetContentRegionAvail().x - actualWidth);
             
             ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.3f, 0.5f, 0.3f, 0.3f));
@@ -231,7 +177,9 @@ namespace tg
             ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.2f, 0.2f, 0.2f, 0.3f));
         }
         
-        ImGui::BeginChild(("##msg" + std::to_string((intptr_t)&msg)).c_str(), 
+        FixedString<32> childId;
+        childId.AppendFormat("##msg{}", reinterpret_cast<intptr_t>(&msg));
+        ImGui::BeginChild(childId.CStr(), 
                          ImVec2(maxWidth, 0), false, 
                          ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_AlwaysAutoResize);
         
@@ -257,22 +205,45 @@ namespace tg
     ///               TGManager
     ////////////////////////////////////////////////////////
 
-    TGPanel::TGPanel()
-    : Panel("Telegram", "📱")
+    TGPanel::TGPanel(const std::string& name)
+    : Panel(name, "📱")
     {
+        mFlags = mFlags | PanelFlags::Retained;
+        mAccounts.SetResidency(AccountResidencyConfig::FromCommandLine(), GetName());
     }
 
     TGPanel::~TGPanel()
     {
     }
 
+    void TGPanel::OnUpdate(TimeStep ts)
+    {
+        // Accounts nobody has looked at for a while give their chat tables back
+        mAccounts.OffloadIdle(mSelectedAccount);
+    }
+
     void TGPanel::OnRender()
+    {
+        TG_PROFILE_FUNCTION()
+        // Main panel content
+        if (mAccounts.Empty())
+        {
+            RenderEmptyState();
+        }
+        else
+        {
+            RenderAccountSection();
+        }
+    }
+
+    void TGPanel::OnRenderOverlays()
     {
         for (auto it = mChatWindows.begin(); it != mChatWindows.end();)
         {
             if (!(*it)->IsOpen())
             {
                 it = mChatWindows.erase(it);
+                RequestSave();
             }
             else
             {
@@ -281,16 +252,6 @@ namespace tg
             }
         }
         
-        // Main panel content
-        if (mAccounts.empty())
-        {
-            RenderEmptyState();
-        }
-        else
-        {
-            RenderAccountSection();
-        }
-        
         // Render popup if needed
         RenderAddAccountPopup();
     }
@@ -304,7 +265,8 @@ namespace tg
     void TGPanel::OnDetach()
     {
         mChatWindows.clear();
-        mAccounts.clear();
+        mAccounts.Clear();
+        mSelectedAccount = {};
         TG(LayerLog, Info, "TelegramPanel detached");
     }
 
@@ -313,40 +275,99 @@ namespace tg
         TG(LayerLog, Info, "TelegramPanel gained focus");
     }
 
-    void TGPanel::AddAccount(const std::string& phoneNumber)
+    void TGPanel::OnSaveState(BinaryWriter& writer) const
+    {
+        // The selection is saved as a position in the account order, as it always was.
+        writer.Write(static_cast<uint32_t>(mAccounts.Size()));
+        for (const AccountId id : mAccounts.GetOrder())
+        {
+            const TelegramAccount* account = mAccounts.Get(id);
+            writer.WriteString(account->GetPhoneNumber());
+            writer.WriteString(account->GetDisplayName());
+        }
+        const size_t selected = mAccounts.GetOrderIndex(mSelectedAccount);
+        writer.Write(selected < mAccounts.Size() ? static_cast<int32_t>(selected) : int32_t{-1});
+        writer.WriteString(mSearchBuffer);
+
+        writer.Write(static_cast<uint32_t>(mChatWindows.size()));
+        for (const auto& window : mChatWindows)
+        {
+            writer.WriteString(window->GetAccountPhone());
+            writer.Write(window->GetChatId());
+        }
+    }
+
+    void TGPanel::OnHibernate()
     {
-        for (const auto& account : mAccounts)
+        // Swap with empties so the capacity goes too
+        std::vector<std::unique_ptr<ChatWindow>>().swap(mChatWindows);
+        mAccounts.Clear();
+        mSelectedAccount = {};
+    }
+
+    void TGPanel::OnRestore(BinaryReader& reader)
+    {
+        const uint32_t accountCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < accountCount && reader.IsValid(); ++i)
         {
-            if (account->GetPhoneNumber() == phoneNumber)
+            auto account = std::make_unique<TelegramAccount>(reader.ReadString());
+            account->SetDisplayName(reader.ReadString());
+            mAccounts.Add(std::move(account));
+        }
+        const int32_t selected = std::min(reader.Read<int32_t>(), static_cast<int32_t>(mAccounts.Size()) - 1);
+        mSelectedAccount = selected >= 0 ? mAccounts.GetOrder()[static_cast<size_t>(selected)] : AccountId{};
+
+        const std::string search = reader.ReadString();
+        std::snprintf(mSearchBuffer, sizeof(mSearchBuffer), "%s", search.c_str());
+
+        const uint32_t windowCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < windowCount && reader.IsValid(); ++i)
+        {
+            const std::string accountPhone = reader.ReadString();
+            const int64_t chatId = reader.Read<int64_t>();
+            const TelegramAccount* account = mAccounts.Get(mAccounts.Find(accountPhone));
+            if (!account) continue;
+            for (const ChatInfo& chat : account->GetChats())
             {
-                TG(LayerLog, Warn, "Account already exists: {}", phoneNumber);
-                return;
+                if (chat.chatId == chatId)
+                {
+                    OpenChatWindow(accountPhone, chat);
+                }
             }
         }
+    }
+
+    TelegramAccount* TGPanel::AddAccount(const std::string& phoneNumber)
+    {
+        if (const AccountId existing = mAccounts.Find(phoneNumber); existing.IsValid())
+        {
+            TG(LayerLog, Warn, "Account already exists: {}", phoneNumber);
+            return mAccounts.Use(existing);
+        }
         
-        mAccounts.push_back(std::make_unique<TelegramAccount>(phoneNumber));
-        mSelectedAccountIndex = static_cast<int>(mAccounts.size()) - 1;
+        mSelectedAccount = mAccounts.Add(std::make_unique<TelegramAccount>(phoneNumber));
+        Invalidate();
+        RequestSave();
         
         TG(LayerLog, Info, "Added Telegram account: {}", phoneNumber);
+        return mAccounts.Get(mSelectedAccount);
     }
 
     void TGPanel::RemoveAccount(const std::string& phoneNumber)
     {
-        auto it = std::remove_if(mAccounts.begin(), mAccounts.end(),
-            [&phoneNumber](const std::unique_ptr<TelegramAccount>& account) {
-                return account->GetPhoneNumber() == phoneNumber;
-            });
-        
-        if (it != mAccounts.end())
+        const AccountId id = mAccounts.Find(phoneNumber);
+        const size_t orderIndex = mAccounts.GetOrderIndex(id);
+        if (mAccounts.Remove(id))
         {
-            mAccounts.erase(it, mAccounts.end());
-            
-            // Adjust selected index
-            if (mSelectedAccountIndex >= static_cast<int>(mAccounts.size()))
+            // The next account moves into the removed one's place in the selector.
+            if (id == mSelectedAccount)
             {
-                mSelectedAccountIndex = static_cast<int>(mAccounts.size()) - 1;
+                const std::vector<AccountId>& order = mAccounts.GetOrder();
+                mSelectedAccount = order.empty() ? AccountId{} : order[std::min(orderIndex, order.size() - 1)];
             }
             
+            Invalidate();
+            RequestSave();
             TG(LayerLog, Info, "Removed Telegram account: {}", phoneNumber);
         }
     }
@@ -363,10 +384,18 @@ namespace tg
         }
         
         mChatWindows.push_back(std::make_unique<ChatWindow>(chat, accountPhone));
+        RequestSave();
         TG(LayerLog, Info, "Opened chat window for: {}", chat.title);
     
     }
 
+    void TGPanel::SetSearchText(std::string_view text)
+    {
+        std::snprintf(mSearchBuffer, sizeof(mSearchBuffer), "%.*s", static_cast<int>(text.size()), text.data());
+        Invalidate();
+        RequestSave();
+    }
+
     void TGPanel::RenderAccountSection()
     {
         RenderAccountSelector();
@@ -376,49 +405,142 @@ namespace tg
 
     void TGPanel::RenderAccountSelector()
     {
+        const TelegramAccount* selected = mAccounts.Get(mSelectedAccount);
+        if (!selected)
+            return;
+        
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 8));
         
-        if (mSelectedAccountIndex >= 0 && mSelectedAccountIndex < static_cast<int>(mAccounts.size()))
+        ImGui::Text("Account: %s", selected->GetDisplayName().c_str());
+        
+        // Unread messages in the other accounts, so they are not forgotten behind the selector
+        FixedString<128> preview;
+        preview.Append(selected->GetPhoneNumber());
+        const int otherUnread = mAccounts.GetTotalUnread() - selected->GetUnreadCount();
+        if (otherUnread > 0)
         {
-            const auto& account = mAccounts[mSelectedAccountIndex];
-            
-            ImGui::Text("Account: %s", account->GetDisplayName().c_str());
-            
-            // Account dropdown
-            if (ImGui::BeginCombo("##accountSelector", account->GetPhoneNumber().c_str()))
+            preview.AppendFormat("  ({} unread in other accounts)", otherUnread);
+        }
+        
+        if (ImGui::BeginCombo("##accountSelector", preview.CStr(), ImGuiComboFlags_HeightLargest))
+        {
+            RenderAccountPicker();
+            ImGui::EndCombo();
+        }
+        else
+        {
+            // Every opening starts with an empty search
+            mAccountSearchBuffer[0] = '\0';
+        }
+        
+        ImGui::SameLine();
+        RenderAddAccountButton();
+        
+        ImGui::PopStyleVar();
+    }
+
+    void TGPanel::RenderAccountPicker()
+    {
+        TG_PROFILE_FUNCTION()
+        constexpr size_t kVisibleRows = 12;
+        
+        if (ImGui::IsWindowAppearing())
+        {
+            ImGui::SetKeyboardFocusHere();
+        }
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        const bool submitted = ImGui::InputTextWithHint("##accountSearch", "Search accounts...", mAccountSearchBuffer,
+                                                        sizeof(mAccountSearchBuffer), ImGuiInputTextFlags_EnterReturnsTrue);
+        
+        FixedString<sizeof(mAccountSearchBuffer)> query;
+        FoldSearchQuery(mAccountSearchBuffer, query);
+        const std::span<AccountId> matches(FrameArena::Get().AllocateArray<AccountId>(mAccounts.Size()), mAccounts.Size());
+        const size_t shown = mAccounts.Filter(query, matches);
+        
+        // Enter picks the first match
+        if (submitted && shown > 0)
+        {
+            SelectAccount(matches[0]);
+            ImGui::CloseCurrentPopup();
+            return;
+        }
+        if (shown == 0)
+        {
+            ImGui::TextDisabled("No matching accounts");
+            return;
+        }
+        
+        // Only the rows in view are submitted, however many accounts there are
+        const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        ImGui::BeginChild("##accountList", ImVec2(0, rowHeight * static_cast<float>(std::min(shown, kVisibleRows))));
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(shown), rowHeight);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
             {
-                for (size_t i = 0; i < mAccounts.size(); ++i)
+                const AccountId id = matches[static_cast<size_t>(row)];
+                const TelegramAccount& account = *mAccounts.Get(id);
+                
+                ImGui::PushID(static_cast<int>(id.index));
+                if (ImGui::Selectable(account.GetPhoneNumber().c_str(), id == mSelectedAccount))
                 {
-                    bool isSelected = (mSelectedAccountIndex == static_cast<int>(i));
-                    if (ImGui::Selectable(mAccounts[i]->GetPhoneNumber().c_str(), isSelected))
-                    {
-                        mSelectedAccountIndex = static_cast<int>(i);
-                    }
-                    if (isSelected)
+                    SelectAccount(id);
+                    ImGui::CloseCurrentPopup();
+                }
+                if (!account.IsResident() && ImGui::IsItemHovered())
+                {
+                    // Offloaded: only the summary is in memory
+                    ImGui::BeginTooltip();
+                    ImGui::TextDisabled("%zu chats, on disk", account.GetChatCount());
+                    for (const ChatInfo& chat : account.GetTopChats())
                     {
-                        ImGui::SetItemDefaultFocus();
+                        ImGui::Text("%s", chat.title.c_str());
                     }
+                    ImGui::EndTooltip();
                 }
-                ImGui::EndCombo();
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", account.GetDisplayName().c_str());
+                
+                if (account.GetUnreadCount() > 0)
+                {
+                    FixedString<16> badge;
+                    badge.AppendFormat("{}", account.GetUnreadCount());
+                    ImGui::SameLine(ImGui::GetContentRegionMax().x - ImGui::CalcTextSize(badge.CStr()).x);
+                    ImGui::TextColored(ImVec4(0.26f, 0.59f, 0.98f, 1.0f), "%s", badge.CStr());
+                }
+                ImGui::PopID();
             }
-            
-            ImGui::SameLine();
-            RenderAddAccountButton();
         }
+        clipper.End();
+        ImGui::EndChild();
+    }
+
+    void TGPanel::SelectAccount(AccountId id)
+    {
+        if (id == mSelectedAccount)
+            return;
         
-        ImGui::PopStyleVar();
+        mSelectedAccount = id;
+        mAccounts.Use(id);
+        Invalidate();
+        RequestSave();
     }
 
     void TGPanel::RenderChatList()
     {
-        if (mSelectedAccountIndex < 0 || mSelectedAccountIndex >= static_cast<int>(mAccounts.size()))
+        TG_PROFILE_FUNCTION()
+        const TelegramAccount* account = mAccounts.Use(mSelectedAccount);
+        if (!account)
             return;
         
-        const auto& account = mAccounts[mSelectedAccountIndex];
-        
         // Search bar
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 6));
-        ImGui::InputText("##search", mSearchBuffer, sizeof(mSearchBuffer));
+        if (ImGui::InputText("##search", mSearchBuffer, sizeof(mSearchBuffer)))
+        {
+            // The search text is part of the saved panel state
+            RequestSave();
+        }
         ImGui::PopStyleVar();
         
         if (ImGui::IsItemHovered() && strlen(mSearchBuffer) == 0)
@@ -433,30 +555,22 @@ namespace tg
         
         const auto& chats = account->GetChats();
         
-        // Sort chats: pinned first, then by time
-        std::vector<ChatInfo> sortedChats = chats;
-        std::sort(sortedChats.begin(), sortedChats.end(),
-            [](const ChatInfo& a, const ChatInfo& b) {
-                if (a.isPinned != b.isPinned) return a.isPinned > b.isPinned;
-                return a.chatId < b.chatId;
-            });
+        // Sort chats: pinned first, then by time. Only pointers are sorted, in frame memory.
+        const ChatInfo** sortedChats = FrameArena::Get().AllocateArray<const ChatInfo*>(chats.size());
+        for (size_t i = 0; i < chats.size(); ++i)
+        {
+            sortedChats[i] = &chats[i];
+        }
+        const std::span<const ChatInfo*> list(sortedChats, chats.size());
+        SortChatList(list);
         
-        for (const auto& chat : sortedChats)
+        FixedString<sizeof(mSearchBuffer)> searchLower;
+        FoldSearchQuery(mSearchBuffer, searchLower);
+        const size_t shown = FilterChatList(list, searchLower);
+        
+        for (size_t i = 0; i < shown; ++i)
         {
-            // Filter by search
-            if (strlen(mSearchBuffer) > 0)
-            {
-                std::string searchLower = mSearchBuffer;
-                std::transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::tolower);
-                
-                std::string titleLower = chat.title;
-                std::transform(titleLower.begin(), titleLower.end(), titleLower.begin(), ::tolower);
-                
-                if (titleLower.find(searchLower) == std::string::npos)
-                    continue;
-            }
-            
-            DrawChatItem(chat, false);
+            DrawChatItem(*list[i], false);
         }
         
         ImGui::EndChild();
@@ -562,6 +676,14 @@ namespace tg
     {
         ImGui::PushID(static_cast<int>(chat.chatId));
         
+        FontLibrary& fonts = FontLibrary::Get();
+        fonts.RequestGlyphs(chat.title);
+        fonts.RequestGlyphs(chat.lastMessage);
+        if (chat.isPinned)
+        {
+            fonts.RequestGlyphs("📌");
+        }
+        
         ImVec2 cursorPos = ImGui::GetCursorPos();
         bool clicked = ImGui::Selectable("##chat", isSelected, 
                                         ImGuiSelectableFlags_AllowDoubleClick, 
@@ -570,9 +692,9 @@ namespace tg
         // Open chat window on double-click
         if (clicked && ImGui::IsMouseDoubleClicked(0))
         {
-            if (mSelectedAccountIndex >= 0 && mSelectedAccountIndex < static_cast<int>(mAccounts.size()))
+            if (const TelegramAccount* account = mAccounts.Get(mSelectedAccount))
             {
-                OpenChatWindow(mAccounts[mSelectedAccountIndex]->GetPhoneNumber(), chat);
+                OpenChatWindow(account->GetPhoneNumber(), chat);
             }
         }
         
@@ -621,12 +743,13 @@ namespace tg
                 radius,
                 ImColor(0.26f, 0.59f, 0.98f));
             
-            std::string countStr = std::to_string(chat.unreadCount);
-            ImVec2 textSize = ImGui::CalcTextSize(countStr.c_str());
+            FixedString<16> countStr;
+            countStr.AppendFormat("{}", chat.unreadCount);
+            ImVec2 textSize = ImGui::CalcTextSize(countStr.CStr());
             drawList->AddText(
                 ImVec2(pos.x + radius - textSize.x/2, pos.y + radius - textSize.y/2),
                 ImColor(1.0f, 1.0f, 1.0f),
-                countStr.c_str());
+                countStr.CStr());
         }
         
         ImGui::Columns(1);
@@ -3,9 +3,12 @@
 #include <glfw/glfw3.h>
 
 #include "Base/Window.h"
+#include "Memory/FixedString.h"
 #include "TG/TGManager.h"
+#include "Panels/TGPanel.h"
+#include "UI/LogPanel.h"
+#include "UI/PanelFactory.h"
 #include "UI/TabManager.h"
-#include "UI/Panels/TGPanel.h"
 
 RuntimeLayer::RuntimeLayer()
 : tg::Layer("RuntimeLayer")
@@ -22,11 +25,14 @@ void RuntimeLayer::OnAttach()
     Layer::OnAttach();
     tg::TabManager::Get().Init();
 
-    auto telegramPanel = std::make_shared<tg::TGPanel>();
-    tg::TabManager::Get().AddPanel(telegramPanel);
+    tg::PanelFactory::Get().Register<tg::TGPanel>("telegram", "Telegram", "📱");
+    tg::PanelFactory::Get().Register<tg::LogPanel>("log", "Log", "📜");
 
-    tg::TabManager::Get().SetActivePanel("Telegram");
-    
+    // Only the active tab is constructed at startup; the others wait until first shown
+    if (!tg::TabManager::Get().LoadSession())
+    {
+        tg::TabManager::Get().OpenPanel("telegram");
+    }
 
 }
 
@@ -39,6 +45,7 @@ void RuntimeLayer::OnDetach()
 void RuntimeLayer::OnUpdate(tg::TimeStep ts)
 {
     Layer::OnUpdate(ts);
+    tg::TabManager::Get().Update(ts);
 }
 
 void RuntimeLayer::OnImGuiRender()
@@ -93,10 +100,14 @@ void RuntimeLayer::OnImGuiRender()
             if (ImGui::BeginMenu("Panels"))
             {
                 // Add new Telegram panel instance
-                if (ImGui::MenuItem("New Telegram Panel"))
+                for (const tg::PanelType& type : tg::PanelFactory::Get().GetTypes())
                 {
-                    auto newPanel = std::make_shared<tg::TGPanel>();
-                    tg::TabManager::Get().AddPanel(newPanel);
+                    tg::FixedString<128> label;
+                    label.AppendFormat("New {} Panel", type.displayName);
+                    if (ImGui::MenuItem(label.CStr()))
+                    {
+                        tg::TabManager::Get().OpenPanel(type.typeId);
+                    }
                 }
                 
                 ImGui::Separator();
@@ -105,8 +116,15 @@ void RuntimeLayer::OnImGuiRender()
                 ImGui::Text("Active Panels:");
                 ImGui::Separator();
                 
-                // You could iterate through panels here if TabManager exposed a method
-                ImGui::Text("• Telegram");
+                const tg::PanelRegistry& registry = tg::TabManager::Get().GetRegistry();
+                for (tg::PanelHandle handle : registry.GetOrder())
+                {
+                    tg::Panel* panel = registry.Get(handle);
+                    if (ImGui::MenuItem(panel->GetName().c_str()))
+                    {
+                        tg::TabManager::Get().SetActivePanel(panel);
+                    }
+                }
                 
                 ImGui::EndMenu();
             }
@@ -115,7 +133,36 @@ void RuntimeLayer::OnImGuiRender()
             ImGui::MenuItem("Demo Window", nullptr, &mShowDemoWindow);
             ImGui::EndMenu();
         }
-        
+
+        if (ImGui::BeginMenu("Debug"))
+        {
+            ImGui::MenuItem("Profiler Overlay", nullptr, &mShowProfilerOverlay);
+            ImGui::MenuItem("Memory Overlay", nullptr, &mShowMemoryOverlay);
+            ImGui::Separator();
+
+            const bool capturing = tg::Profiler::IsCapturing();
+            if (ImGui::MenuItem("Capture Trace (10s, Chrome JSON)", nullptr, false, !capturing))
+            {
+                tg::Profiler::BeginCapture({ .durationSeconds = 10.0f, .format = tg::TraceFormat::ChromeJson });
+            }
+            if (ImGui::MenuItem("Capture Trace (10s, Perfetto)", nullptr, false, !capturing))
+            {
+                tg::Profiler::BeginCapture({ .durationSeconds = 10.0f, .format = tg::TraceFormat::Perfetto });
+            }
+            if (ImGui::MenuItem("Stop Capture", nullptr, false, capturing))
+            {
+                tg::Profiler::EndCapture();
+            }
+
+            if (!tg::Profiler::GetLastCapturePath().empty())
+            {
+                ImGui::Separator();
+                ImGui::TextDisabled("%s: %s", capturing ? "Recording" : "Last trace",
+                    tg::Profiler::GetLastCapturePath().c_str());
+            }
+            ImGui::EndMenu();
+        }
+
         if (ImGui::BeginMenu("Help"))
         {
             if (ImGui::MenuItem("About"))
@@ -147,6 +194,9 @@ void RuntimeLayer::OnImGuiRender()
     // Render the TabManager (this renders all panels and tabs)
     tg::TabManager::Get().Render();
     
+    tg::ProfilerOverlay::Render(&mShowProfilerOverlay);
+    tg::MemoryOverlay::Render(&mShowMemoryOverlay);
+
     // Optional: Show ImGui demo window
     if (mShowDemoWindow)
     {
@@ -1,11 +1,17 @@
 ﻿#include <Base/Entry.h>
 
 #include "RuntimeLayer.h"
+#include "UI/TabManager.h"
 
 class Runtime : public tg::App
 {
 public:
-    Runtime() : App() {}
+    Runtime() : App()
+    {
+        // The saved tab layout is read while the window comes up.
+        GetStartup().Add("Session", tg::StartupThread::Worker, [] { tg::TabManager::Get().PrefetchSession(); });
+        GetStartup().AddDependency("Layers", "Session");
+    }
 
     void OnInit() override
     {
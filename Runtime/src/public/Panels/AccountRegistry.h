@@ -0,0 +1,111 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tg
+{
+    class TelegramAccount;
+
+    // Slot index plus the slot's generation when the account was added, like PanelHandle:
+    // an ID kept across a removal never resolves to the account that reuses the slot.
+    struct AccountId
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        [[nodiscard]] bool IsValid() const { return index != UINT32_MAX; }
+        bool operator==(const AccountId&) const = default;
+    };
+
+    // When an account's chat table may leave memory. The store only holds the tables of
+    // accounts that are offloaded right now; it is not a cache across runs. Each running
+    // instance writes to its own run-<pid> subdirectory and only ever clears that one.
+    struct AccountResidencyConfig
+    {
+        // Time since an account was last used; <= 0 keeps every account resident.
+        float offloadAfterSeconds = 600.0f;
+        std::string storeDir = "cache/accounts";
+        // Chats kept in memory per offloaded account, for the picker.
+        size_t summaryChats = 3;
+
+        // Overridable with --offload-accounts-after <seconds> and --account-store <dir>.
+        static AccountResidencyConfig FromCommandLine();
+    };
+
+    // Owns TGPanel's accounts. Lookup by ID is an array access and by phone number one hash
+    // probe, so selecting, deduplicating and restoring stay flat with hundreds of accounts.
+    class AccountRegistry
+    {
+    public:
+        // Invalid ID if the phone number is already registered.
+        AccountId Add(std::unique_ptr<TelegramAccount> account);
+        bool Remove(AccountId id);
+        // Frees the slot storage as well.
+        void Clear();
+
+        [[nodiscard]] TelegramAccount* Get(AccountId id) const;
+        // Get() for an account about to be shown: marks it used and brings its chats back
+        // if they were offloaded.
+        TelegramAccount* Use(AccountId id);
+        [[nodiscard]] AccountId Find(std::string_view phoneNumber) const;
+
+        // Display order: the order accounts were added in.
+        [[nodiscard]] const std::vector<AccountId>& GetOrder() const { return mOrder; }
+        // Size() for an invalid ID.
+        [[nodiscard]] size_t GetOrderIndex(AccountId id) const;
+
+        [[nodiscard]] size_t Size() const { return mOrder.size(); }
+        [[nodiscard]] bool Empty() const { return mOrder.empty(); }
+
+        // Unread messages over every account.
+        [[nodiscard]] int GetTotalUnread() const;
+        // Writes the IDs of the accounts whose phone number or display name contains the
+        // folded query (see FoldSearchQuery) into out, in display order, and returns how
+        // many. out must hold Size() IDs.
+        size_t Filter(std::string_view lowerQuery, std::span<AccountId> out) const;
+
+        // ownerName (the panel's) keeps the store files of registries holding the same
+        // account apart.
+        void SetResidency(const AccountResidencyConfig& config, std::string_view ownerName);
+        const AccountResidencyConfig& GetResidency() const { return mResidency; }
+        // Offloads the account unused for longest if it is past the limit, one per call so
+        // the writes spread over frames. keep (the one on screen) is never offloaded.
+        bool OffloadIdle(AccountId keep = {});
+        [[nodiscard]] size_t GetResidentCount() const;
+
+    private:
+        struct Slot
+        {
+            std::unique_ptr<TelegramAccount> account;
+            uint32_t generation = 1;
+            uint32_t orderIndex = 0;
+            uint64_t lastUsedNs = 0;
+        };
+
+        struct PhoneHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view phone) const { return std::hash<std::string_view>{}(phone); }
+        };
+
+        [[nodiscard]] const Slot* Resolve(AccountId id) const;
+        [[nodiscard]] std::string GetStorePath(const TelegramAccount& account) const;
+        void PublishResidentCount() const;
+
+    private:
+        std::vector<Slot> mSlots;
+        std::vector<uint32_t> mFreeSlots;
+        std::vector<AccountId> mOrder;
+        std::unordered_map<std::string, uint32_t, PhoneHash, std::equal_to<>> mByPhone;
+        AccountResidencyConfig mResidency;
+        std::string mOwnerName;
+        // This process's subdirectory of mResidency.storeDir.
+        std::string mStoreDir;
+        bool mStoreCreated = false;
+    };
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <imgui.h>
+
+namespace tg
+{
+    class StringBuilder;
+
+    // Account and chat data behind TGPanel, and the list work it does every frame. Kept out
+    // of the panel so Bench can build it without any UI.
+    struct ChatInfo
+    {
+        int64_t chatId;
+        std::string title;
+        std::string lastMessage;
+        std::string lastMessageTime;
+        int unreadCount = 0;
+        bool isPinned = false;
+        bool isOnline = false;
+        
+        ImVec4 avatarColor = ImVec4(0.5f, 0.5f, 0.8f, 1.0f);
+        std::string avatarText;
+    };
+
+    struct Message
+    {
+        std::string sender;
+        std::string text;
+        std::string time;
+        bool isOutgoing;
+    };
+
+    class TelegramAccount
+    {
+    public:
+        TelegramAccount(const std::string& phoneNumber);
+        ~TelegramAccount();
+
+        const std::string& GetPhoneNumber() const { return mPhoneNumber; }
+        const std::string& GetDisplayName() const { return mDisplayName; }
+        // Empty while the account is offloaded.
+        const std::vector<ChatInfo>& GetChats() const { return mChats; }
+        size_t GetChatCount() const { return IsResident() ? mChats.size() : mOffloadedChatCount; }
+        // Sum over the chats, kept up to date as they are added.
+        int GetUnreadCount() const { return mUnreadCount; }
+        bool IsAuthorized() const { return mIsAuthorized; }
+        
+        void SetDisplayName(const std::string& name) { mDisplayName = name; }
+        void AddMockChats();
+        // Generated chats for benchmarks and the harness; the same for the same phone number.
+        void AddSyntheticChats(size_t count);
+
+        // Residency (see AccountResidencyConfig). Offload writes the chat table to path and
+        // frees it, keeping the unread total and the first chats in display order as a
+        // summary; Rehydrate reads it back and deletes the file. Adding chats rehydrates.
+        bool IsResident() const { return mOffloadPath.empty(); }
+        // The summary; empty while resident.
+        const std::vector<ChatInfo>& GetTopChats() const { return mTopChats; }
+        bool Offload(const std::string& path, size_t summaryChats);
+        // On a damaged file the summary chats become the chat table, and false is returned.
+        bool Rehydrate();
+        
+    private:
+        std::string mPhoneNumber;
+        std::string mDisplayName;
+        std::vector<ChatInfo> mChats;
+        std::vector<ChatInfo> mTopChats;
+        std::string mOffloadPath;
+        size_t mOffloadedChatCount = 0;
+        int mUnreadCount = 0;
+        bool mIsAuthorized = false;
+        void* mTdlibClient = nullptr;
+    };
+
+    // ASCII letters only; other bytes, UTF-8 sequences included, pass through.
+    char ToLowerAscii(char c);
+    // Search folding: turns what the user typed into the needle ContainsIgnoreCase expects.
+    void FoldSearchQuery(std::string_view query, StringBuilder& out);
+    // lowerNeedle must already be folded.
+    bool ContainsIgnoreCase(std::string_view text, std::string_view lowerNeedle);
+
+    // Display order: pinned chats first, then by ID.
+    void SortChatList(std::span<const ChatInfo*> chats);
+    // Moves the chats whose title contains the folded query to the front, keeping their
+    // order, and returns how many there are. An empty query keeps everything.
+    size_t FilterChatList(std::span<const ChatInfo*> chats, std::string_view lowerQuery);
+
+    // Width of a message bubble with the current ImGui font: the unwrapped text plus
+    // padding, capped at maxWidth.
+    float MeasureMessageWidth(const Message& message, float maxWidth);
+}
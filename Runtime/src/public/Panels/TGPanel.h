@@ -1,56 +1,15 @@
 ﻿#pragma once
 #include "UI/Panel.h"
+#include "Panels/AccountRegistry.h"
+#include "Panels/TGModel.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <imgui.h>
 
 namespace tg
 {
-    struct ChatInfo
-    {
-        int64_t chatId;
-        std::string title;
-        std::string lastMessage;
-        std::string lastMessageTime;
-        int unreadCount = 0;
-        bool isPinned = false;
-        bool isOnline = false;
-        
-        ImVec4 avatarColor = ImVec4(0.5f, 0.5f, 0.8f, 1.0f);
-        std::string avatarText;
-    };
-
-    struct Message
-    {
-        std::string sender;
-        std::string text;
-        std::string time;
-        bool isOutgoing;
-    };
-
-    class TelegramAccount
-    {
-    public:
-        TelegramAccount(const std::string& phoneNumber);
-        ~TelegramAccount();
-
-        const std::string& GetPhoneNumber() const { return mPhoneNumber; }
-        const std::string& GetDisplayName() const { return mDisplayName; }
-        const std::vector<ChatInfo>& GetChats() const { return mChats; }
-        bool IsAuthorized() const { return mIsAuthorized; }
-        
-        void SetDisplayName(const std::string& name) { mDisplayName = name; }
-        void AddMockChats();
-        
-    private:
-        std::string mPhoneNumber;
-        std::string mDisplayName;
-        std::vector<ChatInfo> mChats;
-        bool mIsAuthorized = false;
-        void* mTdlibClient = nullptr;
-    };
-
     class ChatWindow
     {
     public:
@@ -60,6 +19,7 @@ namespace tg
         void Render();
         bool IsOpen() const { return mIsOpen; }
         int64_t GetChatId() const { return mChatInfo.chatId; }
+        const std::string& GetAccountPhone() const { return mAccountPhone; }
 
     private:
         ChatInfo mChatInfo;
@@ -76,33 +36,46 @@ namespace tg
     class TGPanel : public Panel
     {
     public:
-        TGPanel();
+        explicit TGPanel(const std::string& name = "Telegram");
         ~TGPanel();
         
+        void OnUpdate(TimeStep ts) override;
         void OnRender() override;
+        void OnRenderOverlays() override;
         void OnAttach() override;
         void OnDetach() override;
         void OnFocus() override;
         
+        // Account phones, selection, search and open chats; accounts reload on restore.
+        void OnSaveState(BinaryWriter& writer) const override;
+        void OnRestore(BinaryReader& reader) override;
+        bool CanHibernate() const override { return true; }
+        void OnHibernate() override;
+        
         // Account management
-        void AddAccount(const std::string& phoneNumber);
+        // Returns the account, the existing one if the phone is already added.
+        TelegramAccount* AddAccount(const std::string& phoneNumber);
         void RemoveAccount(const std::string& phoneNumber);
+        void OpenChatWindow(const std::string& accountPhone, const ChatInfo& chat);
+        void SetSearchText(std::string_view text);
         
     private:
         // UI State
         bool mShowAddAccountPopup = false;
         char mPhoneNumberBuffer[64] = {};
         char mSearchBuffer[256] = {};
-        int mSelectedAccountIndex = -1;
+        char mAccountSearchBuffer[64] = {};
+        AccountId mSelectedAccount;
         
         // Data
-        std::vector<std::unique_ptr<TelegramAccount>> mAccounts;
+        AccountRegistry mAccounts;
         std::vector<std::unique_ptr<ChatWindow>> mChatWindows;
         
         // Internal methods
-        void OpenChatWindow(const std::string& accountPhone, const ChatInfo& chat);
         void RenderAccountSection();
         void RenderAccountSelector();
+        void RenderAccountPicker();
+        void SelectAccount(AccountId id);
         void RenderChatList();
         void RenderAddAccountButton();
         void RenderAddAccountPopup();
@@ -15,6 +15,8 @@ private:
     bool mShowDemoWindow = false;
     bool mShowAboutWindow = false;
     bool mShowUsageGuide = false;
+    bool mShowProfilerOverlay = false;
+    bool mShowMemoryOverlay = false;
 };
 
 
@@ -0,0 +1,38 @@
+project "LogDecoder"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    staticruntime "off"
+
+    targetdir ("%{wks.location}/build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir    ("%{wks.location}/build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+    files {
+        "src/private/**.cpp"
+    }
+
+    includedirs {
+        "src/private/",
+        "%{wks.location}/Core/src/public"
+    }
+
+    links { "Core" }
+    dependson { "Core" }
+
+    IncludeDependencies()
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "configurations:Debug"
+        defines { "_DEBUG" }
+        runtime "Debug"
+        symbols "On"
+        ProcessDependencies("Debug")
+
+    filter "configurations:Release"
+        defines { "_RELEASE" }
+        runtime "Release"
+        optimize "Full"
+        symbols "Off"
+        ProcessDependencies("Release")
@@ -0,0 +1,54 @@
+﻿#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Base/BinaryLogReader.h"
+
+// Renders a binary log (logs/Log.tgbl, written with --binary-log) as text.
+//   LogDecoder <file.tgbl> [output.txt]
+int main(int argc, char** argv)
+{
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0)
+    {
+        std::fprintf(stderr, "Usage: LogDecoder <file.tgbl> [output.txt]\n");
+        return 1;
+    }
+
+    tg::BinaryLogReader reader;
+    if (!reader.Open(argv[1]))
+    {
+        std::fprintf(stderr, "Could not read '%s' as a binary log\n", argv[1]);
+        return 1;
+    }
+
+    std::FILE* out = stdout;
+    if (argc > 2)
+    {
+        out = std::fopen(argv[2], "w");
+        if (!out)
+        {
+            std::fprintf(stderr, "Could not open '%s' for writing\n", argv[2]);
+            return 1;
+        }
+    }
+
+    uint64_t count = 0;
+    tg::BinaryLogEntry entry;
+    while (reader.Next(entry))
+    {
+        const std::string line = tg::BinaryLogReader::FormatLine(entry);
+        std::fwrite(line.data(), 1, line.size(), out);
+        std::fputc('\n', out);
+        ++count;
+    }
+
+    if (out != stdout) std::fclose(out);
+
+    std::fprintf(stderr, "%llu messages", static_cast<unsigned long long>(count));
+    if (reader.GetDroppedCount() > 0)
+        std::fprintf(stderr, ", %llu dropped on full rings", static_cast<unsigned long long>(reader.GetDroppedCount()));
+    if (reader.IsTruncated())
+        std::fprintf(stderr, ", file ends in a partial record");
+    std::fprintf(stderr, "\n");
+    return 0;
+}
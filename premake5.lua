@@ -18,6 +18,8 @@ workspace "WorkApp" do
     language "C++"
     cppdialect "C++23"
     flags {"MultiProcessorCompile"}
+    -- Full Unicode codepoints (emoji) for dynamically loaded glyphs; must match in every project
+    defines {"IMGUI_USE_WCHAR32"}
 
     filter "system:windows"
         systemversion "latest"
@@ -27,21 +29,31 @@ workspace "WorkApp" do
     filter "configurations:Debug"
         optimize "Off"
         symbols "On"
+        -- Counts operator new calls per frame (Memory/AllocationTracker, --strict-allocations)
+        defines {"TG_TRACK_ALLOCATIONS"}
         --/Zi or /Z7 for debug info
         --/RTC1 for runtime check (uninitialied vars  stack frame etc)
         --/analyze static analysis ?
+
+    filter {"system:windows", "configurations:Debug"}
         buildoptions {"/fp:precise"}
 
     filter "configurations:Release"
         optimize "On"
         symbols "Default"
+        -- Trace-level TG calls compile to nothing (Base/Log.h)
+        defines {"TG_LOG_MIN_LEVEL=TG_LOG_LEVEL_INFO"}
 
+    -- MSVC flags; other toolchains get theirs from optimize/symbols above
+    filter {"system:windows", "configurations:Release"}
         --GL - whole prog optimization (link time optimization )
         --/arch:AVX2 vector instructions if modern hardware will be used for game
         --/fp:fast  faster floating point math
         buildoptions {"/O2","/fp:fast", "/GL"} 
         linkoptions {"/LTCG"}
 
+    filter {}
+
     outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
     bindir = "%{wks.location}/build/bin/" .. outputdir
 end
@@ -54,3 +66,15 @@ group "Runtime" do
     include "Runtime"
 end
 
+group "Tools" do
+    include "Tools/LogDecoder"
+end
+
+group "Bench" do
+    include "Bench"
+end
+
+group "Harness" do
+    include "Harness"
+end
+